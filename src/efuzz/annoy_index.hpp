@@ -0,0 +1,114 @@
+#ifndef EFUZZ_ANNOY_INDEX_HPP
+#define EFUZZ_ANNOY_INDEX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include <annoylib.h>
+#include <kissrandom.h>
+
+#include <efuzz/vector_index.hpp>
+
+namespace efuzz {
+    struct AnnoyParameters {
+        int tree_count {32};
+        int search_k {-1}; // Nodes inspected per query, -1 lets Annoy use tree_count * count
+        std::uint32_t seed {42};
+    };
+
+    // Random projection forest from Annoy. Annoy cannot add items to a built forest, so every
+    // add rebuilds it; prefer add_batch.
+    class AnnoyVectorIndex : public VectorIndex {
+        public:
+
+        using AnnoyIndexT =
+            Annoy::AnnoyIndex<std::int32_t, float, Annoy::Euclidean, Annoy::Kiss32Random,
+                              Annoy::AnnoyIndexSingleThreadedBuildPolicy>;
+
+        explicit AnnoyVectorIndex(std::size_t dimension, AnnoyParameters parameters = {}) :
+            _dimension(dimension), _parameters(parameters),
+            _annoy_index(std::make_unique<AnnoyIndexT>(static_cast<int>(dimension))) {
+            _annoy_index->set_seed(_parameters.seed);
+        }
+
+        void add(const float* embedding) override {
+            add_batch(embedding, 1);
+        }
+
+        void add_batch(const float* embeddings, std::size_t count) override {
+            if (count == 0) {
+                return;
+            }
+
+            if (_size > 0) {
+                _annoy_index->unbuild();
+            }
+
+            for (std::size_t index {0}; index < count; ++index) {
+                if (!_annoy_index->add_item(static_cast<std::int32_t>(_size + index),
+                                            embeddings + (index * _dimension))) {
+                    throw std::runtime_error("Annoy rejected an item");
+                }
+            }
+
+            _size += count;
+            _annoy_index->build(_parameters.tree_count);
+        }
+
+        [[nodiscard]] std::vector<std::size_t> nearest(const float* query,
+                                                       std::size_t count) const override {
+            std::vector<std::int32_t> items;
+
+            if (_size == 0) {
+                return {};
+            }
+
+            _annoy_index->get_nns_by_vector(query, count, _parameters.search_k, &items, nullptr);
+
+            return {items.begin(), items.end()};
+        }
+
+        [[nodiscard]] std::size_t size() const noexcept override {
+            return _size;
+        }
+
+        [[nodiscard]] std::size_t get_dimension() const noexcept override {
+            return _dimension;
+        }
+
+        [[nodiscard]] VectorIndexType get_type() const noexcept override {
+            return VectorIndexType::annoy;
+        }
+
+        // Annoy indexes cannot be copied, so the copy is rebuilt from the stored items.
+        [[nodiscard]] std::unique_ptr<VectorIndex> clone() const override {
+            auto copy = std::make_unique<AnnoyVectorIndex>(_dimension, _parameters);
+            std::vector<float> embeddings(_size * _dimension);
+
+            for (std::size_t item {0}; item < _size; ++item) {
+                _annoy_index->get_item(static_cast<std::int32_t>(item),
+                                       embeddings.data() + (item * _dimension));
+            }
+
+            copy->add_batch(embeddings.data(), _size);
+
+            return copy;
+        }
+
+        [[nodiscard]] const AnnoyParameters& get_parameters() const noexcept {
+            return _parameters;
+        }
+
+        private:
+
+        std::size_t _dimension {};
+        AnnoyParameters _parameters;
+        std::size_t _size {};
+        std::unique_ptr<AnnoyIndexT> _annoy_index;
+    };
+} // namespace efuzz
+
+#endif // EFUZZ_ANNOY_INDEX_HPP
@@ -0,0 +1,413 @@
+#ifndef EFUZZ_BK_TREE_HPP
+#define EFUZZ_BK_TREE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <cereal/cereal.hpp>
+#include <cereal/types/vector.hpp>
+#include <rapidfuzz/distance/Indel.hpp>
+#include <rapidfuzz/distance/Levenshtein.hpp>
+#include <rapidfuzz/fuzz.hpp>
+
+#include <efuzz/efuzz.hpp>
+#include <efuzz/index_build.hpp>
+#include <efuzz/string_pool.hpp>
+
+namespace efuzz {
+    enum class BkTreeMetric : std::uint8_t {
+        levenshtein, // Insertions, deletions and substitutions
+        indel,       // Insertions and deletions only; what rapidfuzz::fuzz::ratio is based on
+    };
+
+    struct BkTreeMatch {
+        std::size_t id {};
+        std::size_t distance {};
+    };
+
+    struct BkTreeSearchStats {
+        std::size_t visited_count {}; // Entries whose distance to the query was computed
+    };
+
+    // Burkhard-Keller tree: every entry's children sit at distinct distances from it, so the
+    // triangle inequality limits a threshold search to the children within the threshold of the
+    // query's distance to their parent. Searches are exact. The nodes are laid out breadth first,
+    // with the children of a node contiguous and sorted by distance, so a node's children are a
+    // range found by binary search rather than a map to chase. The tree is built level by level
+    // with the distances of a level computed in parallel. Inserted entries wait in an overflow
+    // area, scanned by every search, until it holds more than 1/OVERFLOW_DIVISOR as many entries
+    // as the tree; the tree is then rebuilt with all of them.
+    template <StdString StringT_>
+    class BkTree {
+        public:
+
+        using StringT = StringT_;
+        using char_type = typename StringT::value_type;
+        using string_view_type = typename StringPool<StringT>::string_view_type;
+        using this_type = BkTree<StringT>;
+
+        BkTree() = default;
+        explicit BkTree(BkTreeMetric metric);
+
+        // The build options are not serialized.
+        template <typename Archive>
+        void serialize(Archive& archive) {
+            archive(_metric, _strings, _node_entries, _parent_distances, _first_children);
+        }
+
+        this_type& insert(const StringT& string);
+        this_type& insert(const std::vector<StringT>& strings);
+        this_type& insert_lines(std::basic_istream<char_type>& stream);
+        // Threads, chunk size and progress callback of the builds; progress is reported once per
+        // tree level.
+        this_type& set_index_build_options(IndexBuildOptions index_build_options);
+
+        // Every entry within max_distance of query, closest first, then by id.
+        [[nodiscard]] std::vector<BkTreeMatch>
+            find_within(const StringT& query, std::size_t max_distance,
+                        BkTreeSearchStats* stats = nullptr) const;
+        // The k best entries within max_distance, scored and ranked like SearchContainer's.
+        [[nodiscard]] std::vector<SearchResult> search(const StringT& query, std::size_t k,
+                                                       std::size_t max_distance) const;
+
+        [[nodiscard]] string_view_type get(std::size_t id) const;
+        [[nodiscard]] std::size_t size() const;
+        [[nodiscard]] BkTreeMetric get_metric() const;
+        // Edges on the longest path from the root.
+        [[nodiscard]] std::size_t get_depth() const;
+        // Entries inserted since the last rebuild, not in the tree yet.
+        [[nodiscard]] std::size_t get_overflow_size() const;
+
+        private:
+
+        constexpr static std::size_t OVERFLOW_DIVISOR {16};
+
+        [[nodiscard]] std::size_t distance(string_view_type lhs, string_view_type rhs) const;
+        void rebuild();
+
+        BkTreeMetric _metric {BkTreeMetric::levenshtein};
+        IndexBuildOptions _index_build_options;
+        // Ids are positions, as in SearchContainer; the ids from _node_entries.size() on are the
+        // overflow area
+        StringPool<StringT> _strings;
+        // Per node, breadth first: its entry, its distance to its parent (0 for the root) and
+        // the first of its children, which end where the next node's begin. _first_children has
+        // one more element than there are nodes.
+        std::vector<std::uint32_t> _node_entries;
+        std::vector<std::uint32_t> _parent_distances;
+        std::vector<std::uint32_t> _first_children;
+    };
+
+    template <StdString StringT_>
+    BkTree<StringT_>::BkTree(BkTreeMetric metric) : _metric(metric) {
+    }
+
+    template <StdString StringT_>
+    auto BkTree<StringT_>::insert(const StringT& string) -> this_type& {
+        return insert(std::vector<StringT> {string});
+    }
+
+    template <StdString StringT_>
+    auto BkTree<StringT_>::insert(const std::vector<StringT>& strings) -> this_type& {
+        const std::size_t first_id = _strings.size();
+
+        if (first_id + strings.size() >= std::numeric_limits<std::uint32_t>::max()) {
+            throw std::runtime_error("Too many entries for a BK-tree");
+        }
+
+        _strings.add_all(strings);
+
+        if (get_overflow_size() * OVERFLOW_DIVISOR <= _node_entries.size()) {
+            return *this;
+        }
+
+        // Nothing is inserted when the build fails
+        try {
+            rebuild();
+        }
+        catch (...) {
+            _strings.truncate(first_id);
+            rebuild();
+            throw;
+        }
+
+        return *this;
+    }
+
+    template <StdString StringT_>
+    auto BkTree<StringT_>::insert_lines(std::basic_istream<char_type>& stream) -> this_type& {
+        for_each_line_chunk<StringT>(stream, _index_build_options.resolved_chunk_size(),
+                                     [this](const std::vector<StringT>& lines) { insert(lines); });
+
+        return *this;
+    }
+
+    template <StdString StringT_>
+    auto BkTree<StringT_>::set_index_build_options(IndexBuildOptions index_build_options)
+        -> this_type& {
+        _index_build_options = std::move(index_build_options);
+
+        return *this;
+    }
+
+    template <StdString StringT_>
+    std::vector<BkTreeMatch> BkTree<StringT_>::find_within(const StringT& query,
+                                                           std::size_t max_distance,
+                                                           BkTreeSearchStats* stats) const {
+        std::vector<BkTreeMatch> matches;
+        const rapidfuzz::CachedLevenshtein<char_type> levenshtein(query);
+        const rapidfuzz::CachedIndel<char_type> indel(query);
+        std::vector<std::uint32_t> pending;
+        std::size_t visited_count {};
+
+        if (!_node_entries.empty()) {
+            pending.push_back(0);
+        }
+
+        while (!pending.empty()) {
+            const std::uint32_t node = pending.back();
+
+            pending.pop_back();
+
+            const string_view_type entry = _strings [_node_entries [node]];
+            const std::size_t node_distance = _metric == BkTreeMetric::levenshtein
+                                                  ? levenshtein.distance(entry)
+                                                  : indel.distance(entry);
+
+            ++visited_count;
+
+            if (node_distance <= max_distance) {
+                matches.push_back(
+                    BkTreeMatch {.id = _node_entries [node], .distance = node_distance});
+            }
+
+            // Only children at a distance within max_distance of node_distance can hold matches
+            const auto children_begin = _parent_distances.begin() + _first_children [node];
+            const auto children_end = _parent_distances.begin() + _first_children [node + 1];
+            const std::size_t lowest = node_distance > max_distance ? node_distance - max_distance
+                                                                    : 0;
+            const std::size_t highest = node_distance + max_distance;
+
+            for (auto child = std::lower_bound(children_begin, children_end, lowest);
+                 child != children_end && *child <= highest; ++child) {
+                pending.push_back(static_cast<std::uint32_t>(child - _parent_distances.begin()));
+            }
+        }
+
+        for (std::size_t id {_node_entries.size()}; id < _strings.size(); ++id) {
+            const std::size_t entry_distance =
+                _metric == BkTreeMetric::levenshtein
+                    ? levenshtein.distance(_strings [id], max_distance)
+                    : indel.distance(_strings [id], max_distance);
+
+            ++visited_count;
+
+            if (entry_distance <= max_distance) {
+                matches.push_back(BkTreeMatch {.id = id, .distance = entry_distance});
+            }
+        }
+
+        if (stats != nullptr) {
+            stats->visited_count = visited_count;
+        }
+
+        std::sort(matches.begin(), matches.end(),
+                  [](const BkTreeMatch& lhs, const BkTreeMatch& rhs) {
+                      return lhs.distance != rhs.distance ? lhs.distance < rhs.distance
+                                                          : lhs.id < rhs.id;
+                  });
+
+        return matches;
+    }
+
+    template <StdString StringT_>
+    std::vector<SearchResult> BkTree<StringT_>::search(const StringT& query, std::size_t k,
+                                                       std::size_t max_distance) const {
+        const rapidfuzz::fuzz::CachedRatio<char_type> scorer(query);
+        std::vector<SearchResult> results;
+
+        for (const BkTreeMatch& match: find_within(query, max_distance)) {
+            results.push_back(
+                SearchResult {.id = match.id, .score = scorer.similarity(_strings [match.id])});
+        }
+
+        return merge_results(std::move(results), k);
+    }
+
+    template <StdString StringT_>
+    auto BkTree<StringT_>::get(std::size_t id) const -> string_view_type {
+        return _strings.at(id);
+    }
+
+    template <StdString StringT_>
+    std::size_t BkTree<StringT_>::size() const {
+        return _strings.size();
+    }
+
+    template <StdString StringT_>
+    BkTreeMetric BkTree<StringT_>::get_metric() const {
+        return _metric;
+    }
+
+    template <StdString StringT_>
+    std::size_t BkTree<StringT_>::get_depth() const {
+        std::vector<std::size_t> depths(_node_entries.size());
+        std::size_t depth {};
+
+        // Breadth first, so every parent comes before its children
+        for (std::size_t node {0}; node < _node_entries.size(); ++node) {
+            for (std::uint32_t child = _first_children [node]; child < _first_children [node + 1];
+                 ++child) {
+                depths [child] = depths [node] + 1;
+                depth = std::max(depth, depths [child]);
+            }
+        }
+
+        return depth;
+    }
+
+    template <StdString StringT_>
+    std::size_t BkTree<StringT_>::get_overflow_size() const {
+        return _strings.size() - _node_entries.size();
+    }
+
+    template <StdString StringT_>
+    std::size_t BkTree<StringT_>::distance(string_view_type lhs, string_view_type rhs) const {
+        return _metric == BkTreeMetric::levenshtein ? rapidfuzz::levenshtein_distance(lhs, rhs)
+                                                    : rapidfuzz::indel_distance(lhs, rhs);
+    }
+
+    template <StdString StringT_>
+    void BkTree<StringT_>::rebuild() {
+        struct Group {
+            std::uint32_t node {}; // The pivot, whose subtree the members go into
+            std::size_t begin {};  // Range of the level's members
+            std::size_t end {};
+        };
+
+        const std::size_t entry_count = _strings.size();
+
+        _node_entries.clear();
+        _parent_distances.clear();
+        _first_children.clear();
+
+        if (entry_count == 0) {
+            return;
+        }
+
+        _node_entries.reserve(entry_count);
+        _parent_distances.reserve(entry_count);
+        _first_children.reserve(entry_count + 1);
+        _node_entries.push_back(0);
+        _parent_distances.push_back(0);
+
+        // Entries still to place, grouped by the node whose subtree they go into
+        std::vector<std::uint32_t> members(entry_count - 1);
+        std::vector<Group> groups {Group {.node = 0, .begin = 0, .end = members.size()}};
+        std::vector<std::uint32_t> member_nodes;
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> distances; // Distance, entry
+        std::size_t level_begin {0};
+
+        for (std::size_t entry {1}; entry < entry_count; ++entry) {
+            members [entry - 1] = static_cast<std::uint32_t>(entry);
+        }
+
+        while (level_begin < _node_entries.size()) {
+            const std::size_t level_end = _node_entries.size();
+
+            // The expensive part: every member's distance to its pivot, in parallel
+            member_nodes.assign(members.size(), 0);
+
+            for (const Group& group: groups) {
+                std::fill(member_nodes.begin() + static_cast<std::ptrdiff_t>(group.begin),
+                          member_nodes.begin() + static_cast<std::ptrdiff_t>(group.end),
+                          group.node);
+            }
+
+            distances.resize(members.size());
+            parallel_for_chunks(
+                members.size(), _index_build_options.resolved_chunk_size(),
+                _index_build_options.resolved_thread_count(),
+                [&](std::size_t begin, std::size_t end) {
+                    for (std::size_t member {begin}; member < end; ++member) {
+                        const std::uint32_t pivot = _node_entries [member_nodes [member]];
+                        const std::size_t member_distance =
+                            distance(_strings [members [member]], _strings [pivot]);
+
+                        distances [member] = {static_cast<std::uint32_t>(member_distance),
+                                              members [member]};
+                    }
+                });
+
+            // Every node of this level gets its children, in node order so children stay
+            // contiguous; the first member at each distance becomes the child and the others
+            // its group on the next level
+            std::vector<std::uint32_t> next_members;
+            std::vector<Group> next_groups;
+            auto group = groups.begin();
+
+            next_members.reserve(members.size());
+
+            for (std::size_t node {level_begin}; node < level_end; ++node) {
+                _first_children.push_back(static_cast<std::uint32_t>(_node_entries.size()));
+
+                if (group == groups.end() || group->node != node) {
+                    continue;
+                }
+
+                const auto group_begin =
+                    distances.begin() + static_cast<std::ptrdiff_t>(group->begin);
+                const auto group_end =
+                    distances.begin() + static_cast<std::ptrdiff_t>(group->end);
+
+                std::sort(group_begin, group_end);
+
+                for (auto child = group_begin; child != group_end;) {
+                    const auto siblings_end =
+                        std::find_if(child, group_end, [&child](const auto& member) {
+                            return member.first != child->first;
+                        });
+                    const auto child_node = static_cast<std::uint32_t>(_node_entries.size());
+
+                    _node_entries.push_back(child->second);
+                    _parent_distances.push_back(child->first);
+
+                    if (child + 1 != siblings_end) {
+                        const std::size_t next_begin = next_members.size();
+
+                        for (auto sibling = child + 1; sibling != siblings_end; ++sibling) {
+                            next_members.push_back(sibling->second);
+                        }
+
+                        next_groups.push_back(Group {
+                            .node = child_node, .begin = next_begin, .end = next_members.size()});
+                    }
+
+                    child = siblings_end;
+                }
+
+                ++group;
+            }
+
+            members = std::move(next_members);
+            groups = std::move(next_groups);
+            level_begin = level_end;
+
+            if (_index_build_options.progress) {
+                _index_build_options.progress({.stage = IndexBuildProgress::Stage::index,
+                                               .completed = _node_entries.size(),
+                                               .total = entry_count});
+            }
+        }
+
+        _first_children.push_back(static_cast<std::uint32_t>(_node_entries.size()));
+    }
+} // namespace efuzz
+
+#endif // EFUZZ_BK_TREE_HPP
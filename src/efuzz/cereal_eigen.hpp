@@ -1,10 +1,13 @@
 #ifndef LEXOCRAFT_CEREAL_EIGEN_HPP
 #define LEXOCRAFT_CEREAL_EIGEN_HPP
 
+#include <algorithm>
 #include <cereal/archives/binary.hpp>
 #include <cereal/cereal.hpp>
+#include <cereal/types/vector.hpp>
 #include <cstddef>
 #include <Eigen/Dense>
+#include <vector>
 
 namespace cereal {
     template <class Archive, class Scalar, int Rows, int Cols, int Options, int MaxRows,
@@ -19,6 +22,20 @@ namespace cereal {
         archive(binary_data(matrix.data(), rows * cols * sizeof(Scalar)));
     }
 
+    // Written exactly like the matrix it views; load into a matrix.
+    template <class Archive, class Scalar, int Rows, int Cols, int Options, int MaxRows,
+              int MaxCols, int MapOptions, class StrideType>
+    inline void save(Archive& archive,
+                     const Eigen::Map<Eigen::Matrix<Scalar, Rows, Cols, Options, MaxRows, MaxCols>,
+                                      MapOptions, StrideType>& matrix)
+        requires traits::is_output_serializable<BinaryData<Scalar>, Archive>::value {
+        std::size_t rows = matrix.rows();
+        std::size_t cols = matrix.cols();
+        archive(rows);
+        archive(cols);
+        archive(binary_data(matrix.data(), rows * cols * sizeof(Scalar)));
+    }
+
     template <class Archive, class Scalar, int Rows, int Cols, int Options, int MaxRows,
               int MaxCols>
     inline void load(Archive& archive,
@@ -33,6 +50,53 @@ namespace cereal {
 
         archive(binary_data(matrix.data(), static_cast<std::size_t>(rows * cols * sizeof(Scalar))));
     }
+
+    // Archives without binary data, such as JSON and XML, get the elements as a list.
+    template <class Archive, class Scalar, int Rows, int Cols, int Options, int MaxRows,
+              int MaxCols>
+    inline void save(Archive& archive,
+                     const Eigen::Matrix<Scalar, Rows, Cols, Options, MaxRows, MaxCols>& matrix)
+        requires(!traits::is_output_serializable<BinaryData<Scalar>, Archive>::value) {
+        std::size_t rows = matrix.rows();
+        std::size_t cols = matrix.cols();
+        archive(rows);
+        archive(cols);
+        archive(std::vector<Scalar>(matrix.data(), matrix.data() + matrix.size()));
+    }
+
+    template <class Archive, class Scalar, int Rows, int Cols, int Options, int MaxRows,
+              int MaxCols, int MapOptions, class StrideType>
+    inline void save(Archive& archive,
+                     const Eigen::Map<Eigen::Matrix<Scalar, Rows, Cols, Options, MaxRows, MaxCols>,
+                                      MapOptions, StrideType>& matrix)
+        requires(!traits::is_output_serializable<BinaryData<Scalar>, Archive>::value) {
+        std::size_t rows = matrix.rows();
+        std::size_t cols = matrix.cols();
+        archive(rows);
+        archive(cols);
+        archive(std::vector<Scalar>(matrix.data(), matrix.data() + matrix.size()));
+    }
+
+    template <class Archive, class Scalar, int Rows, int Cols, int Options, int MaxRows,
+              int MaxCols>
+    inline void load(Archive& archive,
+                     Eigen::Matrix<Scalar, Rows, Cols, Options, MaxRows, MaxCols>& matrix)
+        requires(!traits::is_input_serializable<BinaryData<Scalar>, Archive>::value) {
+        std::size_t rows = 0;
+        std::size_t cols = 0;
+        std::vector<Scalar> elements;
+        archive(rows);
+        archive(cols);
+        archive(elements);
+
+        if (elements.size() != rows * cols) {
+            throw Exception("Matrix element count does not match its shape");
+        }
+
+        matrix.resize(rows, cols);
+
+        std::copy(elements.begin(), elements.end(), matrix.data());
+    }
 } // namespace cereal
 
 #endif
@@ -0,0 +1,367 @@
+#ifndef EFUZZ_DELETION_INDEX_HPP
+#define EFUZZ_DELETION_INDEX_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <efuzz/efuzz.hpp>
+#include <efuzz/index_build.hpp>
+#include <efuzz/string_pool.hpp>
+
+namespace efuzz {
+    struct DeletionIndexOptions {
+        constexpr static std::size_t DEFAULT_MAX_EDIT_DISTANCE {2};
+        constexpr static std::size_t DEFAULT_PREFIX_LENGTH {7};
+
+        // Largest edit distance a search can ask for. Every entry stores all of its variants
+        // with up to this many characters deleted, so keep it small.
+        std::size_t max_edit_distance {DEFAULT_MAX_EDIT_DISTANCE};
+        // Variants are only taken from the first prefix_length characters of an entry or a
+        // query, which bounds the keys of long entries without losing any match (0 for the
+        // whole string).
+        std::size_t prefix_length {DEFAULT_PREFIX_LENGTH};
+    };
+
+    // Dictionary searched by deletion neighborhoods, as in SymSpell: an entry and a query within
+    // d edits of each other share a variant with at most d characters deleted from each. The
+    // index keeps only 64-bit hashes of the variants, sorted, so a search is a few binary
+    // searches; hash collisions and variants shared by more distant strings are removed by
+    // checking the Levenshtein distance with rapidfuzz. Results are exactly the entries within
+    // the edit distance, ranked like SearchContainer's by rapidfuzz::fuzz::ratio.
+    //
+    // Keys are kept in sorted runs, log-structured: each insert adds a run of its keys, which is
+    // merged with the newest runs while they are less than twice its size. Every run is then
+    // more than twice the size of the next newer one, so there are at most log2 of the key
+    // count runs to search, and an insert costs amortized O(log N) per key rather than
+    // rewriting every stored key.
+    template <StdString StringT_>
+    class DeletionIndex {
+        public:
+
+        using StringT = StringT_;
+        using char_type = typename StringT::value_type;
+        using string_view_type = typename StringPool<StringT>::string_view_type;
+        using this_type = DeletionIndex<StringT>;
+
+        DeletionIndex() = default;
+        explicit DeletionIndex(DeletionIndexOptions options);
+
+        this_type& insert(const StringT& string);
+        // Adds the keys of all the strings as one run.
+        this_type& insert(const std::vector<StringT>& strings);
+        this_type& insert_lines(std::basic_istream<char_type>& stream);
+        // Drops every entry from id `size` on, so ids handed out before stay valid.
+        this_type& truncate(std::size_t size);
+
+        // The k best entries within the index's max_edit_distance of query. Safe to call from
+        // several threads at once, as long as nothing modifies the index.
+        [[nodiscard]] std::vector<SearchResult> search(const StringT& query, std::size_t k) const;
+        // Throws if max_edit_distance is above the index's.
+        [[nodiscard]] std::vector<SearchResult>
+            search(const StringT& query, std::size_t k, std::size_t max_edit_distance) const;
+        // Searches are spread over thread_count threads.
+        [[nodiscard]] std::vector<std::vector<SearchResult>>
+            search_batch(const std::vector<StringT>& queries, std::size_t k,
+                         std::size_t thread_count = 1) const;
+
+        // Valid until the next insert.
+        [[nodiscard]] string_view_type get(std::size_t id) const;
+        [[nodiscard]] std::size_t size() const;
+        // Deletion variants stored over all entries.
+        [[nodiscard]] std::size_t get_key_count() const;
+        // Sorted key runs a search looks through.
+        [[nodiscard]] std::size_t get_run_count() const;
+        // Keys copied by run merges over all inserts, the work of building the index.
+        [[nodiscard]] std::size_t get_merged_key_count() const;
+        [[nodiscard]] const DeletionIndexOptions& get_options() const;
+
+        private:
+
+        // Sorted by hash, then by id; ids [i] is the entry hashes [i] came from
+        struct KeyRun {
+            std::vector<std::uint64_t> hashes;
+            std::vector<std::uint32_t> ids;
+        };
+
+        // The keys of both runs, sorted by hash, then by id.
+        [[nodiscard]] static KeyRun merge_keys(const KeyRun& lhs, const KeyRun& rhs);
+        // Appends the ids of run's keys equal to hash.
+        static void find_key(const KeyRun& run, std::uint64_t hash,
+                             std::vector<std::uint32_t>& ids);
+        // Sorted hashes of the variants of string's prefix with up to max_deletions characters
+        // deleted, the prefix itself included.
+        [[nodiscard]] std::vector<std::uint64_t>
+            deletion_keys(string_view_type string, std::size_t max_deletions) const;
+
+        DeletionIndexOptions _options;
+        StringPool<StringT> _strings; // Ids are positions, as in SearchContainer
+        std::vector<KeyRun> _runs; // Oldest and largest first
+        std::size_t _merged_key_count {};
+    };
+
+    template <StdString StringT_>
+    DeletionIndex<StringT_>::DeletionIndex(DeletionIndexOptions options) : _options(options) {
+    }
+
+    template <StdString StringT_>
+    auto DeletionIndex<StringT_>::insert(const StringT& string) -> this_type& {
+        return insert(std::vector<StringT> {string});
+    }
+
+    template <StdString StringT_>
+    auto DeletionIndex<StringT_>::insert(const std::vector<StringT>& strings) -> this_type& {
+        if (strings.empty()) {
+            return *this;
+        }
+
+        const std::size_t first_id = _strings.size();
+
+        if (first_id + strings.size() > std::numeric_limits<std::uint32_t>::max()) {
+            throw std::runtime_error("Too many entries for a deletion index");
+        }
+
+        std::vector<std::pair<std::uint64_t, std::uint32_t>> new_keys;
+
+        for (std::size_t index {0}; index < strings.size(); ++index) {
+            const auto id = static_cast<std::uint32_t>(first_id + index);
+
+            for (const std::uint64_t hash:
+                 deletion_keys(strings [index], _options.max_edit_distance)) {
+                new_keys.emplace_back(hash, id);
+            }
+        }
+
+        std::sort(new_keys.begin(), new_keys.end());
+
+        KeyRun new_run;
+
+        new_run.hashes.reserve(new_keys.size());
+        new_run.ids.reserve(new_keys.size());
+
+        for (const auto& [hash, id]: new_keys) {
+            new_run.hashes.push_back(hash);
+            new_run.ids.push_back(id);
+        }
+
+        // Merged into a new run, so the index is unchanged if anything throws
+        std::size_t merged_runs {0};
+        std::size_t merged_key_count {0};
+
+        while (merged_runs < _runs.size() &&
+               _runs [_runs.size() - merged_runs - 1].hashes.size() <=
+                   2 * new_run.hashes.size()) {
+            new_run = merge_keys(_runs [_runs.size() - merged_runs - 1], new_run);
+            merged_key_count += new_run.hashes.size();
+            ++merged_runs;
+        }
+
+        _runs.reserve(_runs.size() + 1);
+        _strings.add_all(strings);
+        _runs.resize(_runs.size() - merged_runs);
+        _runs.push_back(std::move(new_run));
+        _merged_key_count += merged_key_count;
+
+        return *this;
+    }
+
+    template <StdString StringT_>
+    auto DeletionIndex<StringT_>::insert_lines(std::basic_istream<char_type>& stream)
+        -> this_type& {
+        for_each_line_chunk<StringT>(stream, IndexBuildOptions::DEFAULT_CHUNK_SIZE,
+                                     [this](const std::vector<StringT>& lines) { insert(lines); });
+
+        return *this;
+    }
+
+    template <StdString StringT_>
+    auto DeletionIndex<StringT_>::truncate(std::size_t size) -> this_type& {
+        if (size >= _strings.size()) {
+            return *this;
+        }
+
+        // In place, so the runs stay sorted
+        for (KeyRun& run: _runs) {
+            std::size_t kept {0};
+
+            for (std::size_t key {0}; key < run.hashes.size(); ++key) {
+                if (run.ids [key] < size) {
+                    run.hashes [kept] = run.hashes [key];
+                    run.ids [kept] = run.ids [key];
+                    ++kept;
+                }
+            }
+
+            run.hashes.resize(kept);
+            run.ids.resize(kept);
+        }
+
+        std::erase_if(_runs, [](const KeyRun& run) { return run.hashes.empty(); });
+        _strings.truncate(size);
+
+        return *this;
+    }
+
+    template <StdString StringT_>
+    std::vector<SearchResult> DeletionIndex<StringT_>::search(const StringT& query,
+                                                              std::size_t k) const {
+        return search(query, k, _options.max_edit_distance);
+    }
+
+    template <StdString StringT_>
+    std::vector<SearchResult> DeletionIndex<StringT_>::search(
+        const StringT& query, std::size_t k, std::size_t max_edit_distance) const {
+        if (max_edit_distance > _options.max_edit_distance) {
+            throw std::runtime_error("Edit distance above the deletion index's maximum");
+        }
+
+        std::vector<std::uint32_t> candidates;
+
+        for (const std::uint64_t hash: deletion_keys(query, max_edit_distance)) {
+            for (const KeyRun& run: _runs) {
+                find_key(run, hash, candidates);
+            }
+        }
+
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+        std::vector<SearchResult> results =
+            verify_edit_distance(query, _strings, candidates, max_edit_distance);
+
+        return merge_results(std::move(results), k);
+    }
+
+    template <StdString StringT_>
+    std::vector<std::vector<SearchResult>>
+        DeletionIndex<StringT_>::search_batch(const std::vector<StringT>& queries, std::size_t k,
+                                              std::size_t thread_count) const {
+        return search_each(queries, thread_count,
+                           [&](const StringT& query) { return search(query, k); });
+    }
+
+    template <StdString StringT_>
+    auto DeletionIndex<StringT_>::get(std::size_t id) const -> string_view_type {
+        return _strings.at(id);
+    }
+
+    template <StdString StringT_>
+    std::size_t DeletionIndex<StringT_>::size() const {
+        return _strings.size();
+    }
+
+    template <StdString StringT_>
+    std::size_t DeletionIndex<StringT_>::get_key_count() const {
+        std::size_t key_count {0};
+
+        for (const KeyRun& run: _runs) {
+            key_count += run.hashes.size();
+        }
+
+        return key_count;
+    }
+
+    template <StdString StringT_>
+    std::size_t DeletionIndex<StringT_>::get_run_count() const {
+        return _runs.size();
+    }
+
+    template <StdString StringT_>
+    std::size_t DeletionIndex<StringT_>::get_merged_key_count() const {
+        return _merged_key_count;
+    }
+
+    template <StdString StringT_>
+    const DeletionIndexOptions& DeletionIndex<StringT_>::get_options() const {
+        return _options;
+    }
+
+    template <StdString StringT_>
+    auto DeletionIndex<StringT_>::merge_keys(const KeyRun& lhs, const KeyRun& rhs) -> KeyRun {
+        KeyRun merged;
+        std::size_t lhs_key {0};
+        std::size_t rhs_key {0};
+
+        merged.hashes.reserve(lhs.hashes.size() + rhs.hashes.size());
+        merged.ids.reserve(lhs.ids.size() + rhs.ids.size());
+
+        while (lhs_key < lhs.hashes.size() || rhs_key < rhs.hashes.size()) {
+            const bool take_rhs =
+                lhs_key == lhs.hashes.size() ||
+                (rhs_key < rhs.hashes.size() &&
+                 std::pair(rhs.hashes [rhs_key], rhs.ids [rhs_key]) <
+                     std::pair(lhs.hashes [lhs_key], lhs.ids [lhs_key]));
+            const KeyRun& run = take_rhs ? rhs : lhs;
+            std::size_t& key = take_rhs ? rhs_key : lhs_key;
+
+            merged.hashes.push_back(run.hashes [key]);
+            merged.ids.push_back(run.ids [key]);
+            ++key;
+        }
+
+        return merged;
+    }
+
+    template <StdString StringT_>
+    void DeletionIndex<StringT_>::find_key(const KeyRun& run, std::uint64_t hash,
+                                           std::vector<std::uint32_t>& ids) {
+        const auto [begin, end] = std::equal_range(run.hashes.begin(), run.hashes.end(), hash);
+
+        ids.insert(ids.end(), run.ids.begin() + (begin - run.hashes.begin()),
+                   run.ids.begin() + (end - run.hashes.begin()));
+    }
+
+    template <StdString StringT_>
+    std::vector<std::uint64_t>
+        DeletionIndex<StringT_>::deletion_keys(string_view_type string,
+                                               std::size_t max_deletions) const {
+        if (_options.prefix_length > 0 && string.size() > _options.prefix_length) {
+            string = string.substr(0, _options.prefix_length);
+        }
+
+        std::unordered_set<StringT> variants {StringT(string)};
+        std::vector<StringT> previous_level {StringT(string)};
+        std::vector<StringT> level;
+
+        for (std::size_t deletions {1}; deletions <= max_deletions; ++deletions) {
+            level.clear();
+
+            for (const StringT& variant: previous_level) {
+                for (std::size_t position {0}; position < variant.size(); ++position) {
+                    StringT deleted = variant;
+
+                    deleted.erase(position, 1);
+
+                    if (variants.insert(deleted).second) {
+                        level.push_back(std::move(deleted));
+                    }
+                }
+            }
+
+            std::swap(previous_level, level);
+        }
+
+        std::vector<std::uint64_t> keys;
+
+        keys.reserve(variants.size());
+
+        for (const StringT& variant: variants) {
+            keys.push_back(std::hash<string_view_type> {}(variant));
+        }
+
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+        return keys;
+    }
+} // namespace efuzz
+
+#endif // EFUZZ_DELETION_INDEX_HPP
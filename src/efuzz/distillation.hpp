@@ -0,0 +1,185 @@
+#ifndef EFUZZ_DISTILLATION_HPP
+#define EFUZZ_DISTILLATION_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include <efuzz/encode.hpp>
+#include <efuzz/string_pool.hpp>
+
+namespace efuzz {
+    // Target function (EncoderTrainer::set_target_function) that trains a student encoder to
+    // reproduce the pairwise embedding distances of a teacher encoder. Both distances are
+    // normalized by the respective output_norm_max(), so the student may have a different
+    // encoding size. Teacher encodings of `dataset` are computed once up front; any other string
+    // is encoded when it comes up.
+    template <typename TeacherEncoderT>
+    class DistillationTarget {
+        public:
+
+        using StringT = typename TeacherEncoderT::StringT;
+        using string_view_type = typename StringPool<StringT>::string_view_type;
+
+        explicit DistillationTarget(TeacherEncoderT teacher,
+                                    const std::vector<StringT>& dataset = {});
+
+        [[nodiscard]] float operator()(string_view_type string_1, string_view_type string_2) const;
+
+        [[nodiscard]] const TeacherEncoderT& get_teacher() const;
+
+        private:
+
+        [[nodiscard]] Eigen::VectorXf teacher_encoding(string_view_type string) const;
+
+        // Shared, so the copies std::function makes stay cheap
+        std::shared_ptr<const TeacherEncoderT> _teacher;
+        // The distinct dataset strings, and their encodings in id order
+        std::shared_ptr<const StringPool<StringT>> _strings;
+        std::shared_ptr<const Eigen::MatrixXf> _encodings;
+        float _teacher_norm_max {};
+    };
+
+    struct StudentShape {
+        std::vector<std::size_t> layer_sizes;
+        std::size_t parameter_count {};
+        std::chrono::nanoseconds encode_latency {}; // Mean per word of the timing sample
+    };
+
+    // Mean time encoder.encode() takes per word of `sample`, best of `repetitions` passes.
+    template <typename EncoderT>
+    [[nodiscard]] std::chrono::nanoseconds
+        measure_encode_latency(const EncoderT& encoder,
+                               const std::vector<typename EncoderT::StringT>& sample,
+                               std::size_t repetitions = 5);
+
+    // Times a randomly initialized copy of `prototype` for every candidate list of hidden layer
+    // sizes. The input and output layers come from the prototype.
+    template <typename EncoderT>
+    [[nodiscard]] std::vector<StudentShape>
+        measure_student_shapes(const EncoderT& prototype,
+                               const std::vector<std::vector<std::size_t>>& hidden_layer_sizes,
+                               const std::vector<typename EncoderT::StringT>& sample);
+
+    // The largest shape (by parameter count) that encodes within latency_budget, if any does.
+    [[nodiscard]] inline std::optional<StudentShape>
+        choose_student_shape(const std::vector<StudentShape>& shapes,
+                             std::chrono::nanoseconds latency_budget) {
+        std::optional<StudentShape> chosen;
+
+        for (const auto& shape: shapes) {
+            if (shape.encode_latency <= latency_budget &&
+                (!chosen || shape.parameter_count > chosen->parameter_count)) {
+                chosen = shape;
+            }
+        }
+
+        return chosen;
+    }
+
+    template <typename TeacherEncoderT>
+    DistillationTarget<TeacherEncoderT>::DistillationTarget(TeacherEncoderT teacher,
+                                                            const std::vector<StringT>& dataset) :
+        _teacher(std::make_shared<const TeacherEncoderT>(std::move(teacher))),
+        _teacher_norm_max(_teacher->output_norm_max()) {
+        auto strings = std::make_shared<StringPool<StringT>>(dataset, true);
+
+        _encodings = std::make_shared<const Eigen::MatrixXf>(
+            strings->empty() ? Eigen::MatrixXf() : _teacher->encode_batch(strings->views()));
+        _strings = std::move(strings);
+    }
+
+    template <typename TeacherEncoderT>
+    float DistillationTarget<TeacherEncoderT>::operator()(string_view_type string_1,
+                                                          string_view_type string_2) const {
+        return (teacher_encoding(string_1) - teacher_encoding(string_2)).norm() /
+               _teacher_norm_max;
+    }
+
+    template <typename TeacherEncoderT>
+    const TeacherEncoderT& DistillationTarget<TeacherEncoderT>::get_teacher() const {
+        return *_teacher;
+    }
+
+    template <typename TeacherEncoderT>
+    Eigen::VectorXf DistillationTarget<TeacherEncoderT>::teacher_encoding(
+        string_view_type string) const {
+        const std::optional<std::size_t> id = _strings->find(string);
+
+        if (id.has_value()) {
+            return _encodings->col(static_cast<Eigen::Index>(id.value()));
+        }
+
+        return _teacher->encode(string);
+    }
+
+    template <typename EncoderT>
+    std::chrono::nanoseconds
+        measure_encode_latency(const EncoderT& encoder,
+                               const std::vector<typename EncoderT::StringT>& sample,
+                               std::size_t repetitions) {
+        using clock = std::chrono::steady_clock;
+
+        if (sample.empty()) {
+            return {};
+        }
+
+        auto best = clock::duration::max();
+        volatile float checksum {}; // Keeps the encodes from being optimized away
+
+        for (std::size_t repetition {0}; repetition <= repetitions; ++repetition) {
+            const clock::time_point start = clock::now();
+
+            for (const auto& word: sample) {
+                checksum = checksum + encoder.encode(word).sum();
+            }
+
+            // The first pass only warms up caches and per-thread buffers
+            if (repetition > 0) {
+                best = std::min(best, clock::now() - start);
+            }
+        }
+
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            best / static_cast<long>(sample.size()));
+    }
+
+    template <typename EncoderT>
+    std::vector<StudentShape>
+        measure_student_shapes(const EncoderT& prototype,
+                               const std::vector<std::vector<std::size_t>>& hidden_layer_sizes,
+                               const std::vector<typename EncoderT::StringT>& sample) {
+        std::vector<StudentShape> shapes;
+
+        for (const auto& hidden_sizes: hidden_layer_sizes) {
+            StudentShape shape;
+
+            shape.layer_sizes.push_back(prototype.get_nn_input_size());
+            shape.layer_sizes.insert(shape.layer_sizes.end(), hidden_sizes.begin(),
+                                     hidden_sizes.end());
+            shape.layer_sizes.push_back(prototype.get_nn_output_size());
+
+            EncoderT student = prototype;
+
+            student.set_encoding_nn_layer_sizes(shape.layer_sizes);
+
+            for (std::size_t layer {1}; layer < shape.layer_sizes.size(); ++layer) {
+                shape.parameter_count +=
+                    (shape.layer_sizes [layer - 1] + 1) * shape.layer_sizes [layer];
+            }
+
+            shape.encode_latency = measure_encode_latency(student, sample);
+            shapes.push_back(std::move(shape));
+        }
+
+        return shapes;
+    }
+} // namespace efuzz
+
+#endif // EFUZZ_DISTILLATION_HPP
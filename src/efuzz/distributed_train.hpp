@@ -0,0 +1,629 @@
+#ifndef EFUZZ_DISTRIBUTED_TRAIN_HPP
+#define EFUZZ_DISTRIBUTED_TRAIN_HPP
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <iterator>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <efuzz/neural_network/neural_network.hpp>
+#include <efuzz/train_encoder.hpp>
+
+namespace efuzz {
+    struct DistributedTrainingOptions {
+        std::size_t worker_count {2};
+        std::size_t candidates_per_worker {1};
+        // Pairs sampled per iteration, identical on every worker. Zero evaluates every pair.
+        // With a pair sampler set on the trainer, the coordinator draws them and sends them to
+        // the workers.
+        std::size_t batch_pairs {};
+    };
+
+    struct DistributedTrainingResult {
+        bool accepted {};
+        std::uint64_t seed {};
+        float scale {};
+        float original_cost {};
+        float modified_cost {}; // Best candidate, accepted or not
+        std::size_t candidates {};
+    };
+
+    // Runs EncoderTrainer candidate evaluation in worker processes. Each worker holds its own copy
+    // of the dataset and network. A candidate diff travels as (seed, scale) and only costs travel
+    // back, so traffic per iteration does not depend on the network size. The accepted diff is
+    // broadcast the same way, which keeps every copy of the network bit-identical.
+    template <typename TrainerT>
+    class TrainingCoordinator {
+        public:
+
+        using this_type = TrainingCoordinator<TrainerT>;
+        using StringT = typename TrainerT::StringT;
+        using DiffScalarFunction = typename TrainerT::DiffScalarFunction;
+
+        // Forks options.worker_count local workers connected over Unix socket pairs. The forked
+        // workers run the whole training stack, which is only safe in a child of a single-threaded
+        // process: construct the coordinator before starting a SearchScheduler or any other
+        // thread. Throws std::logic_error if the process already has other threads (checked where
+        // /proc/self/task exists).
+        TrainingCoordinator(TrainerT trainer, DistributedTrainingOptions options);
+        // Uses already connected workers, each running run_worker() on the other end.
+        TrainingCoordinator(TrainerT trainer, std::vector<int> worker_sockets,
+                            DistributedTrainingOptions options);
+        TrainingCoordinator(const TrainingCoordinator&) = delete;
+        TrainingCoordinator& operator=(const TrainingCoordinator&) = delete;
+        ~TrainingCoordinator();
+
+        // Without a DiffScalarFunction the trainer's step size control sets the scale and is told
+        // whether the round was accepted; with many candidates per round, success is the best
+        // of all of them, so a success rule settles at a larger scale.
+        DistributedTrainingResult
+            train(const std::optional<DiffScalarFunction>& diff_scalar_function = std::nullopt);
+        void shutdown() noexcept;
+
+        [[nodiscard]] const TrainerT& get_trainer() const;
+        [[nodiscard]] std::size_t get_worker_count() const;
+
+        // Serves coordinator requests on `socket` until told to shut down.
+        static void run_worker(TrainerT trainer, int socket);
+
+        private:
+
+        enum class Command : std::uint32_t { evaluate, accept, shutdown };
+
+        struct Request {
+            Command command {};
+            std::uint32_t candidate_count {};
+            std::uint32_t batch_pairs {};
+            // The batch_pairs id pairs follow the request instead of being drawn from batch_seed
+            std::uint32_t pairs_follow {};
+            std::uint64_t batch_seed {};
+            std::uint64_t first_seed {};
+            float scale {};
+        };
+
+        struct Response {
+            float original_cost {};
+            std::uint32_t candidate_count {};
+        };
+
+        // On the wire every field is a little-endian integer of fixed width, a float being its
+        // IEEE 754 bits, so no padding is sent and the two ends need not share a struct layout.
+        constexpr static std::size_t REQUEST_SIZE {(4 * sizeof(std::uint32_t)) +
+                                                   (2 * sizeof(std::uint64_t)) + sizeof(float)};
+        constexpr static std::size_t RESPONSE_SIZE {sizeof(float) + sizeof(std::uint32_t)};
+
+        using RequestBytes = std::array<std::uint8_t, REQUEST_SIZE>;
+
+        static std::vector<typename TrainerT::IdPair>
+            sample_pairs(const TrainerT& trainer, std::size_t pair_count, std::uint64_t seed);
+        // Threads of this process, or nothing if the platform does not list them.
+        static std::optional<std::size_t> process_thread_count();
+        static void put(std::uint8_t*& bytes, std::uint64_t value, std::size_t width) noexcept;
+        [[nodiscard]] static std::uint64_t take(const std::uint8_t*& bytes,
+                                                std::size_t width) noexcept;
+        [[nodiscard]] static RequestBytes encode_request(const Request& request) noexcept;
+        static void send_request(int socket, const Request& request);
+        // Throws on an unknown command.
+        [[nodiscard]] static Request receive_request(int socket);
+        static void send_response(int socket, const Response& response,
+                                  const std::vector<float>& costs);
+        // Sizes `costs` to candidate_count and fills it; throws if the response carries another
+        // number of costs.
+        [[nodiscard]] static Response receive_response(int socket, std::uint32_t candidate_count,
+                                                       std::vector<float>& costs);
+        // Floats go as their bits, like the fields of a request.
+        template <typename ValueT>
+        static void send_values(int socket, const std::vector<ValueT>& values);
+        // Fills `values`, already sized, with what send_values sent.
+        template <typename ValueT>
+        static void receive_values(int socket, std::vector<ValueT>& values);
+        static void send_all(int socket, const void* data, std::size_t size);
+        static void receive_all(int socket, void* data, std::size_t size);
+
+        TrainerT _trainer;
+        DistributedTrainingOptions _options;
+        std::vector<int> _sockets;
+        std::vector<pid_t> _worker_pids;
+        std::mt19937_64 _random_engine {std::random_device {}()};
+    };
+
+    template <typename TrainerT>
+    TrainingCoordinator<TrainerT>::TrainingCoordinator(TrainerT trainer,
+                                                       DistributedTrainingOptions options) :
+        _trainer(std::move(trainer)),
+        _options(options) {
+        if (_options.worker_count > 0 && process_thread_count().value_or(1) > 1) {
+            throw std::logic_error(
+                "Training workers can only be forked from a single-threaded process");
+        }
+
+        for (std::size_t worker {0}; worker < _options.worker_count; ++worker) {
+            std::array<int, 2> sockets {};
+
+            if (::socketpair(AF_UNIX, SOCK_STREAM, 0, sockets.data()) != 0) {
+                shutdown();
+                throw std::runtime_error(std::string("socketpair failed: ") +
+                                         std::strerror(errno));
+            }
+
+            const pid_t pid = ::fork();
+
+            if (pid < 0) {
+                ::close(sockets [0]);
+                ::close(sockets [1]);
+                shutdown();
+                throw std::runtime_error(std::string("fork failed: ") + std::strerror(errno));
+            }
+
+            if (pid == 0) {
+                ::close(sockets [0]);
+
+                for (const int socket: _sockets) {
+                    ::close(socket);
+                }
+
+                int status {};
+
+                try {
+                    run_worker(_trainer, sockets [1]);
+                }
+                catch (...) {
+                    status = 1;
+                }
+
+                ::_exit(status);
+            }
+
+            ::close(sockets [1]);
+            _sockets.push_back(sockets [0]);
+            _worker_pids.push_back(pid);
+        }
+    }
+
+    template <typename TrainerT>
+    TrainingCoordinator<TrainerT>::TrainingCoordinator(TrainerT trainer,
+                                                       std::vector<int> worker_sockets,
+                                                       DistributedTrainingOptions options) :
+        _trainer(std::move(trainer)),
+        _options(options), _sockets(std::move(worker_sockets)) {
+        _options.worker_count = _sockets.size();
+    }
+
+    template <typename TrainerT>
+    TrainingCoordinator<TrainerT>::~TrainingCoordinator() {
+        shutdown();
+    }
+
+    template <typename TrainerT>
+    DistributedTrainingResult TrainingCoordinator<TrainerT>::train(
+        const std::optional<DiffScalarFunction>& diff_scalar_function) {
+        if (_sockets.empty()) {
+            throw std::runtime_error("No training workers");
+        }
+
+        _trainer._training_iterations++;
+
+        Request request {.command = Command::evaluate,
+                         .candidate_count =
+                             static_cast<std::uint32_t>(_options.candidates_per_worker),
+                         .batch_pairs = static_cast<std::uint32_t>(_options.batch_pairs),
+                         .batch_seed = _random_engine(),
+                         .scale = _trainer.diff_scale(diff_scalar_function)};
+
+        const std::uint64_t first_seed = _random_engine();
+        // Sampled from the coordinator's network, which matches the workers'
+        std::vector<std::uint64_t> sampled_ids;
+
+        if (_options.batch_pairs > 0 && _trainer._pair_sampler) {
+            const auto id_pairs = _trainer._pair_sampler(_trainer, _options.batch_pairs);
+
+            for (const auto& [id_1, id_2]: id_pairs) {
+                sampled_ids.push_back(id_1);
+                sampled_ids.push_back(id_2);
+            }
+
+            request.batch_pairs = static_cast<std::uint32_t>(sampled_ids.size() / 2);
+            request.pairs_follow = 1;
+        }
+
+        for (std::size_t worker {0}; worker < _sockets.size(); ++worker) {
+            request.first_seed = first_seed + (worker * _options.candidates_per_worker);
+            send_request(_sockets [worker], request);
+
+            if (request.pairs_follow != 0) {
+                send_values(_sockets [worker], sampled_ids);
+            }
+        }
+
+        DistributedTrainingResult result {.scale = request.scale};
+        std::optional<float> original_cost;
+        std::vector<float> costs;
+
+        for (std::size_t worker {0}; worker < _sockets.size(); ++worker) {
+            const Response response =
+                receive_response(_sockets [worker], request.candidate_count, costs);
+
+            if (original_cost.has_value() && original_cost.value() != response.original_cost) {
+                throw std::runtime_error(
+                    "Training workers disagree on the original cost; their networks are out of "
+                    "sync");
+            }
+
+            original_cost = response.original_cost;
+
+            for (std::size_t candidate {0}; candidate < costs.size(); ++candidate) {
+                if (result.candidates == 0 || costs [candidate] < result.modified_cost) {
+                    result.modified_cost = costs [candidate];
+                    result.seed = first_seed + (worker * _options.candidates_per_worker) +
+                                  candidate;
+                }
+
+                result.candidates++;
+            }
+        }
+
+        result.original_cost = original_cost.value_or(0.0F);
+        result.accepted = result.candidates > 0 && result.modified_cost < result.original_cost;
+
+        if (!diff_scalar_function.has_value()) {
+            _trainer._step_size_control.record(result.accepted);
+        }
+
+        if (result.accepted) {
+            const Request accept {
+                .command = Command::accept, .first_seed = result.seed, .scale = result.scale};
+
+            for (const int socket: _sockets) {
+                send_request(socket, accept);
+            }
+
+            _trainer.modify_encoder(_trainer.make_diff(result.seed, result.scale));
+        }
+
+        return result;
+    }
+
+    template <typename TrainerT>
+    void TrainingCoordinator<TrainerT>::shutdown() noexcept {
+        const RequestBytes request = encode_request({.command = Command::shutdown});
+
+        for (const int socket: _sockets) {
+            ::send(socket, request.data(), request.size(), MSG_NOSIGNAL);
+            ::close(socket);
+        }
+
+        for (const pid_t pid: _worker_pids) {
+            int status {};
+
+            ::waitpid(pid, &status, 0);
+        }
+
+        _sockets.clear();
+        _worker_pids.clear();
+    }
+
+    template <typename TrainerT>
+    const TrainerT& TrainingCoordinator<TrainerT>::get_trainer() const {
+        return _trainer;
+    }
+
+    template <typename TrainerT>
+    std::size_t TrainingCoordinator<TrainerT>::get_worker_count() const {
+        return _sockets.size();
+    }
+
+    template <typename TrainerT>
+    void TrainingCoordinator<TrainerT>::run_worker(TrainerT trainer, int socket) {
+        std::vector<float> costs;
+
+        while (true) {
+            const Request request = receive_request(socket);
+
+            if (request.command == Command::shutdown) {
+                break;
+            }
+
+            if (request.command == Command::accept) {
+                trainer.modify_encoder(trainer.make_diff(request.first_seed, request.scale));
+
+                continue;
+            }
+
+            std::vector<typename TrainerT::IdPair> id_pairs;
+
+            if (request.pairs_follow != 0) {
+                std::vector<std::uint64_t> sampled_ids(2 * std::size_t {request.batch_pairs});
+                const std::size_t dataset_size =
+                    trainer._dataset ? trainer._dataset.value()->size() : 0;
+
+                receive_values(socket, sampled_ids);
+
+                if (std::ranges::any_of(sampled_ids,
+                                        [dataset_size](std::uint64_t id) {
+                                            return id >= dataset_size;
+                                        })) {
+                    throw std::runtime_error("Training request names pairs outside the dataset");
+                }
+
+                for (std::size_t pair {0}; pair < request.batch_pairs; ++pair) {
+                    id_pairs.emplace_back(sampled_ids [2 * pair], sampled_ids [(2 * pair) + 1]);
+                }
+            }
+            else {
+                id_pairs = sample_pairs(trainer, request.batch_pairs, request.batch_seed);
+            }
+
+            const auto evaluate = [&trainer, &id_pairs]() {
+                return id_pairs.empty() ? trainer.average_cost() : trainer.average_cost(id_pairs);
+            };
+
+            NeuralNetwork::ParameterBuffer& snapshot = trainer._parameter_snapshot;
+
+            trainer._encoder.get_word_vector_encoder_nn().copy_parameters_to(snapshot);
+
+            const Response response {.original_cost = evaluate(),
+                                     .candidate_count = request.candidate_count};
+
+            costs.resize(request.candidate_count);
+
+            for (std::size_t candidate {0}; candidate < costs.size(); ++candidate) {
+                trainer._encoder.modify_word_vector_encoder_nn(
+                    trainer.make_diff(request.first_seed + candidate, request.scale));
+                costs [candidate] = evaluate();
+                trainer._encoder.restore_word_vector_encoder_nn_parameters(snapshot);
+            }
+
+            send_response(socket, response, costs);
+        }
+
+        ::close(socket);
+    }
+
+    template <typename TrainerT>
+    auto TrainingCoordinator<TrainerT>::sample_pairs(const TrainerT& trainer,
+                                                     std::size_t pair_count, std::uint64_t seed)
+        -> std::vector<typename TrainerT::IdPair> {
+        std::vector<typename TrainerT::IdPair> id_pairs;
+
+        if (pair_count == 0 || !trainer._dataset) {
+            return id_pairs;
+        }
+
+        const auto& dataset = *trainer._dataset.value();
+
+        if (dataset.size() < 2) {
+            throw std::runtime_error("Dataset too small");
+        }
+
+        std::mt19937_64 random_engine(seed);
+        std::uniform_int_distribution<std::size_t> distribution_1(0, dataset.size() - 1);
+        std::uniform_int_distribution<std::size_t> distribution_2(0, dataset.size() - 2);
+
+        for (std::size_t pair {0}; pair < pair_count; ++pair) {
+            const std::size_t index_1 = distribution_1(random_engine);
+            std::size_t index_2 = distribution_2(random_engine);
+
+            // Skip index_1 so the two strings always differ
+            index_2 += static_cast<std::size_t>(index_2 >= index_1);
+
+            id_pairs.emplace_back(index_1, index_2);
+        }
+
+        return id_pairs;
+    }
+
+    template <typename TrainerT>
+    std::optional<std::size_t> TrainingCoordinator<TrainerT>::process_thread_count() {
+        std::error_code error;
+        std::filesystem::directory_iterator tasks("/proc/self/task", error);
+
+        if (error) {
+            return std::nullopt;
+        }
+
+        return static_cast<std::size_t>(
+            std::distance(std::filesystem::begin(tasks), std::filesystem::end(tasks)));
+    }
+
+    template <typename TrainerT>
+    void TrainingCoordinator<TrainerT>::put(std::uint8_t*& bytes, std::uint64_t value,
+                                            std::size_t width) noexcept {
+        for (std::size_t byte {0}; byte < width; ++byte) {
+            *bytes++ = static_cast<std::uint8_t>(value >> (8 * byte));
+        }
+    }
+
+    template <typename TrainerT>
+    std::uint64_t TrainingCoordinator<TrainerT>::take(const std::uint8_t*& bytes,
+                                                      std::size_t width) noexcept {
+        std::uint64_t value {};
+
+        for (std::size_t byte {0}; byte < width; ++byte) {
+            value |= std::uint64_t {*bytes++} << (8 * byte);
+        }
+
+        return value;
+    }
+
+    template <typename TrainerT>
+    auto TrainingCoordinator<TrainerT>::encode_request(const Request& request) noexcept
+        -> RequestBytes {
+        RequestBytes bytes {};
+        std::uint8_t* out = bytes.data();
+
+        put(out, static_cast<std::uint32_t>(request.command), sizeof(std::uint32_t));
+        put(out, request.candidate_count, sizeof(std::uint32_t));
+        put(out, request.batch_pairs, sizeof(std::uint32_t));
+        put(out, request.pairs_follow, sizeof(std::uint32_t));
+        put(out, request.batch_seed, sizeof(std::uint64_t));
+        put(out, request.first_seed, sizeof(std::uint64_t));
+        put(out, std::bit_cast<std::uint32_t>(request.scale), sizeof(float));
+
+        return bytes;
+    }
+
+    template <typename TrainerT>
+    void TrainingCoordinator<TrainerT>::send_request(int socket, const Request& request) {
+        const RequestBytes bytes = encode_request(request);
+
+        send_all(socket, bytes.data(), bytes.size());
+    }
+
+    template <typename TrainerT>
+    auto TrainingCoordinator<TrainerT>::receive_request(int socket) -> Request {
+        RequestBytes bytes {};
+        const std::uint8_t* in = bytes.data();
+        Request request;
+
+        receive_all(socket, bytes.data(), bytes.size());
+
+        const auto command = static_cast<std::uint32_t>(take(in, sizeof(std::uint32_t)));
+
+        if (command > static_cast<std::uint32_t>(Command::shutdown)) {
+            throw std::runtime_error("Unknown training request");
+        }
+
+        request.command = static_cast<Command>(command);
+        request.candidate_count = static_cast<std::uint32_t>(take(in, sizeof(std::uint32_t)));
+        request.batch_pairs = static_cast<std::uint32_t>(take(in, sizeof(std::uint32_t)));
+        request.pairs_follow = static_cast<std::uint32_t>(take(in, sizeof(std::uint32_t)));
+        request.batch_seed = take(in, sizeof(std::uint64_t));
+        request.first_seed = take(in, sizeof(std::uint64_t));
+        request.scale =
+            std::bit_cast<float>(static_cast<std::uint32_t>(take(in, sizeof(float))));
+
+        return request;
+    }
+
+    template <typename TrainerT>
+    void TrainingCoordinator<TrainerT>::send_response(int socket, const Response& response,
+                                                      const std::vector<float>& costs) {
+        std::array<std::uint8_t, RESPONSE_SIZE> bytes {};
+        std::uint8_t* out = bytes.data();
+
+        put(out, std::bit_cast<std::uint32_t>(response.original_cost), sizeof(float));
+        put(out, response.candidate_count, sizeof(std::uint32_t));
+        send_all(socket, bytes.data(), bytes.size());
+        send_values(socket, costs);
+    }
+
+    template <typename TrainerT>
+    auto TrainingCoordinator<TrainerT>::receive_response(int socket, std::uint32_t candidate_count,
+                                                         std::vector<float>& costs) -> Response {
+        std::array<std::uint8_t, RESPONSE_SIZE> bytes {};
+        const std::uint8_t* in = bytes.data();
+        Response response;
+
+        receive_all(socket, bytes.data(), bytes.size());
+        response.original_cost =
+            std::bit_cast<float>(static_cast<std::uint32_t>(take(in, sizeof(float))));
+        response.candidate_count = static_cast<std::uint32_t>(take(in, sizeof(std::uint32_t)));
+
+        if (response.candidate_count != candidate_count) {
+            throw std::runtime_error("Training worker answered for another number of candidates");
+        }
+
+        costs.resize(response.candidate_count);
+        receive_values(socket, costs);
+
+        return response;
+    }
+
+    template <typename TrainerT>
+    template <typename ValueT>
+    void TrainingCoordinator<TrainerT>::send_values(int socket,
+                                                    const std::vector<ValueT>& values) {
+        std::vector<std::uint8_t> bytes(values.size() * sizeof(ValueT));
+        std::uint8_t* out = bytes.data();
+
+        for (const ValueT value: values) {
+            if constexpr (std::is_same_v<ValueT, float>) {
+                put(out, std::bit_cast<std::uint32_t>(value), sizeof(float));
+            }
+            else {
+                put(out, value, sizeof(ValueT));
+            }
+        }
+
+        send_all(socket, bytes.data(), bytes.size());
+    }
+
+    template <typename TrainerT>
+    template <typename ValueT>
+    void TrainingCoordinator<TrainerT>::receive_values(int socket, std::vector<ValueT>& values) {
+        std::vector<std::uint8_t> bytes(values.size() * sizeof(ValueT));
+        const std::uint8_t* in = bytes.data();
+
+        receive_all(socket, bytes.data(), bytes.size());
+
+        for (ValueT& value: values) {
+            if constexpr (std::is_same_v<ValueT, float>) {
+                value = std::bit_cast<float>(static_cast<std::uint32_t>(take(in, sizeof(float))));
+            }
+            else {
+                value = static_cast<ValueT>(take(in, sizeof(ValueT)));
+            }
+        }
+    }
+
+    template <typename TrainerT>
+    void TrainingCoordinator<TrainerT>::send_all(int socket, const void* data, std::size_t size) {
+        const auto* bytes = static_cast<const char*>(data);
+
+        while (size > 0) {
+            const ssize_t sent = ::send(socket, bytes, size, MSG_NOSIGNAL);
+
+            if (sent < 0 && errno == EINTR) {
+                continue;
+            }
+
+            if (sent <= 0) {
+                throw std::runtime_error(std::string("Training worker send failed: ") +
+                                         std::strerror(errno));
+            }
+
+            bytes += sent;
+            size -= static_cast<std::size_t>(sent);
+        }
+    }
+
+    template <typename TrainerT>
+    void TrainingCoordinator<TrainerT>::receive_all(int socket, void* data, std::size_t size) {
+        auto* bytes = static_cast<char*>(data);
+
+        while (size > 0) {
+            const ssize_t received = ::recv(socket, bytes, size, 0);
+
+            if (received < 0 && errno == EINTR) {
+                continue;
+            }
+
+            if (received <= 0) {
+                throw std::runtime_error("Training worker connection closed");
+            }
+
+            bytes += received;
+            size -= static_cast<std::size_t>(received);
+        }
+    }
+} // namespace efuzz
+
+#endif // EFUZZ_DISTRIBUTED_TRAIN_HPP
@@ -0,0 +1,1203 @@
+#ifndef EFUZZ_EFUZZ_HPP
+#define EFUZZ_EFUZZ_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <istream>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <Eigen/Core>
+#include <rapidfuzz/distance/Levenshtein.hpp>
+#include <rapidfuzz/fuzz.hpp>
+
+#include <efuzz/annoy_index.hpp>
+#include <efuzz/embedding_store.hpp>
+#include <efuzz/encode.hpp>
+#include <efuzz/hnsw_index.hpp>
+#include <efuzz/index_build.hpp>
+#include <efuzz/product_quantizer.hpp>
+#include <efuzz/query_cache.hpp>
+#include <efuzz/query_profiler.hpp>
+#include <efuzz/string_pool.hpp>
+#include <efuzz/vector_index.hpp>
+
+namespace efuzz {
+    struct SearchResult {
+        std::size_t id {};
+        double score {}; // rapidfuzz::fuzz::ratio against the query, 0 to 100
+
+        template <typename Archive>
+        void serialize(Archive& archive) {
+            archive(id, score);
+        }
+    };
+
+    // Helpers shared by the search engines (SearchContainer, DeletionIndex, BkTree, QGramIndex),
+    // so they rank and verify results the same way.
+
+    // Better results first: higher score, then lower id.
+    [[nodiscard]] inline bool ranks_before(const SearchResult& lhs, const SearchResult& rhs) {
+        return lhs.score != rhs.score ? lhs.score > rhs.score : lhs.id < rhs.id;
+    }
+
+    // The k best of results, best first.
+    [[nodiscard]] inline std::vector<SearchResult> merge_results(std::vector<SearchResult> results,
+                                                                 std::size_t k) {
+        k = std::min(k, results.size());
+
+        std::partial_sort(results.begin(), results.begin() + static_cast<std::ptrdiff_t>(k),
+                          results.end(), ranks_before);
+        results.resize(k);
+
+        return results;
+    }
+
+    // The candidates within max_edit_distance Levenshtein edits of query, scored with
+    // rapidfuzz::fuzz::ratio. The length difference rules out most others before rapidfuzz
+    // computes the distance, with max_edit_distance as its score cutoff.
+    template <StdString StringT>
+    [[nodiscard]] std::vector<SearchResult>
+        verify_edit_distance(const StringT& query, const StringPool<StringT>& strings,
+                             const std::vector<std::uint32_t>& candidates,
+                             std::size_t max_edit_distance) {
+        using char_type = typename StringT::value_type;
+
+        const rapidfuzz::CachedLevenshtein<char_type> levenshtein(query);
+        const rapidfuzz::fuzz::CachedRatio<char_type> scorer(query);
+        std::vector<SearchResult> results;
+
+        for (const std::uint32_t id: candidates) {
+            const auto entry = strings [id];
+            const std::size_t length_difference = entry.size() > query.size()
+                                                      ? entry.size() - query.size()
+                                                      : query.size() - entry.size();
+
+            if (length_difference > max_edit_distance ||
+                levenshtein.distance(entry, max_edit_distance) > max_edit_distance) {
+                continue;
+            }
+
+            results.push_back(SearchResult {.id = id, .score = scorer.similarity(entry)});
+        }
+
+        return results;
+    }
+
+    // Reads stream line_count lines at a time and calls chunk_function(lines) on each chunk in
+    // order, reading the next chunk on another thread meanwhile, for insert_lines. At most two
+    // chunks are held at once.
+    template <StdString StringT, typename ChunkFunction>
+    void for_each_line_chunk(std::basic_istream<typename StringT::value_type>& stream,
+                             std::size_t line_count, ChunkFunction&& chunk_function) {
+        line_count = std::max<std::size_t>(1, line_count);
+
+        const auto read_chunk = [&stream, line_count]() {
+            std::vector<StringT> lines;
+            StringT line;
+
+            while (lines.size() < line_count && std::getline(stream, line)) {
+                lines.push_back(std::move(line));
+            }
+
+            return lines;
+        };
+
+        for (std::vector<StringT> lines = read_chunk(); !lines.empty();) {
+            // Waits for the read in its destructor if chunk_function throws
+            std::future<std::vector<StringT>> next_lines =
+                std::async(std::launch::async, read_chunk);
+
+            chunk_function(std::as_const(lines));
+            lines = next_lines.get();
+        }
+    }
+
+    // search(query) for every query, spread over thread_count threads, for the search_batch of
+    // engines that search one query at a time.
+    template <typename StringT, typename SearchT>
+    [[nodiscard]] std::vector<std::vector<SearchResult>>
+        search_each(const std::vector<StringT>& queries, std::size_t thread_count,
+                    const SearchT& search) {
+        std::vector<std::vector<SearchResult>> results(queries.size());
+
+        parallel_for_chunks(queries.size(), 1, std::max<std::size_t>(1, thread_count),
+                            [&](std::size_t begin, std::size_t end) {
+                                for (std::size_t index {begin}; index < end; ++index) {
+                                    results [index] = search(queries [index]);
+                                }
+                            });
+
+        return results;
+    }
+
+    // Dictionary of strings searched in two stages: a vector index over the embeddings of
+    // EncoderPolicy_ (Encoder or NGramEncoder) picks the nearest candidates, then rapidfuzz
+    // reranks those candidates against the query.
+    template <StdString StringT_,
+              IntegralConstant encoding_result_size_ = std::integral_constant<int, -1>,
+              template <typename, typename> class EncoderPolicy_ = Encoder>
+    class SearchContainer {
+        public:
+
+        using StringT = StringT_;
+        using EncoderT = EncoderPolicy_<StringT, encoding_result_size_>;
+        using string_view_type = typename StringPool<StringT>::string_view_type;
+        using encoding_result_type = typename EncoderT::encoding_result_type;
+        using this_type = SearchContainer<StringT, encoding_result_size_, EncoderPolicy_>;
+        using QueryNormalizer = std::function<StringT(const StringT&)>;
+
+        struct CachedQuery {
+            encoding_result_type encoding;
+            std::vector<SearchResult> results;
+            std::size_t result_count {}; // The k `results` were computed for
+        };
+
+        using QueryCacheT = QueryCache<StringT, CachedQuery>;
+
+        constexpr static std::size_t DEFAULT_CANDIDATE_COUNT {32};
+        constexpr static std::size_t DEFAULT_QUANTIZER_SAMPLE_SIZE {16384};
+        constexpr static std::size_t DEFAULT_LAZY_CANDIDATE_COUNT {8};
+
+        // Results of search_lazily(), produced on demand. Starts from a small candidate set and
+        // doubles it whenever half of it has been consumed, so a caller reading one or two
+        // results only pays for a handful of candidates. Results come in score order within the
+        // candidates seen so far; a candidate found by a later widening may outscore one that
+        // was already returned. The container must outlive it and stay unmodified.
+        class LazySearch {
+            public:
+
+            class iterator {
+                public:
+
+                using iterator_concept = std::input_iterator_tag;
+                using value_type = SearchResult;
+                using difference_type = std::ptrdiff_t;
+
+                iterator() = default;
+                explicit iterator(LazySearch* lazy_search);
+
+                const SearchResult& operator*() const;
+                const SearchResult* operator->() const;
+                iterator& operator++();
+                void operator++(int);
+
+                friend bool operator==(const iterator& iterator, std::default_sentinel_t) {
+                    return iterator._lazy_search == nullptr;
+                }
+
+                private:
+
+                LazySearch* _lazy_search {};
+                SearchResult _current;
+            };
+
+            // The next best result, or nothing once every entry has been returned.
+            [[nodiscard]] std::optional<SearchResult> next();
+
+            [[nodiscard]] iterator begin();
+            [[nodiscard]] std::default_sentinel_t end() const;
+
+            // Candidates taken from the vector index so far.
+            [[nodiscard]] std::size_t get_candidate_count() const;
+
+            private:
+
+            friend class SearchContainer;
+
+            LazySearch(const this_type& container, const StringT& query,
+                       std::size_t initial_candidate_count);
+
+            void widen();
+
+            const this_type* _container;
+            rapidfuzz::fuzz::CachedRatio<typename StringT::value_type> _scorer;
+            encoding_result_type _encoding;
+            std::vector<SearchResult> _pending; // Heap, best result on top
+            std::unordered_set<std::size_t> _seen;
+            std::size_t _initial_candidate_count {};
+            std::size_t _candidate_count {};
+            std::size_t _returned_count {};
+        };
+
+        SearchContainer() = default;
+        explicit SearchContainer(EncoderT encoder);
+
+        // Re-encodes every entry with the new encoder.
+        this_type& set_encoder(EncoderT encoder);
+        this_type& insert(const StringT& string);
+        // Encodes and indexes in parallel, as configured by set_index_build_options().
+        this_type& insert(const std::vector<StringT>& strings);
+        // Inserts every line of `stream`, like insert(const std::vector<StringT>&), reading it in
+        // batches of one chunk per thread while the previous batch is encoded and indexed.
+        // Progress totals grow as lines are read.
+        this_type& insert_lines(std::basic_istream<typename StringT::value_type>& stream);
+        // Drops every entry from id `size` on, so ids handed out before stay valid. The flat
+        // vector index drops their embeddings; other backends are rebuilt from the rest (see
+        // needs_vector_index_rebuild()).
+        this_type& truncate(std::size_t size);
+        // Threads, chunk size and progress callback used whenever many strings are encoded at
+        // once: batch inserts, set_encoder() and index rebuilds.
+        this_type& set_index_build_options(IndexBuildOptions index_build_options);
+        // Candidates taken from the embedding stage for reranking (at least k).
+        this_type& set_candidate_count(std::size_t candidate_count);
+        // Applied to every query before it is searched or used as a cache key.
+        this_type& set_query_normalizer(QueryNormalizer query_normalizer);
+        // Compresses the embeddings of the flat vector index; reranking still uses the exact
+        // strings. Product quantization trains its codebooks on a random sample of the
+        // current entries (so the container must not be empty) and uses half the dimension as
+        // subspace count unless one is given. The HNSW and Annoy backends keep float32
+        // embeddings, so compressed storage with them throws std::invalid_argument.
+        this_type& set_embedding_storage(
+            EmbeddingStorage embedding_storage, std::size_t subspace_count = 0,
+            std::size_t quantizer_sample_size = DEFAULT_QUANTIZER_SAMPLE_SIZE);
+        // Rebuilds the candidate index with another backend. The flat index is exact; HNSW and
+        // Annoy are approximate, use the parameters set below, and throw std::invalid_argument
+        // while compressed embedding storage is set.
+        this_type& set_vector_index(VectorIndexType vector_index_type);
+        // Changing only ef_search keeps the current graph.
+        this_type& set_hnsw_parameters(HnswParameters hnsw_parameters);
+        this_type& set_annoy_parameters(AnnoyParameters annoy_parameters);
+        this_type& enable_query_cache(std::size_t capacity,
+                                      std::size_t shard_count = QueryCacheT::DEFAULT_SHARD_COUNT);
+        this_type& disable_query_cache();
+        // Records per-stage search latency, and a trace of every trace_interval-th query if
+        // trace_interval is not zero. Compiled out by EFUZZ_DISABLE_QUERY_PROFILING.
+        this_type& enable_query_profiling(
+            std::size_t trace_interval = 0,
+            std::size_t trace_capacity = QueryProfiler::DEFAULT_TRACE_CAPACITY);
+        this_type& disable_query_profiling();
+
+        // Safe to call from several threads at once, as long as nothing modifies the container.
+        [[nodiscard]] std::vector<SearchResult> search(const StringT& query, std::size_t k) const;
+        // Searches every query for its k best results. Queries missing from the query cache are
+        // encoded together (Encoder::encode_batch), then their candidate lookups and reranking
+        // are spread over thread_count threads. Not recorded by the query profiler.
+        [[nodiscard]] std::vector<std::vector<SearchResult>>
+            search_batch(const std::vector<StringT>& queries, std::size_t k,
+                         std::size_t thread_count = 1) const;
+        // Searches queries [i] for its ks [i] best results, each exactly as search() would.
+        [[nodiscard]] std::vector<std::vector<SearchResult>>
+            search_batch(const std::vector<StringT>& queries, const std::vector<std::size_t>& ks,
+                         std::size_t thread_count = 1) const;
+        // Lazily widening search, for callers that do not know how many results they need.
+        [[nodiscard]] LazySearch
+            search_lazily(const StringT& query,
+                          std::size_t initial_candidate_count = DEFAULT_LAZY_CANDIDATE_COUNT) const;
+
+        // Valid until the next insert.
+        [[nodiscard]] string_view_type get(std::size_t id) const;
+        [[nodiscard]] std::size_t size() const;
+        [[nodiscard]] const EncoderT& get_encoder() const;
+        [[nodiscard]] VectorIndexType get_vector_index_type() const;
+        // A failed insert or truncate that could not restore the vector index drops it instead;
+        // searches then find no candidates until the next insert rebuilds it from every entry.
+        [[nodiscard]] bool needs_vector_index_rebuild() const;
+        // Throws unless the flat vector index is in use and the container is not empty.
+        [[nodiscard]] const EmbeddingStore& get_embedding_store() const;
+        // Changes whenever the encoder or the dictionary does; cached queries from an older
+        // snapshot are never served.
+        [[nodiscard]] std::uint64_t get_snapshot() const;
+        [[nodiscard]] std::optional<QueryCacheStats> get_query_cache_stats() const;
+        // The encode stage includes query normalization and the cache lookup.
+        [[nodiscard]] std::optional<QueryLatencySnapshot> get_query_latency() const;
+        [[nodiscard]] std::vector<QueryTrace> get_query_traces() const;
+
+        private:
+
+        // Everything search() does once the normalized query is encoded, cache insertion included.
+        [[nodiscard]] std::vector<SearchResult> search_encoded(const StringT& normalized_query,
+                                                               const encoding_result_type& encoding,
+                                                               std::size_t k,
+                                                               QueryTimer& timer) const;
+        [[nodiscard]] std::vector<std::size_t>
+            nearest_candidates(const encoding_result_type& encoding, std::size_t count) const;
+        [[nodiscard]] std::vector<SearchResult>
+            rerank(const StringT& query, const std::vector<std::size_t>& candidates) const;
+        // Embeddings of the entries from first_id on, one column each. Progress reports count
+        // progress_offset earlier entries as done.
+        [[nodiscard]] Eigen::MatrixXf encode_all(std::size_t first_id,
+                                                 std::size_t progress_offset = 0) const;
+        [[nodiscard]] std::shared_ptr<VectorIndex>
+            make_vector_index(const Eigen::MatrixXf& embeddings) const;
+        // Indexes the entries from first_id on, or every entry if the vector index needs a
+        // rebuild.
+        void append_encodings(std::size_t first_id, std::size_t progress_offset = 0);
+        void rebuild_vector_index();
+        // Drops what was indexed from id `size` on, after the entries themselves are gone.
+        // Never throws, so a failed insert always rethrows its own exception: the flat index
+        // drops its tail, others are rebuilt, and a failed rebuild leaves the index marked as
+        // needing one.
+        void restore_vector_index(std::size_t size) noexcept;
+        // Unique across containers, so copies sharing a query cache never mix their entries.
+        static std::uint64_t next_snapshot();
+
+        EncoderT _encoder;
+        StringPool<StringT> _strings; // Ids are positions, so it never deduplicates
+        // Shared between copies until one of them inserts, which clones it first.
+        std::shared_ptr<VectorIndex> _vector_index;
+        bool _vector_index_stale {}; // Dropped; append_encodings() rebuilds it from every entry
+        VectorIndexType _vector_index_type {VectorIndexType::flat};
+        HnswParameters _hnsw_parameters;
+        AnnoyParameters _annoy_parameters;
+        EmbeddingStorage _embedding_storage {EmbeddingStorage::float32};
+        std::size_t _quantizer_subspace_count {};
+        std::size_t _quantizer_sample_size {DEFAULT_QUANTIZER_SAMPLE_SIZE};
+        std::size_t _candidate_count {DEFAULT_CANDIDATE_COUNT};
+        IndexBuildOptions _index_build_options;
+        std::uint64_t _snapshot {next_snapshot()};
+        QueryNormalizer _query_normalizer;
+        std::shared_ptr<QueryCacheT> _query_cache;
+        std::shared_ptr<QueryProfiler> _query_profiler;
+    };
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    SearchContainer<StringT_, encoding_result_size_, EncoderPolicy_>::SearchContainer(
+        EncoderT encoder) :
+        _encoder(std::move(encoder)) {
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    auto SearchContainer<StringT_, encoding_result_size_, EncoderPolicy_>::set_encoder(
+        EncoderT encoder) -> this_type& {
+        _encoder = std::move(encoder);
+        rebuild_vector_index();
+        _snapshot = next_snapshot();
+
+        return *this;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    auto SearchContainer<StringT_, encoding_result_size_, EncoderPolicy_>::insert(
+        const StringT& string) -> this_type& {
+        const std::size_t first_id = _strings.size();
+
+        _strings.add(string);
+
+        // Nothing is inserted when encoding or indexing fails
+        try {
+            append_encodings(first_id);
+        }
+        catch (...) {
+            // The vector index may already hold the chunks before the failing one
+            _strings.truncate(first_id);
+            restore_vector_index(first_id);
+            throw;
+        }
+
+        _snapshot = next_snapshot();
+
+        return *this;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    auto SearchContainer<StringT_, encoding_result_size_, EncoderPolicy_>::insert(
+        const std::vector<StringT>& strings) -> this_type& {
+        const std::size_t first_id = _strings.size();
+
+        _strings.add_all(strings);
+
+        // Nothing is inserted when encoding or indexing fails
+        try {
+            append_encodings(first_id);
+        }
+        catch (...) {
+            // The vector index may already hold the chunks before the failing one
+            _strings.truncate(first_id);
+            restore_vector_index(first_id);
+            throw;
+        }
+
+        _snapshot = next_snapshot();
+
+        return *this;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    auto SearchContainer<StringT_, encoding_result_size_, EncoderPolicy_>::insert_lines(
+        std::basic_istream<typename StringT::value_type>& stream) -> this_type& {
+        const std::size_t first_id = _strings.size();
+        // One chunk per thread, so every worker has one to encode
+        const std::size_t line_count = _index_build_options.resolved_chunk_size() *
+                                       _index_build_options.resolved_thread_count();
+
+        // Nothing is inserted when reading or encoding fails
+        try {
+            for_each_line_chunk<StringT>(
+                stream, line_count, [this, first_id](const std::vector<StringT>& lines) {
+                    const std::size_t batch_first_id = _strings.size();
+
+                    _strings.add_all(lines);
+                    append_encodings(batch_first_id, batch_first_id - first_id);
+                });
+        }
+        catch (...) {
+            // The vector index already holds the batches before the failing one
+            _strings.truncate(first_id);
+            restore_vector_index(first_id);
+            throw;
+        }
+
+        _snapshot = next_snapshot();
+
+        return *this;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    auto SearchContainer<StringT_, encoding_result_size_, EncoderPolicy_>::truncate(
+        std::size_t size) -> this_type& {
+        if (size >= _strings.size()) {
+            return *this;
+        }
+
+        _strings.truncate(size);
+        restore_vector_index(size);
+        _snapshot = next_snapshot();
+
+        return *this;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    auto SearchContainer<StringT_, encoding_result_size_, EncoderPolicy_>::set_index_build_options(
+        IndexBuildOptions index_build_options) -> this_type& {
+        _index_build_options = std::move(index_build_options);
+
+        return *this;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    auto SearchContainer<StringT_, encoding_result_size_, EncoderPolicy_>::set_candidate_count(
+        std::size_t candidate_count) -> this_type& {
+        _candidate_count = candidate_count;
+        _snapshot = next_snapshot();
+
+        return *this;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    auto SearchContainer<StringT_, encoding_result_size_, EncoderPolicy_>::set_query_normalizer(
+        QueryNormalizer query_normalizer) -> this_type& {
+        _query_normalizer = std::move(query_normalizer);
+        _snapshot = next_snapshot();
+
+        return *this;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    auto SearchContainer<StringT_, encoding_result_size_, EncoderPolicy_>::set_embedding_storage(
+        EmbeddingStorage embedding_storage, std::size_t subspace_count,
+        std::size_t quantizer_sample_size) -> this_type& {
+        if (embedding_storage != EmbeddingStorage::float32 &&
+            _vector_index_type != VectorIndexType::flat) {
+            throw std::invalid_argument("Compressed embedding storage needs the flat vector index");
+        }
+
+        if (embedding_storage == EmbeddingStorage::product_quantized && _strings.empty()) {
+            throw std::runtime_error(
+                "Product quantized storage needs entries to train on; insert strings first");
+        }
+
+        _embedding_storage = embedding_storage;
+        _quantizer_subspace_count = subspace_count;
+        _quantizer_sample_size = quantizer_sample_size;
+        rebuild_vector_index();
+        _snapshot = next_snapshot();
+
+        return *this;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    auto SearchContainer<StringT_, encoding_result_size_, EncoderPolicy_>::set_vector_index(
+        VectorIndexType vector_index_type) -> this_type& {
+        if (vector_index_type != VectorIndexType::flat &&
+            _embedding_storage != EmbeddingStorage::float32) {
+            throw std::invalid_argument("Compressed embedding storage needs the flat vector index");
+        }
+
+        _vector_index_type = vector_index_type;
+        rebuild_vector_index();
+        _snapshot = next_snapshot();
+
+        return *this;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    auto SearchContainer<StringT_, encoding_result_size_, EncoderPolicy_>::set_hnsw_parameters(
+        HnswParameters hnsw_parameters) -> this_type& {
+        const bool rebuild = hnsw_parameters.m != _hnsw_parameters.m ||
+                             hnsw_parameters.ef_construction != _hnsw_parameters.ef_construction ||
+                             hnsw_parameters.seed != _hnsw_parameters.seed;
+
+        _hnsw_parameters = hnsw_parameters;
+
+        if (_vector_index_type != VectorIndexType::hnsw || !_vector_index) {
+            return *this;
+        }
+
+        if (rebuild) {
+            rebuild_vector_index();
+        }
+        else {
+            auto hnsw_index = _vector_index->clone();
+
+            static_cast<HnswVectorIndex&>(*hnsw_index).set_ef_search(hnsw_parameters.ef_search);
+            _vector_index = std::move(hnsw_index);
+        }
+
+        _snapshot = next_snapshot();
+
+        return *this;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    auto SearchContainer<StringT_, encoding_result_size_, EncoderPolicy_>::set_annoy_parameters(
+        AnnoyParameters annoy_parameters) -> this_type& {
+        _annoy_parameters = annoy_parameters;
+
+        if (_vector_index_type == VectorIndexType::annoy) {
+            rebuild_vector_index();
+            _snapshot = next_snapshot();
+        }
+
+        return *this;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    auto SearchContainer<StringT_, encoding_result_size_, EncoderPolicy_>::enable_query_cache(
+        std::size_t capacity, std::size_t shard_count) -> this_type& {
+        _query_cache = std::make_shared<QueryCacheT>(capacity, shard_count);
+
+        return *this;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    auto SearchContainer<StringT_, encoding_result_size_, EncoderPolicy_>::disable_query_cache()
+        -> this_type& {
+        _query_cache.reset();
+
+        return *this;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    auto SearchContainer<StringT_, encoding_result_size_, EncoderPolicy_>::enable_query_profiling(
+        std::size_t trace_interval, std::size_t trace_capacity) -> this_type& {
+        _query_profiler = std::make_shared<QueryProfiler>(trace_interval, trace_capacity);
+
+        return *this;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    auto SearchContainer<StringT_, encoding_result_size_, EncoderPolicy_>::disable_query_profiling()
+        -> this_type& {
+        _query_profiler.reset();
+
+        return *this;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    std::vector<SearchResult>
+        SearchContainer<StringT_, encoding_result_size_, EncoderPolicy_>::search(
+            const StringT& query, std::size_t k) const {
+        QueryTimer timer(_query_profiler.get());
+        const StringT normalized_query = _query_normalizer ? _query_normalizer(query) : query;
+        std::optional<CachedQuery> cached_query;
+
+        if (_query_cache) {
+            cached_query = _query_cache->find(normalized_query, _snapshot);
+
+            if (cached_query.has_value() && cached_query->result_count >= k) {
+                auto& results = cached_query->results;
+
+                results.resize(std::min(results.size(), k));
+                timer.set_cache_hit();
+                timer.set_result_count(results.size());
+                timer.finish();
+
+                return results;
+            }
+        }
+
+        // A cached entry for a smaller k still saves the encode
+        const encoding_result_type encoding = cached_query.has_value()
+                                                  ? cached_query->encoding
+                                                  : _encoder.encode(normalized_query);
+
+        timer.mark(QueryStage::encode);
+
+        const std::vector<SearchResult> results =
+            search_encoded(normalized_query, encoding, k, timer);
+
+        timer.set_result_count(results.size());
+        timer.finish();
+
+        return results;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    std::vector<std::vector<SearchResult>>
+        SearchContainer<StringT_, encoding_result_size_, EncoderPolicy_>::search_batch(
+            const std::vector<StringT>& queries, std::size_t k, std::size_t thread_count) const {
+        return search_batch(queries, std::vector<std::size_t>(queries.size(), k), thread_count);
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    std::vector<std::vector<SearchResult>>
+        SearchContainer<StringT_, encoding_result_size_, EncoderPolicy_>::search_batch(
+            const std::vector<StringT>& queries, const std::vector<std::size_t>& ks,
+            std::size_t thread_count) const {
+        if (ks.size() != queries.size()) {
+            throw std::runtime_error("Batch search needs one result count per query");
+        }
+
+        std::vector<StringT> normalized_queries;
+        std::vector<std::optional<CachedQuery>> cached_queries(queries.size());
+        std::vector<std::vector<SearchResult>> results(queries.size());
+        // Queries still to search, and the column of encode_batch's result for those not cached
+        std::vector<std::size_t> pending;
+        std::vector<Eigen::Index> encoding_columns(queries.size(), -1);
+        std::vector<StringT> queries_to_encode;
+
+        normalized_queries.reserve(queries.size());
+
+        for (std::size_t index {0}; index < queries.size(); ++index) {
+            normalized_queries.push_back(_query_normalizer ? _query_normalizer(queries [index])
+                                                           : queries [index]);
+
+            auto& cached_query = cached_queries [index];
+
+            if (_query_cache) {
+                cached_query = _query_cache->find(normalized_queries.back(), _snapshot);
+
+                if (cached_query.has_value() && cached_query->result_count >= ks [index]) {
+                    results [index] = std::move(cached_query->results);
+                    results [index].resize(std::min(results [index].size(), ks [index]));
+
+                    continue;
+                }
+            }
+
+            if (!cached_query.has_value()) {
+                encoding_columns [index] = static_cast<Eigen::Index>(queries_to_encode.size());
+                queries_to_encode.push_back(normalized_queries.back());
+            }
+
+            pending.push_back(index);
+        }
+
+        const Eigen::MatrixXf encodings = queries_to_encode.empty()
+                                              ? Eigen::MatrixXf()
+                                              : _encoder.encode_batch(queries_to_encode);
+
+        parallel_for_chunks(
+            pending.size(), 1, std::max<std::size_t>(1, thread_count),
+            [&](std::size_t begin, std::size_t end) {
+                for (std::size_t position {begin}; position < end; ++position) {
+                    const std::size_t index = pending [position];
+                    const encoding_result_type encoding =
+                        encoding_columns [index] < 0
+                            ? cached_queries [index]->encoding
+                            : encoding_result_type(encodings.col(encoding_columns [index]));
+                    QueryTimer timer(nullptr);
+
+                    results [index] =
+                        search_encoded(normalized_queries [index], encoding, ks [index], timer);
+                }
+            });
+
+        return results;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    auto SearchContainer<StringT_, encoding_result_size_, EncoderPolicy_>::search_lazily(
+        const StringT& query, std::size_t initial_candidate_count) const -> LazySearch {
+        return LazySearch(*this, _query_normalizer ? _query_normalizer(query) : query,
+                          initial_candidate_count);
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    SearchContainer<StringT_, encoding_result_size_, EncoderPolicy_>::LazySearch::LazySearch(
+        const this_type& container, const StringT& query, std::size_t initial_candidate_count) :
+        _container(&container),
+        _scorer(query), _encoding(container._encoder.encode(query)),
+        _initial_candidate_count(std::max<std::size_t>(1, initial_candidate_count)) {
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    std::optional<SearchResult>
+        SearchContainer<StringT_, encoding_result_size_, EncoderPolicy_>::LazySearch::next() {
+        // Keep at least half of the candidates in reserve, so the next result is rarely beaten by
+        // one a later widening would find
+        while ((_pending.empty() || 2 * _returned_count >= _candidate_count) &&
+               _candidate_count < _container->size()) {
+            widen();
+        }
+
+        if (_pending.empty()) {
+            return std::nullopt;
+        }
+
+        // std heaps keep the maximum on top, so the comparison is reversed
+        const auto ranks_after = [](const SearchResult& lhs, const SearchResult& rhs) {
+            return ranks_before(rhs, lhs);
+        };
+
+        std::pop_heap(_pending.begin(), _pending.end(), ranks_after);
+
+        const SearchResult result = _pending.back();
+
+        _pending.pop_back();
+        _returned_count++;
+
+        return result;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    auto SearchContainer<StringT_, encoding_result_size_, EncoderPolicy_>::LazySearch::begin()
+        -> iterator {
+        return iterator(this);
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    std::default_sentinel_t
+        SearchContainer<StringT_, encoding_result_size_, EncoderPolicy_>::LazySearch::end() const {
+        return {};
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    std::size_t
+        SearchContainer<StringT_, encoding_result_size_,
+                        EncoderPolicy_>::LazySearch::get_candidate_count() const {
+        return _candidate_count;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    void SearchContainer<StringT_, encoding_result_size_, EncoderPolicy_>::LazySearch::widen() {
+        _candidate_count = std::min(
+            _container->size(),
+            _candidate_count == 0 ? _initial_candidate_count : 2 * _candidate_count);
+
+        const auto ranks_after = [](const SearchResult& lhs, const SearchResult& rhs) {
+            return ranks_before(rhs, lhs);
+        };
+
+        // Approximate indexes need not return a superset of the previous candidates, so already
+        // scored ids are skipped rather than assumed to be a prefix
+        for (const std::size_t id: _container->nearest_candidates(_encoding, _candidate_count)) {
+            if (!_seen.insert(id).second) {
+                continue;
+            }
+
+            _pending.push_back(
+                SearchResult {.id = id, .score = _scorer.similarity(_container->_strings [id])});
+            std::push_heap(_pending.begin(), _pending.end(), ranks_after);
+        }
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    SearchContainer<StringT_, encoding_result_size_,
+                    EncoderPolicy_>::LazySearch::iterator::iterator(LazySearch* lazy_search) :
+        _lazy_search(lazy_search) {
+        ++*this;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    const SearchResult&
+        SearchContainer<StringT_, encoding_result_size_,
+                        EncoderPolicy_>::LazySearch::iterator::operator*() const {
+        return _current;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    const SearchResult*
+        SearchContainer<StringT_, encoding_result_size_,
+                        EncoderPolicy_>::LazySearch::iterator::operator->() const {
+        return &_current;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    auto SearchContainer<StringT_, encoding_result_size_,
+                         EncoderPolicy_>::LazySearch::iterator::operator++() -> iterator& {
+        const std::optional<SearchResult> result = _lazy_search->next();
+
+        if (result.has_value()) {
+            _current = result.value();
+        }
+        else {
+            _lazy_search = nullptr;
+        }
+
+        return *this;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    void SearchContainer<StringT_, encoding_result_size_,
+                         EncoderPolicy_>::LazySearch::iterator::operator++(int) {
+        ++*this;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    auto SearchContainer<StringT_, encoding_result_size_, EncoderPolicy_>::get(std::size_t id) const
+        -> string_view_type {
+        return _strings.at(id);
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    std::size_t SearchContainer<StringT_, encoding_result_size_, EncoderPolicy_>::size() const {
+        return _strings.size();
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    auto SearchContainer<StringT_, encoding_result_size_, EncoderPolicy_>::get_encoder() const
+        -> const EncoderT& {
+        return _encoder;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    VectorIndexType
+        SearchContainer<StringT_, encoding_result_size_,
+                        EncoderPolicy_>::get_vector_index_type() const {
+        return _vector_index_type;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    bool SearchContainer<StringT_, encoding_result_size_,
+                         EncoderPolicy_>::needs_vector_index_rebuild() const {
+        return _vector_index_stale;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    const EmbeddingStore&
+        SearchContainer<StringT_, encoding_result_size_,
+                        EncoderPolicy_>::get_embedding_store() const {
+        const auto* flat_index = dynamic_cast<const FlatVectorIndex*>(_vector_index.get());
+
+        if (flat_index == nullptr) {
+            throw std::runtime_error("Embeddings are only stored by a flat vector index");
+        }
+
+        return flat_index->get_embedding_store();
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    std::uint64_t
+        SearchContainer<StringT_, encoding_result_size_, EncoderPolicy_>::get_snapshot() const {
+        return _snapshot;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    std::optional<QueryCacheStats>
+        SearchContainer<StringT_, encoding_result_size_,
+                        EncoderPolicy_>::get_query_cache_stats() const {
+        if (!_query_cache) {
+            return std::nullopt;
+        }
+
+        return _query_cache->get_stats();
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    std::optional<QueryLatencySnapshot>
+        SearchContainer<StringT_, encoding_result_size_,
+                        EncoderPolicy_>::get_query_latency() const {
+        if (!_query_profiler) {
+            return std::nullopt;
+        }
+
+        return _query_profiler->snapshot();
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    std::vector<QueryTrace>
+        SearchContainer<StringT_, encoding_result_size_, EncoderPolicy_>::get_query_traces() const {
+        if (!_query_profiler) {
+            return {};
+        }
+
+        return _query_profiler->get_traces();
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    std::vector<SearchResult>
+        SearchContainer<StringT_, encoding_result_size_, EncoderPolicy_>::search_encoded(
+            const StringT& normalized_query, const encoding_result_type& encoding, std::size_t k,
+            QueryTimer& timer) const {
+        const std::vector<std::size_t> candidates =
+            nearest_candidates(encoding, std::max(_candidate_count, k));
+
+        timer.mark(QueryStage::vector_lookup);
+        timer.set_candidate_count(candidates.size());
+
+        std::vector<SearchResult> scored_candidates = rerank(normalized_query, candidates);
+
+        timer.mark(QueryStage::rerank);
+
+        std::vector<SearchResult> results = merge_results(std::move(scored_candidates), k);
+
+        if (_query_cache) {
+            _query_cache->insert(normalized_query,
+                                 CachedQuery {
+                                     .encoding = encoding, .results = results, .result_count = k},
+                                 _snapshot);
+        }
+
+        timer.mark(QueryStage::merge);
+
+        return results;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    std::vector<std::size_t>
+        SearchContainer<StringT_, encoding_result_size_, EncoderPolicy_>::nearest_candidates(
+            const encoding_result_type& encoding, std::size_t count) const {
+        if (!_vector_index) {
+            return {};
+        }
+
+        return _vector_index->nearest(encoding.data(), count);
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    std::vector<SearchResult>
+        SearchContainer<StringT_, encoding_result_size_, EncoderPolicy_>::rerank(
+            const StringT& query, const std::vector<std::size_t>& candidates) const {
+        const rapidfuzz::fuzz::CachedRatio<typename StringT::value_type> scorer(query);
+        std::vector<SearchResult> results;
+
+        results.reserve(candidates.size());
+
+        for (const std::size_t id: candidates) {
+            results.push_back(SearchResult {.id = id, .score = scorer.similarity(_strings [id])});
+        }
+
+        return results;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    Eigen::MatrixXf SearchContainer<StringT_, encoding_result_size_, EncoderPolicy_>::encode_all(
+        std::size_t first_id, std::size_t progress_offset) const {
+        if (first_id >= _strings.size()) {
+            return {};
+        }
+
+        IndexBuildOptions options = _index_build_options;
+
+        if (options.progress && progress_offset > 0) {
+            options.progress = [this, progress_offset](const IndexBuildProgress& progress) {
+                _index_build_options.progress({.stage = progress.stage,
+                                               .completed = progress_offset + progress.completed,
+                                               .total = progress_offset + progress.total});
+            };
+        }
+
+        const std::size_t count = _strings.size() - first_id;
+        // The first encoding gives the dimension of the preallocated matrix the workers fill
+        const encoding_result_type first_encoding = _encoder.encode(_strings [first_id]);
+        Eigen::MatrixXf embeddings(first_encoding.size(), static_cast<Eigen::Index>(count));
+
+        embeddings.col(0) = first_encoding;
+
+        for_each_chunk(count, options, IndexBuildProgress::Stage::encode,
+                       [this, first_id, &embeddings](std::size_t begin, std::size_t end) {
+                           for (std::size_t index = std::max<std::size_t>(begin, 1); index < end;
+                                ++index) {
+                               embeddings.col(static_cast<Eigen::Index>(index)) =
+                                   _encoder.encode(_strings [first_id + index]);
+                           }
+                       });
+
+        return embeddings;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    std::shared_ptr<VectorIndex>
+        SearchContainer<StringT_, encoding_result_size_, EncoderPolicy_>::make_vector_index(
+            const Eigen::MatrixXf& embeddings) const {
+        const auto dimension = static_cast<std::size_t>(embeddings.rows());
+
+        switch (_vector_index_type) {
+            // Both only ever hold float32 embeddings; see set_embedding_storage()
+            case VectorIndexType::flat: break;
+            case VectorIndexType::hnsw:
+                return std::make_shared<HnswVectorIndex>(dimension, _hnsw_parameters);
+            case VectorIndexType::annoy:
+                return std::make_shared<AnnoyVectorIndex>(dimension, _annoy_parameters);
+        }
+
+        if (_embedding_storage != EmbeddingStorage::product_quantized) {
+            return std::make_shared<FlatVectorIndex>(EmbeddingStore(dimension, _embedding_storage));
+        }
+
+        std::vector<Eigen::Index> sample_ids(static_cast<std::size_t>(embeddings.cols()));
+        std::iota(sample_ids.begin(), sample_ids.end(), 0);
+        std::shuffle(sample_ids.begin(), sample_ids.end(), std::mt19937_64 {});
+        sample_ids.resize(std::min(sample_ids.size(), _quantizer_sample_size));
+
+        ProductQuantizer product_quantizer(
+            dimension, _quantizer_subspace_count > 0 ? _quantizer_subspace_count
+                                                     : std::max<std::size_t>(1, dimension / 2));
+
+        product_quantizer.train(embeddings(Eigen::all, sample_ids));
+
+        return std::make_shared<FlatVectorIndex>(
+            EmbeddingStore(dimension, std::move(product_quantizer)));
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    void SearchContainer<StringT_, encoding_result_size_, EncoderPolicy_>::append_encodings(
+        std::size_t first_id, std::size_t progress_offset) {
+        if (_vector_index_stale) {
+            _vector_index.reset();
+            first_id = 0;
+            progress_offset = 0;
+        }
+
+        if (first_id >= _strings.size()) {
+            _vector_index_stale = false;
+
+            return;
+        }
+
+        const Eigen::MatrixXf embeddings = encode_all(first_id, progress_offset);
+        const std::size_t count = _strings.size() - first_id;
+
+        if (!_vector_index) {
+            _vector_index = make_vector_index(embeddings);
+        }
+        else if (_vector_index.use_count() > 1) {
+            _vector_index = _vector_index->clone();
+        }
+
+        const auto dimension = static_cast<std::size_t>(embeddings.rows());
+        // Annoy rebuilds its forest on every batch, so it gets a single one
+        const std::size_t chunk_size = _vector_index->get_type() == VectorIndexType::annoy
+                                           ? count
+                                           : _index_build_options.resolved_chunk_size();
+
+        for (std::size_t begin {0}; begin < count; begin += chunk_size) {
+            const std::size_t chunk_count = std::min(chunk_size, count - begin);
+
+            _vector_index->add_batch(embeddings.data() + (begin * dimension), chunk_count);
+
+            if (_index_build_options.progress) {
+                _index_build_options.progress({.stage = IndexBuildProgress::Stage::index,
+                                               .completed = progress_offset + begin + chunk_count,
+                                               .total = progress_offset + count});
+            }
+        }
+
+        _vector_index_stale = false;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    void SearchContainer<StringT_, encoding_result_size_, EncoderPolicy_>::rebuild_vector_index() {
+        _vector_index_stale = true;
+        append_encodings(0);
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    void SearchContainer<StringT_, encoding_result_size_, EncoderPolicy_>::restore_vector_index(
+        std::size_t size) noexcept {
+        if (_vector_index_stale) {
+            // A rebuild was cut short; whatever it indexed is dropped, not searched
+            _vector_index.reset();
+
+            return;
+        }
+
+        if (!_vector_index || _vector_index->size() <= size) {
+            return;
+        }
+
+        if (size == 0) {
+            _vector_index.reset();
+
+            return;
+        }
+
+        try {
+            if (_vector_index.use_count() > 1) {
+                _vector_index = _vector_index->clone();
+            }
+
+            if (!_vector_index->truncate(size)) {
+                rebuild_vector_index();
+            }
+        }
+        catch (...) {
+            _vector_index.reset();
+            _vector_index_stale = true;
+        }
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    std::uint64_t
+        SearchContainer<StringT_, encoding_result_size_, EncoderPolicy_>::next_snapshot() {
+        static std::atomic<std::uint64_t> snapshot_counter {};
+
+        return ++snapshot_counter;
+    }
+} // namespace efuzz
+
+#endif // EFUZZ_EFUZZ_HPP
@@ -0,0 +1,168 @@
+#include <stdexcept>
+
+#include <efuzz/embedding_store.hpp>
+
+namespace efuzz {
+    EmbeddingStore::EmbeddingStore(std::size_t dimension, EmbeddingStorage storage) :
+        _dimension(dimension), _storage(storage) {
+        if (storage == EmbeddingStorage::product_quantized) {
+            throw std::invalid_argument("Product quantized storage needs a trained quantizer");
+        }
+    }
+
+    EmbeddingStore::EmbeddingStore(std::size_t dimension, ProductQuantizer product_quantizer) :
+        _dimension(dimension), _storage(EmbeddingStorage::product_quantized),
+        _product_quantizer(std::move(product_quantizer)) {
+        if (!_product_quantizer.is_trained() || _product_quantizer.get_dimension() != dimension) {
+            throw std::invalid_argument("Product quantizer is untrained or has another dimension");
+        }
+    }
+
+    void EmbeddingStore::append(const float* embedding) {
+        switch (_storage) {
+            case EmbeddingStorage::float32:
+                _float_embeddings.insert(_float_embeddings.end(), embedding,
+                                         embedding + _dimension);
+                break;
+
+            case EmbeddingStorage::float16:
+                for (std::size_t component {0}; component < _dimension; ++component) {
+                    _half_embeddings.emplace_back(embedding [component]);
+                }
+                break;
+
+            case EmbeddingStorage::product_quantized:
+                _codes.resize(_codes.size() + _product_quantizer.get_subspace_count());
+                _product_quantizer.encode(
+                    embedding, _codes.data() + (_size * _product_quantizer.get_subspace_count()));
+                break;
+        }
+
+        _size++;
+    }
+
+    void EmbeddingStore::truncate(std::size_t size) {
+        if (size >= _size) {
+            return;
+        }
+
+        switch (_storage) {
+            case EmbeddingStorage::float32: _float_embeddings.resize(size * _dimension); break;
+            case EmbeddingStorage::float16: _half_embeddings.resize(size * _dimension); break;
+            case EmbeddingStorage::product_quantized:
+                _codes.resize(size * _product_quantizer.get_subspace_count());
+                break;
+        }
+
+        _size = size;
+    }
+
+    void EmbeddingStore::clear() {
+        _float_embeddings.clear();
+        _half_embeddings.clear();
+        _codes.clear();
+        _size = 0;
+    }
+
+    void EmbeddingStore::reserve(std::size_t count) {
+        switch (_storage) {
+            case EmbeddingStorage::float32: _float_embeddings.reserve(count * _dimension); break;
+            case EmbeddingStorage::float16: _half_embeddings.reserve(count * _dimension); break;
+            case EmbeddingStorage::product_quantized:
+                _codes.reserve(count * _product_quantizer.get_subspace_count());
+                break;
+        }
+    }
+
+    void EmbeddingStore::distances(const float* query, float* distances) const {
+        const auto dimension = static_cast<Eigen::Index>(_dimension);
+        const auto size = static_cast<Eigen::Index>(_size);
+        const Eigen::Map<const Eigen::VectorXf> query_vector(query, dimension);
+        Eigen::Map<Eigen::VectorXf> output(distances, size);
+
+        switch (_storage) {
+            case EmbeddingStorage::float32: {
+                const Eigen::Map<const Eigen::MatrixXf> embeddings(_float_embeddings.data(),
+                                                                   dimension, size);
+
+                output = (embeddings.colwise() - query_vector).colwise().squaredNorm().transpose();
+                break;
+            }
+
+            case EmbeddingStorage::float16: {
+                const Eigen::Map<const Eigen::Matrix<Eigen::half, Eigen::Dynamic, Eigen::Dynamic>>
+                    embeddings(_half_embeddings.data(), dimension, size);
+
+                for (Eigen::Index index {0}; index < size; ++index) {
+                    output(index) =
+                        (embeddings.col(index).cast<float>() - query_vector).squaredNorm();
+                }
+                break;
+            }
+
+            case EmbeddingStorage::product_quantized: {
+                const Eigen::MatrixXf table = _product_quantizer.distance_table(query);
+                const std::size_t code_size = _product_quantizer.get_subspace_count();
+
+                for (std::size_t index {0}; index < _size; ++index) {
+                    distances [index] = ProductQuantizer::table_distance(
+                        table, _codes.data() + (index * code_size));
+                }
+                break;
+            }
+        }
+    }
+
+    Eigen::VectorXf EmbeddingStore::get(std::size_t index) const {
+        Eigen::VectorXf embedding(_dimension);
+
+        switch (_storage) {
+            case EmbeddingStorage::float32:
+                embedding = Eigen::Map<const Eigen::VectorXf>(
+                    _float_embeddings.data() + (index * _dimension), embedding.size());
+                break;
+
+            case EmbeddingStorage::float16:
+                for (std::size_t component {0}; component < _dimension; ++component) {
+                    embedding(component) =
+                        static_cast<float>(_half_embeddings [(index * _dimension) + component]);
+                }
+                break;
+
+            case EmbeddingStorage::product_quantized:
+                _product_quantizer.decode(
+                    _codes.data() + (index * _product_quantizer.get_subspace_count()),
+                    embedding.data());
+                break;
+        }
+
+        return embedding;
+    }
+
+    std::size_t EmbeddingStore::size() const noexcept {
+        return _size;
+    }
+
+    std::size_t EmbeddingStore::get_dimension() const noexcept {
+        return _dimension;
+    }
+
+    EmbeddingStorage EmbeddingStore::get_storage() const noexcept {
+        return _storage;
+    }
+
+    std::size_t EmbeddingStore::bytes_per_embedding() const noexcept {
+        switch (_storage) {
+            case EmbeddingStorage::float32: return _dimension * sizeof(float);
+            case EmbeddingStorage::float16: return _dimension * sizeof(Eigen::half);
+            case EmbeddingStorage::product_quantized:
+                return _product_quantizer.get_subspace_count();
+        }
+
+        return 0;
+    }
+
+    const ProductQuantizer& EmbeddingStore::get_product_quantizer() const noexcept {
+        return _product_quantizer;
+    }
+} // namespace efuzz
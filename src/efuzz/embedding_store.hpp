@@ -0,0 +1,106 @@
+#ifndef EFUZZ_EMBEDDING_STORE_HPP
+#define EFUZZ_EMBEDDING_STORE_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <cereal/cereal.hpp>
+#include <cereal/types/vector.hpp>
+#include <Eigen/Core>
+
+#include <efuzz/product_quantizer.hpp>
+
+namespace efuzz {
+    enum class EmbeddingStorage : std::uint8_t {
+        float32,
+        float16,
+        product_quantized,
+    };
+
+    // Append-only embedding storage, scanned by squared L2 distance to a query.
+    class EmbeddingStore {
+        public:
+
+        EmbeddingStore() = default;
+        explicit EmbeddingStore(std::size_t dimension,
+                                EmbeddingStorage storage = EmbeddingStorage::float32);
+        EmbeddingStore(std::size_t dimension, ProductQuantizer product_quantizer);
+
+        void append(const float* embedding);
+        // Drops every embedding from index `size` on.
+        void truncate(std::size_t size);
+        void clear();
+        void reserve(std::size_t count);
+
+        // Writes the squared distance from `query` to every stored embedding into `distances`.
+        void distances(const float* query, float* distances) const;
+        // Decompressed copy of one embedding.
+        [[nodiscard]] Eigen::VectorXf get(std::size_t index) const;
+
+        [[nodiscard]] std::size_t size() const noexcept;
+        [[nodiscard]] std::size_t get_dimension() const noexcept;
+        [[nodiscard]] EmbeddingStorage get_storage() const noexcept;
+        [[nodiscard]] std::size_t bytes_per_embedding() const noexcept;
+        [[nodiscard]] const ProductQuantizer& get_product_quantizer() const noexcept;
+
+        // Archives without binary data, such as JSON and XML, get the float16 embeddings as a
+        // list of their bit patterns.
+        template <class Archive>
+        void save(Archive& archive) const {
+            archive(_dimension, _storage, _size, _float_embeddings, _product_quantizer, _codes);
+
+            if constexpr (cereal::traits::is_output_serializable<cereal::BinaryData<Eigen::half>,
+                                                                 Archive>::value) {
+                archive(cereal::binary_data(_half_embeddings.data(),
+                                            _half_embeddings.size() * sizeof(Eigen::half)));
+            }
+            else {
+                std::vector<std::uint16_t> half_bits(_half_embeddings.size());
+
+                std::transform(
+                    _half_embeddings.begin(), _half_embeddings.end(), half_bits.begin(),
+                    [](Eigen::half value) { return std::bit_cast<std::uint16_t>(value); });
+                archive(half_bits);
+            }
+        }
+
+        template <class Archive>
+        void load(Archive& archive) {
+            archive(_dimension, _storage, _size, _float_embeddings, _product_quantizer, _codes);
+            _half_embeddings.resize(_storage == EmbeddingStorage::float16 ? _size * _dimension : 0);
+
+            if constexpr (cereal::traits::is_input_serializable<cereal::BinaryData<Eigen::half>,
+                                                                Archive>::value) {
+                archive(cereal::binary_data(_half_embeddings.data(),
+                                            _half_embeddings.size() * sizeof(Eigen::half)));
+            }
+            else {
+                std::vector<std::uint16_t> half_bits;
+
+                archive(half_bits);
+
+                if (half_bits.size() != _half_embeddings.size()) {
+                    throw cereal::Exception("float16 embedding count does not match the store");
+                }
+
+                std::transform(half_bits.begin(), half_bits.end(), _half_embeddings.begin(),
+                               [](std::uint16_t bits) { return std::bit_cast<Eigen::half>(bits); });
+            }
+        }
+
+        private:
+
+        std::size_t _dimension {};
+        EmbeddingStorage _storage {EmbeddingStorage::float32};
+        std::size_t _size {};
+        std::vector<float> _float_embeddings;
+        std::vector<Eigen::half> _half_embeddings;
+        ProductQuantizer _product_quantizer;
+        std::vector<std::uint8_t> _codes;
+    };
+} // namespace efuzz
+
+#endif // EFUZZ_EMBEDDING_STORE_HPP
@@ -1,9 +1,14 @@
 #ifndef EFUZZ_ENCODE_HPP
 #define EFUZZ_ENCODE_HPP
 
+#include <algorithm>
+#include <concepts>
 #include <cstddef>
 #include <functional>
+#include <numeric>
 #include <optional>
+#include <stdexcept>
+#include <string_view>
 #include <type_traits>
 #include <vector>
 
@@ -13,6 +18,7 @@
 
 #include <efuzz/cereal_eigen.hpp>
 #include <efuzz/neural_network/neural_network.hpp>
+#include <efuzz/neural_network/sparse_neural_network.hpp>
 
 namespace efuzz {
     template <typename StringT>
@@ -32,6 +38,7 @@ namespace efuzz {
         using StringT = StringT_;
         static constexpr std::integral auto encoding_result_size = encoding_result_size_::value;
         using char_type = typename StringT::value_type;
+        using string_view_type = std::basic_string_view<char_type>;
         using this_type = Encoder<StringT, encoding_result_size_>;
         using char_encoder_size = std::integral_constant<std::size_t, sizeof(char_type) * 8>;
         using encoding_result_size_is_dynamic =
@@ -53,18 +60,43 @@ namespace efuzz {
         template <typename Archive>
         void serialize(Archive& archive) {
             archive(_word_vector_encoder_nn);
+
+            if constexpr (Archive::is_loading::value) {
+                resolve_sparse_inference();
+            }
         }
 
-        encoding_result_type encode(const StringT& word);
+        encoding_result_type encode(string_view_type word);
+        // Reentrant variant that keeps the recurrent state on the stack instead of in the encoder.
+        [[nodiscard]] encoding_result_type encode(string_view_type word) const;
+        // Encodes every word into its own column. Each letter position is one matrix product over
+        // the words that are still that long, instead of one matrix-vector product per word.
+        // Takes strings or views, such as those of a StringPool.
+        template <typename WordT>
+        [[nodiscard]] Eigen::MatrixXf encode_batch(const std::vector<WordT>& words) const
+            requires std::convertible_to<const WordT&, string_view_type>;
         this_type& encode_letter(const char_type& letter);
         this_type& reset_encoding_result();
         [[nodiscard]] encoding_result_type get_encoding_result() const;
 
         this_type& set_word_vector_encoder_nn(const NeuralNetwork& neural_network);
         this_type& modify_word_vector_encoder_nn(const NeuralNetwork::NeuralNetworkDiff& diff);
-        [[nodiscard]] NeuralNetwork get_word_vector_encoder_nn() const;
+        // Takes parameters saved with get_word_vector_encoder_nn().copy_parameters_to(), so a
+        // trial modification can be undone without copying the whole network.
+        this_type& restore_word_vector_encoder_nn_parameters(
+            const NeuralNetwork::ParameterBuffer& snapshot);
+        [[nodiscard]] const NeuralNetwork& get_word_vector_encoder_nn() const;
         this_type& set_encoding_nn_layer_sizes(const std::vector<std::size_t>& layer_sizes,
                                                bool random = true);
+        // For encoders without a compile-time encoding_result_size. Drops the network, whose
+        // input and output sizes follow from the encoding size.
+        this_type& set_encoding_result_size(std::size_t size)
+            requires(!encoding_result_size_is_dynamic::value);
+
+        // Whether encode, encode_letter and encode_batch run a sparse copy of the network. Set up
+        // whenever the network changes, for networks pruned below
+        // SparseNeuralNetwork::DENSITY_THRESHOLD.
+        [[nodiscard]] bool uses_sparse_inference() const;
 
         [[nodiscard]] std::size_t get_nn_input_size() const;
         [[nodiscard]] std::size_t get_nn_output_size() const;
@@ -87,13 +119,24 @@ namespace efuzz {
             std::integral_constant<std::size_t, static_cast<std::size_t>(encoding_result_size)>,
             std::nullptr_t>;
 
+        void encode_letter_into(const char_type& letter,
+                                encoding_result_type& encoding_result) const;
+        // Builds or drops _sparse_word_vector_encoder_nn to match _word_vector_encoder_nn
+        void resolve_sparse_inference();
+        [[nodiscard]] encoding_result_type initial_encoding_result() const;
+        // The size set by set_encoding_result_size(), or else the size of the network output
+        [[nodiscard]] std::size_t runtime_encoding_result_size() const
+            requires(!encoding_result_size_is_dynamic::value);
+
         NeuralNetwork _word_vector_encoder_nn; // Recurrent Neural Network (RNN)
+        // Rebuilt from a pruned _word_vector_encoder_nn whenever it changes
+        std::optional<SparseNeuralNetwork> _sparse_word_vector_encoder_nn;
         encoding_result_type _encoding_result;
         std::optional<std::size_t> _encoding_result_size;
     };
 
     template <StdString StringT_, IntegralConstant encoding_result_size_>
-    auto Encoder<StringT_, encoding_result_size_>::encode(const StringT& word)
+    auto Encoder<StringT_, encoding_result_size_>::encode(string_view_type word)
         -> encoding_result_type {
         reset_encoding_result();
 
@@ -104,9 +147,94 @@ namespace efuzz {
         return _encoding_result;
     }
 
+    template <StdString StringT_, IntegralConstant encoding_result_size_>
+    auto Encoder<StringT_, encoding_result_size_>::encode(string_view_type word) const
+        -> encoding_result_type {
+        encoding_result_type encoding_result = initial_encoding_result();
+
+        for (const auto& letter: word) {
+            encode_letter_into(letter, encoding_result);
+        }
+
+        return encoding_result;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_>
+    template <typename WordT>
+    auto Encoder<StringT_, encoding_result_size_>::encode_batch(
+        const std::vector<WordT>& words) const -> Eigen::MatrixXf
+        requires std::convertible_to<const WordT&, string_view_type> {
+        if (_word_vector_encoder_nn.layer_sizes.empty()) {
+            throw std::runtime_error("Word vector encoder neural network not set");
+        }
+
+        const auto letter_size = static_cast<Eigen::Index>(char_encoder_size::value);
+        const auto output_size =
+            static_cast<Eigen::Index>(_word_vector_encoder_nn.layer_sizes.back());
+        const auto word_count = static_cast<Eigen::Index>(words.size());
+
+        // Longest first, so the words still being encoded are always the leading columns
+        std::vector<std::size_t> order(words.size());
+
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&words](std::size_t left, std::size_t right) {
+            return words [left].size() > words [right].size();
+        });
+
+        Eigen::MatrixXf states = Eigen::MatrixXf::Zero(output_size, word_count);
+        Eigen::MatrixXf inputs(letter_size + output_size, word_count);
+        std::size_t active = words.size();
+
+        for (std::size_t position {0};; ++position) {
+            while (active > 0 && words [order [active - 1]].size() <= position) {
+                --active;
+            }
+
+            if (active == 0) {
+                break;
+            }
+
+            for (std::size_t column {0}; column < active; ++column) {
+                const char_type letter = words [order [column]][position];
+                char_type mask = 1;
+
+                for (Eigen::Index bit {0}; bit < letter_size; ++bit) {
+                    inputs(bit, static_cast<Eigen::Index>(column)) = (letter & mask) ? 1.0F : 0.0F;
+                    mask <<= 1;
+                }
+            }
+
+            const auto active_columns = static_cast<Eigen::Index>(active);
+
+            inputs.bottomRows(output_size).leftCols(active_columns) =
+                states.leftCols(active_columns);
+            states.leftCols(active_columns) =
+                _sparse_word_vector_encoder_nn
+                    ? _sparse_word_vector_encoder_nn->compute_batch(inputs.leftCols(active_columns))
+                    : _word_vector_encoder_nn.compute_batch(inputs.leftCols(active_columns));
+        }
+
+        Eigen::MatrixXf encodings(output_size, word_count);
+
+        for (std::size_t column {0}; column < order.size(); ++column) {
+            encodings.col(static_cast<Eigen::Index>(order [column])) =
+                states.col(static_cast<Eigen::Index>(column));
+        }
+
+        return encodings;
+    }
+
     template <StdString StringT_, IntegralConstant encoding_result_size_>
     auto Encoder<StringT_, encoding_result_size_>::encode_letter(const char_type& letter)
         -> this_type& {
+        encode_letter_into(letter, _encoding_result);
+
+        return *this;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_>
+    void Encoder<StringT_, encoding_result_size_>::encode_letter_into(
+        const char_type& letter, encoding_result_type& encoding_result) const {
         if (_word_vector_encoder_nn.layer_sizes.empty()) {
             throw std::runtime_error("Word vector encoder neural network not set");
         }
@@ -122,16 +250,50 @@ namespace efuzz {
 
         neural_network_input_type input;
 
-        input << letter_binary_encoding, _encoding_result;
+        if constexpr (!encoding_result_size_is_dynamic::value) {
+            input.resize(char_encoder_size::value + encoding_result.size());
+        }
 
-        _encoding_result = _word_vector_encoder_nn.compute(input);
+        input << letter_binary_encoding, encoding_result;
 
-        return *this;
+        if constexpr (!encoding_result_size_is_dynamic::value) {
+            encoding_result.resize(_word_vector_encoder_nn.layer_sizes.back());
+        }
+
+        if (_sparse_word_vector_encoder_nn) {
+            _sparse_word_vector_encoder_nn->compute_into(input.data(), encoding_result.data());
+        }
+        else {
+            _word_vector_encoder_nn.compute_into(input.data(), encoding_result.data());
+        }
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_>
+    void Encoder<StringT_, encoding_result_size_>::resolve_sparse_inference() {
+        if (SparseNeuralNetwork::is_worthwhile(_word_vector_encoder_nn)) {
+            _sparse_word_vector_encoder_nn.emplace(_word_vector_encoder_nn);
+        }
+        else {
+            _sparse_word_vector_encoder_nn.reset();
+        }
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_>
+    auto Encoder<StringT_, encoding_result_size_>::initial_encoding_result() const
+        -> encoding_result_type {
+        if constexpr (encoding_result_size_is_dynamic::value) {
+            return encoding_result_type::Zero();
+        }
+        else {
+            const auto& layer_sizes = _word_vector_encoder_nn.layer_sizes;
+
+            return encoding_result_type::Zero(layer_sizes.empty() ? 0 : layer_sizes.back());
+        }
     }
 
     template <StdString StringT_, IntegralConstant encoding_result_size_>
     auto Encoder<StringT_, encoding_result_size_>::reset_encoding_result() -> this_type& {
-        _encoding_result.setZero();
+        _encoding_result = initial_encoding_result();
 
         return *this;
     }
@@ -146,6 +308,7 @@ namespace efuzz {
     auto Encoder<StringT_, encoding_result_size_>::set_word_vector_encoder_nn(
         const NeuralNetwork& neural_network) -> this_type& {
         _word_vector_encoder_nn = neural_network;
+        resolve_sparse_inference();
 
         return *this;
     }
@@ -154,13 +317,23 @@ namespace efuzz {
     auto Encoder<StringT_, encoding_result_size_>::modify_word_vector_encoder_nn(
         const NeuralNetwork::NeuralNetworkDiff& diff) -> this_type& {
         _word_vector_encoder_nn.modify(diff);
+        resolve_sparse_inference();
+
+        return *this;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_>
+    auto Encoder<StringT_, encoding_result_size_>::restore_word_vector_encoder_nn_parameters(
+        const NeuralNetwork::ParameterBuffer& snapshot) -> this_type& {
+        _word_vector_encoder_nn.copy_parameters_from(snapshot);
+        resolve_sparse_inference();
 
         return *this;
     }
 
     template <StdString StringT_, IntegralConstant encoding_result_size_>
     auto Encoder<StringT_, encoding_result_size_>::get_word_vector_encoder_nn() const
-        -> NeuralNetwork {
+        -> const NeuralNetwork& {
         return _word_vector_encoder_nn;
     }
 
@@ -171,19 +344,35 @@ namespace efuzz {
         assert(layer_sizes.back() == get_nn_output_size());
 
         _word_vector_encoder_nn = NeuralNetwork(layer_sizes, random);
+        resolve_sparse_inference();
 
         return *this;
     }
 
+    template <StdString StringT_, IntegralConstant encoding_result_size_>
+    auto Encoder<StringT_, encoding_result_size_>::set_encoding_result_size(std::size_t size)
+        -> this_type& requires(!encoding_result_size_is_dynamic::value) {
+        _encoding_result_size = size;
+        _word_vector_encoder_nn = NeuralNetwork();
+        resolve_sparse_inference();
+        reset_encoding_result();
+
+        return *this;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_>
+    bool Encoder<StringT_, encoding_result_size_>::uses_sparse_inference() const {
+        return _sparse_word_vector_encoder_nn.has_value();
+    }
+
     template <StdString StringT_, IntegralConstant encoding_result_size_>
     auto Encoder<StringT_, encoding_result_size_>::get_nn_input_size() const -> std::size_t {
         if constexpr (encoding_result_size_is_dynamic::value) {
             return char_encoder_size::value + encoding_result_size;
         }
-
-        assert(_encoding_result_size.has_value());
-
-        return char_encoder_size::value + _encoding_result_size.value();
+        else {
+            return char_encoder_size::value + runtime_encoding_result_size();
+        }
     }
 
     template <StdString StringT_, IntegralConstant encoding_result_size_>
@@ -191,10 +380,9 @@ namespace efuzz {
         if constexpr (encoding_result_size_is_dynamic::value) {
             return encoding_result_size;
         }
-
-        assert(_encoding_result_size.has_value());
-
-        return _encoding_result_size.value();
+        else {
+            return runtime_encoding_result_size();
+        }
     }
 
     template <StdString StringT_, IntegralConstant encoding_result_size_>
@@ -206,9 +394,20 @@ namespace efuzz {
     template <StdString StringT_, IntegralConstant encoding_result_size_>
     auto Encoder<StringT_, encoding_result_size_>::output_norm_max() const -> float
         requires(!encoding_result_size_is_dynamic::value) {
-        assert(_encoding_result_size.has_value());
+        return std::sqrt(static_cast<float>(runtime_encoding_result_size()));
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_>
+    auto Encoder<StringT_, encoding_result_size_>::runtime_encoding_result_size() const
+        -> std::size_t requires(!encoding_result_size_is_dynamic::value) {
+        if (_encoding_result_size.has_value()) {
+            return _encoding_result_size.value();
+        }
+
+        // Loaded encoders only carry their network
+        assert(!_word_vector_encoder_nn.layer_sizes.empty());
 
-        return std::sqrt(static_cast<float>(_encoding_result_size.value()));
+        return _word_vector_encoder_nn.layer_sizes.back();
     }
 } // namespace efuzz
 
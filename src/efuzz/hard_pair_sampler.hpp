@@ -0,0 +1,264 @@
+#ifndef EFUZZ_HARD_PAIR_SAMPLER_HPP
+#define EFUZZ_HARD_PAIR_SAMPLER_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <Eigen/Core>
+
+namespace efuzz {
+    struct HardPairSamplerOptions {
+        constexpr static std::size_t DEFAULT_POOL_SIZE {1024};
+        constexpr static std::size_t DEFAULT_REFRESH_INTERVAL {50};
+        constexpr static std::size_t DEFAULT_ANCHOR_COUNT {256};
+        constexpr static std::size_t DEFAULT_NEIGHBOR_COUNT {8};
+        constexpr static std::size_t DEFAULT_RANDOM_CANDIDATE_COUNT {2048};
+
+        // Share of every batch drawn from the hard pairs; the rest are uniform random pairs.
+        float hard_fraction {0.5F};
+        // Hard pairs kept: the costliest candidates of the last refresh.
+        std::size_t pool_size {DEFAULT_POOL_SIZE};
+        // Batches between refreshes from the current encoder.
+        std::size_t refresh_interval {DEFAULT_REFRESH_INTERVAL};
+        // Candidates of a refresh: every one of anchor_count random entries paired with its
+        // neighbor_count nearest entries by embedding distance, plus random_candidate_count
+        // uniform pairs.
+        std::size_t anchor_count {DEFAULT_ANCHOR_COUNT};
+        std::size_t neighbor_count {DEFAULT_NEIGHBOR_COUNT};
+        std::size_t random_candidate_count {DEFAULT_RANDOM_CANDIDATE_COUNT};
+        std::uint64_t seed {};
+    };
+
+    // Draws training batches of EncoderTrainer dataset id pairs that mix uniform pairs with a
+    // pool of hard ones: near neighbors in embedding space and pairs the encoder currently gets
+    // most wrong, which uniform pairs of unrelated words rarely are. The batches go to
+    // EncoderTrainer::train or average_cost like any other id pairs, or, through
+    // as_pair_sampler(), to train_random and TrainingCoordinator::train.
+    template <typename TrainerT>
+    class HardPairSampler {
+        public:
+
+        using IdPair = typename TrainerT::IdPair;
+
+        // Embeddings of this many anchors are compared with the dataset at a time
+        constexpr static std::size_t ANCHOR_BLOCK_SIZE {64};
+
+        explicit HardPairSampler(HardPairSamplerOptions options = {});
+
+        // pair_count pairs of distinct entries of trainer's dataset. Refreshes the hard pairs
+        // first on the first call, every refresh_interval calls and whenever the dataset size
+        // changed.
+        [[nodiscard]] std::vector<IdPair> sample(const TrainerT& trainer, std::size_t pair_count);
+        // Re-ranks the candidate pairs with trainer's current encoder, with one batch encoding
+        // of the dataset.
+        void refresh(const TrainerT& trainer);
+        // sample() as an EncoderTrainer::PairSampler; the sampler must outlive the trainers it
+        // is set on.
+        [[nodiscard]] typename TrainerT::PairSampler as_pair_sampler();
+
+        // Costliest first.
+        [[nodiscard]] const std::vector<IdPair>& get_hard_pairs() const;
+        [[nodiscard]] std::size_t get_refresh_count() const;
+
+        private:
+
+        [[nodiscard]] IdPair random_pair(std::size_t dataset_size);
+
+        HardPairSamplerOptions _options;
+        std::mt19937_64 _random_engine;
+        std::vector<IdPair> _hard_pairs;
+        std::size_t _batches_since_refresh {};
+        std::size_t _refresh_count {};
+        std::size_t _refreshed_dataset_size {};
+    };
+
+    template <typename TrainerT>
+    HardPairSampler<TrainerT>::HardPairSampler(HardPairSamplerOptions options) :
+        _options(options),
+        _random_engine(options.seed) {
+        if (!(_options.hard_fraction >= 0.0F && _options.hard_fraction <= 1.0F)) {
+            throw std::runtime_error("Hard pair fraction must be between 0 and 1");
+        }
+    }
+
+    template <typename TrainerT>
+    auto HardPairSampler<TrainerT>::sample(const TrainerT& trainer, std::size_t pair_count)
+        -> std::vector<IdPair> {
+        const std::size_t dataset_size = trainer.get_dataset()->size();
+
+        if (dataset_size < 2) {
+            throw std::runtime_error("Dataset too small");
+        }
+
+        if (_refresh_count == 0 || _batches_since_refresh >= _options.refresh_interval ||
+            dataset_size != _refreshed_dataset_size) {
+            refresh(trainer);
+        }
+
+        ++_batches_since_refresh;
+
+        const auto hard_target = static_cast<std::size_t>(
+            std::lround(_options.hard_fraction * static_cast<float>(pair_count)));
+        const std::size_t hard_count = _hard_pairs.empty() ? 0 : std::min(pair_count, hard_target);
+        std::vector<IdPair> pairs;
+
+        pairs.reserve(pair_count);
+
+        if (hard_count > 0) {
+            std::uniform_int_distribution<std::size_t> hard_pair(0, _hard_pairs.size() - 1);
+
+            for (std::size_t pair {0}; pair < hard_count; ++pair) {
+                pairs.push_back(_hard_pairs [hard_pair(_random_engine)]);
+            }
+        }
+
+        while (pairs.size() < pair_count) {
+            pairs.push_back(random_pair(dataset_size));
+        }
+
+        return pairs;
+    }
+
+    template <typename TrainerT>
+    void HardPairSampler<TrainerT>::refresh(const TrainerT& trainer) {
+        const auto dataset = trainer.get_dataset();
+        const std::size_t dataset_size = dataset->size();
+
+        _hard_pairs.clear();
+        _batches_since_refresh = 0;
+        _refreshed_dataset_size = dataset_size;
+        ++_refresh_count;
+
+        if (dataset_size < 2 || _options.pool_size == 0) {
+            return;
+        }
+
+        const auto encoder = trainer.get_encoder();
+        const Eigen::MatrixXf encodings = encoder.encode_batch(dataset->views());
+        const Eigen::VectorXf squared_norms = encodings.colwise().squaredNorm().transpose();
+        std::vector<IdPair> candidates;
+
+        // Nearest neighbors of random anchors, ranked by |a - b|^2 = |a|^2 + |b|^2 - 2 a.b with
+        // one matrix product per block of anchors
+        std::vector<Eigen::Index> anchors(dataset_size);
+
+        std::iota(anchors.begin(), anchors.end(), 0);
+        std::shuffle(anchors.begin(), anchors.end(), _random_engine);
+        anchors.resize(std::min(anchors.size(), _options.anchor_count));
+
+        const std::size_t neighbor_count = std::min(_options.neighbor_count, dataset_size - 1);
+        std::vector<Eigen::Index> block;
+        const auto nth_offset = static_cast<std::ptrdiff_t>(neighbor_count) - 1;
+        std::vector<std::size_t> neighbors(dataset_size);
+        Eigen::MatrixXf distances;
+
+        for (std::size_t block_begin {0}; block_begin < anchors.size() && neighbor_count > 0;
+             block_begin += ANCHOR_BLOCK_SIZE) {
+            const std::size_t block_end =
+                std::min(anchors.size(), block_begin + ANCHOR_BLOCK_SIZE);
+
+            block.assign(anchors.begin() + static_cast<std::ptrdiff_t>(block_begin),
+                         anchors.begin() + static_cast<std::ptrdiff_t>(block_end));
+            distances.noalias() = encodings(Eigen::all, block).transpose() * encodings;
+            distances = (distances * -2.0F).rowwise() + squared_norms.transpose();
+
+            for (std::size_t row {0}; row < block.size(); ++row) {
+                const auto anchor = static_cast<std::size_t>(block [row]);
+                const auto distance_row = distances.row(static_cast<Eigen::Index>(row));
+
+                std::iota(neighbors.begin(), neighbors.end(), 0);
+                std::swap(neighbors [anchor], neighbors.back());
+                // The anchor itself is left out at the end; |a|^2 is the same for the whole row
+                std::nth_element(neighbors.begin(), neighbors.begin() + nth_offset,
+                                 neighbors.end() - 1,
+                                 [&distance_row](std::size_t left, std::size_t right) {
+                                     return distance_row(static_cast<Eigen::Index>(left)) <
+                                            distance_row(static_cast<Eigen::Index>(right));
+                                 });
+
+                for (std::size_t neighbor {0}; neighbor < neighbor_count; ++neighbor) {
+                    candidates.emplace_back(std::min(anchor, neighbors [neighbor]),
+                                            std::max(anchor, neighbors [neighbor]));
+                }
+            }
+        }
+
+        for (std::size_t candidate {0}; candidate < _options.random_candidate_count;
+             ++candidate) {
+            const IdPair pair = random_pair(dataset_size);
+
+            candidates.emplace_back(std::min(pair.first, pair.second),
+                                    std::max(pair.first, pair.second));
+        }
+
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+        // Costed from the embeddings above, as EncoderTrainer::cost would
+        const float max_normalized_difference = encoder.output_norm_max();
+        std::vector<std::pair<float, IdPair>> costs;
+
+        costs.reserve(candidates.size());
+
+        for (const auto& [id_1, id_2]: candidates) {
+            const float distance = (encodings.col(static_cast<Eigen::Index>(id_1)) -
+                                    encodings.col(static_cast<Eigen::Index>(id_2)))
+                                       .norm() /
+                                   max_normalized_difference;
+
+            costs.emplace_back(
+                std::abs(distance - trainer.target((*dataset) [id_1], (*dataset) [id_2])),
+                IdPair {id_1, id_2});
+        }
+
+        const std::size_t kept = std::min(costs.size(), _options.pool_size);
+
+        std::partial_sort(costs.begin(), costs.begin() + static_cast<std::ptrdiff_t>(kept),
+                          costs.end(), [](const auto& left, const auto& right) {
+                              return left.first > right.first;
+                          });
+
+        for (std::size_t index {0}; index < kept; ++index) {
+            _hard_pairs.push_back(costs [index].second);
+        }
+    }
+
+    template <typename TrainerT>
+    auto HardPairSampler<TrainerT>::as_pair_sampler() -> typename TrainerT::PairSampler {
+        return [this](const TrainerT& trainer, std::size_t pair_count) {
+            return sample(trainer, pair_count);
+        };
+    }
+
+    template <typename TrainerT>
+    auto HardPairSampler<TrainerT>::get_hard_pairs() const -> const std::vector<IdPair>& {
+        return _hard_pairs;
+    }
+
+    template <typename TrainerT>
+    std::size_t HardPairSampler<TrainerT>::get_refresh_count() const {
+        return _refresh_count;
+    }
+
+    template <typename TrainerT>
+    auto HardPairSampler<TrainerT>::random_pair(std::size_t dataset_size) -> IdPair {
+        std::uniform_int_distribution<std::size_t> distribution_1(0, dataset_size - 1);
+        std::uniform_int_distribution<std::size_t> distribution_2(0, dataset_size - 2);
+        const std::size_t index_1 = distribution_1(_random_engine);
+        std::size_t index_2 = distribution_2(_random_engine);
+
+        // Skip index_1 so the two entries always differ
+        index_2 += static_cast<std::size_t>(index_2 >= index_1);
+
+        return {index_1, index_2};
+    }
+} // namespace efuzz
+
+#endif // EFUZZ_HARD_PAIR_SAMPLER_HPP
@@ -0,0 +1,416 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+#include <thread>
+
+#include <Eigen/Core>
+
+#include <efuzz/hnsw_index.hpp>
+
+namespace efuzz {
+    namespace {
+        // Visits `node`'s links on `level`, under the node's lock while a batch is being built.
+        template <typename Links, typename Visitor>
+        void for_each_neighbor(const Links& links, std::uint32_t node, std::size_t level,
+                               std::vector<std::mutex>* locks, Visitor&& visitor) {
+            std::unique_lock<std::mutex> lock;
+
+            if (locks != nullptr) {
+                lock = std::unique_lock {(*locks) [node]};
+            }
+
+            for (const std::uint32_t neighbor: links [node][level]) {
+                visitor(neighbor);
+            }
+        }
+
+        // Tags the nodes a search has reached. The tag changes per search, so the array is only
+        // cleared when it wraps around.
+        struct VisitedNodes {
+            std::vector<std::uint32_t> tags;
+            std::uint32_t tag {};
+
+            void reset(std::size_t node_count) {
+                if (tags.size() < node_count) {
+                    tags.resize(node_count);
+                }
+
+                if (++tag == 0) {
+                    std::fill(tags.begin(), tags.end(), 0);
+                    tag = 1;
+                }
+            }
+
+            bool visit(std::uint32_t node) {
+                const bool first_visit = tags [node] != tag;
+
+                tags [node] = tag;
+
+                return first_visit;
+            }
+        };
+    } // namespace
+
+    HnswVectorIndex::HnswVectorIndex(std::size_t dimension, HnswParameters parameters) :
+        _dimension(dimension), _parameters(parameters), _random_state(parameters.seed) {
+        if (_parameters.m < 2) {
+            throw std::invalid_argument("HNSW needs at least 2 links per node");
+        }
+    }
+
+    void HnswVectorIndex::add(const float* embedding) {
+        append_node(embedding);
+        insert(static_cast<std::uint32_t>(size() - 1), nullptr, nullptr);
+    }
+
+    void HnswVectorIndex::add_batch(const float* embeddings, std::size_t count) {
+        const std::size_t first_node = size();
+
+        for (std::size_t index {0}; index < count; ++index) {
+            append_node(embeddings + (index * _dimension));
+        }
+
+        std::size_t next_node = first_node;
+
+        // The first node has nothing to link to; it only becomes the entry point
+        if (next_node == 0 && count > 0) {
+            insert(0, nullptr, nullptr);
+            next_node++;
+        }
+
+        const std::size_t remaining = size() - next_node;
+        const std::size_t thread_count = std::min<std::size_t>(
+            remaining, _parameters.thread_count > 0
+                           ? _parameters.thread_count
+                           : std::max<std::size_t>(1, std::thread::hardware_concurrency()));
+
+        if (thread_count <= 1) {
+            for (; next_node < size(); ++next_node) {
+                insert(static_cast<std::uint32_t>(next_node), nullptr, nullptr);
+            }
+
+            return;
+        }
+
+        std::vector<std::mutex> locks(size());
+        std::mutex entry_lock;
+        std::atomic<std::size_t> shared_next_node {next_node};
+        std::vector<std::thread> threads;
+
+        threads.reserve(thread_count);
+
+        for (std::size_t thread {0}; thread < thread_count; ++thread) {
+            threads.emplace_back([this, &locks, &entry_lock, &shared_next_node]() {
+                for (std::size_t node = shared_next_node.fetch_add(1); node < size();
+                     node = shared_next_node.fetch_add(1)) {
+                    insert(static_cast<std::uint32_t>(node), &locks, &entry_lock);
+                }
+            });
+        }
+
+        for (auto& thread: threads) {
+            thread.join();
+        }
+    }
+
+    std::vector<std::size_t> HnswVectorIndex::nearest(const float* query,
+                                                      std::size_t count) const {
+        if (_levels.empty() || count == 0) {
+            return {};
+        }
+
+        std::uint32_t entry = _entry_point;
+
+        for (std::size_t level = _max_level; level > 0; --level) {
+            entry = greedy_closest(query, entry, level, nullptr);
+        }
+
+        const std::vector<Candidate> candidates =
+            search_layer(query, {{distance(query, embedding(entry)), entry}},
+                         std::max(_parameters.ef_search, count), 0, nullptr);
+        std::vector<std::size_t> ids;
+
+        ids.reserve(std::min(count, candidates.size()));
+
+        for (std::size_t index {0}; index < candidates.size() && index < count; ++index) {
+            ids.push_back(candidates [index].second);
+        }
+
+        return ids;
+    }
+
+    std::size_t HnswVectorIndex::size() const noexcept {
+        return _levels.size();
+    }
+
+    std::size_t HnswVectorIndex::get_dimension() const noexcept {
+        return _dimension;
+    }
+
+    VectorIndexType HnswVectorIndex::get_type() const noexcept {
+        return VectorIndexType::hnsw;
+    }
+
+    std::unique_ptr<VectorIndex> HnswVectorIndex::clone() const {
+        return std::make_unique<HnswVectorIndex>(*this);
+    }
+
+    void HnswVectorIndex::set_ef_search(std::size_t ef_search) noexcept {
+        _parameters.ef_search = ef_search;
+    }
+
+    const HnswParameters& HnswVectorIndex::get_parameters() const noexcept {
+        return _parameters;
+    }
+
+    std::size_t HnswVectorIndex::get_max_level() const noexcept {
+        return _max_level;
+    }
+
+    void HnswVectorIndex::insert(std::uint32_t node, std::vector<std::mutex>* locks,
+                                 std::mutex* entry_lock) {
+        const std::uint32_t level = _levels [node];
+
+        if (node == 0) {
+            _entry_point = 0;
+            _max_level = level;
+
+            return;
+        }
+
+        std::uint32_t entry {};
+        std::uint32_t max_level {};
+
+        {
+            std::unique_lock<std::mutex> lock;
+
+            if (entry_lock != nullptr) {
+                lock = std::unique_lock {*entry_lock};
+            }
+
+            entry = _entry_point;
+            max_level = _max_level;
+        }
+
+        const float* query = embedding(node);
+
+        for (std::size_t current_level = max_level; current_level > level; --current_level) {
+            entry = greedy_closest(query, entry, current_level, locks);
+        }
+
+        std::vector<Candidate> entries {{distance(query, embedding(entry)), entry}};
+
+        for (std::size_t current_level = std::min(level, max_level) + 1; current_level-- > 0;) {
+            std::vector<Candidate> candidates = search_layer(
+                query, entries, _parameters.ef_construction, current_level, locks);
+            const std::vector<std::uint32_t> selected =
+                select_neighbors(candidates, _parameters.m);
+
+            {
+                std::unique_lock<std::mutex> lock;
+
+                if (locks != nullptr) {
+                    lock = std::unique_lock {(*locks) [node]};
+                }
+
+                _links [node][current_level] = selected;
+            }
+
+            for (const std::uint32_t neighbor: selected) {
+                std::unique_lock<std::mutex> lock;
+
+                if (locks != nullptr) {
+                    lock = std::unique_lock {(*locks) [neighbor]};
+                }
+
+                auto& links = _links [neighbor][current_level];
+
+                links.push_back(node);
+
+                if (links.size() > max_links(current_level)) {
+                    std::vector<Candidate> neighbor_candidates;
+
+                    neighbor_candidates.reserve(links.size());
+
+                    for (const std::uint32_t link: links) {
+                        neighbor_candidates.emplace_back(
+                            distance(embedding(neighbor), embedding(link)), link);
+                    }
+
+                    std::sort(neighbor_candidates.begin(), neighbor_candidates.end());
+                    links = select_neighbors(std::move(neighbor_candidates),
+                                             max_links(current_level));
+                }
+            }
+
+            entries = std::move(candidates);
+        }
+
+        if (level > max_level) {
+            std::unique_lock<std::mutex> lock;
+
+            if (entry_lock != nullptr) {
+                lock = std::unique_lock {*entry_lock};
+            }
+
+            if (level > _max_level) {
+                _entry_point = node;
+                _max_level = level;
+            }
+        }
+    }
+
+    auto HnswVectorIndex::search_layer(const float* query, const std::vector<Candidate>& entries,
+                                       std::size_t ef, std::size_t level,
+                                       std::vector<std::mutex>* locks) const
+        -> std::vector<Candidate> {
+        thread_local VisitedNodes visited_nodes;
+
+        visited_nodes.reset(size());
+
+        std::priority_queue<Candidate, std::vector<Candidate>, std::greater<>> candidates;
+        std::priority_queue<Candidate> results; // Farthest on top
+
+        for (const auto& entry: entries) {
+            visited_nodes.visit(entry.second);
+            candidates.push(entry);
+            results.push(entry);
+
+            if (results.size() > ef) {
+                results.pop();
+            }
+        }
+
+        while (!candidates.empty()) {
+            const Candidate closest = candidates.top();
+
+            if (results.size() >= ef && closest.first > results.top().first) {
+                break;
+            }
+
+            candidates.pop();
+
+            for_each_neighbor(_links, closest.second, level, locks, [&](std::uint32_t neighbor) {
+                if (!visited_nodes.visit(neighbor)) {
+                    return;
+                }
+
+                const float neighbor_distance = distance(query, embedding(neighbor));
+
+                if (results.size() < ef || neighbor_distance < results.top().first) {
+                    candidates.emplace(neighbor_distance, neighbor);
+                    results.emplace(neighbor_distance, neighbor);
+
+                    if (results.size() > ef) {
+                        results.pop();
+                    }
+                }
+            });
+        }
+
+        std::vector<Candidate> nearest(results.size());
+
+        for (auto candidate = nearest.rbegin(); candidate != nearest.rend(); ++candidate) {
+            *candidate = results.top();
+            results.pop();
+        }
+
+        return nearest;
+    }
+
+    std::uint32_t HnswVectorIndex::greedy_closest(const float* query, std::uint32_t entry,
+                                                  std::size_t level,
+                                                  std::vector<std::mutex>* locks) const {
+        float closest_distance = distance(query, embedding(entry));
+        bool improved {true};
+
+        while (improved) {
+            improved = false;
+
+            for_each_neighbor(_links, entry, level, locks, [&](std::uint32_t neighbor) {
+                const float neighbor_distance = distance(query, embedding(neighbor));
+
+                if (neighbor_distance < closest_distance) {
+                    closest_distance = neighbor_distance;
+                    entry = neighbor;
+                    improved = true;
+                }
+            });
+        }
+
+        return entry;
+    }
+
+    std::vector<std::uint32_t>
+        HnswVectorIndex::select_neighbors(std::vector<Candidate> candidates,
+                                          std::size_t max_count) const {
+        std::vector<std::uint32_t> selected;
+
+        selected.reserve(max_count);
+
+        for (const auto& [candidate_distance, candidate]: candidates) {
+            if (selected.size() >= max_count) {
+                break;
+            }
+
+            const bool diverse =
+                std::none_of(selected.begin(), selected.end(), [&](std::uint32_t kept) {
+                    return distance(embedding(candidate), embedding(kept)) < candidate_distance;
+                });
+
+            if (diverse) {
+                selected.push_back(candidate);
+            }
+        }
+
+        return selected;
+    }
+
+    std::size_t HnswVectorIndex::max_links(std::size_t level) const noexcept {
+        return level == 0 ? 2 * _parameters.m : _parameters.m;
+    }
+
+    std::uint32_t HnswVectorIndex::random_level() {
+        // splitmix64, so the state is a single serializable integer
+        std::uint64_t bits = (_random_state += 0x9E3779B97F4A7C15ULL);
+
+        bits = (bits ^ (bits >> 30U)) * 0xBF58476D1CE4E5B9ULL;
+        bits = (bits ^ (bits >> 27U)) * 0x94D049BB133111EBULL;
+        bits ^= bits >> 31U;
+
+        // Uniform in (0, 1]
+        const double uniform = static_cast<double>((bits >> 11U) + 1) * 0x1.0p-53;
+
+        return static_cast<std::uint32_t>(-std::log(uniform) /
+                                          std::log(static_cast<double>(_parameters.m)));
+    }
+
+    const float* HnswVectorIndex::embedding(std::uint32_t node) const noexcept {
+        return _embeddings.data() + (static_cast<std::size_t>(node) * _dimension);
+    }
+
+    float HnswVectorIndex::distance(const float* lhs, const float* rhs) const noexcept {
+        const auto dimension = static_cast<Eigen::Index>(_dimension);
+
+        return (Eigen::Map<const Eigen::VectorXf>(lhs, dimension) -
+                Eigen::Map<const Eigen::VectorXf>(rhs, dimension))
+            .squaredNorm();
+    }
+
+    void HnswVectorIndex::append_node(const float* embedding) {
+        if (size() >= std::numeric_limits<std::uint32_t>::max()) {
+            throw std::length_error("HNSW index is full");
+        }
+
+        const std::uint32_t level = random_level();
+
+        _embeddings.insert(_embeddings.end(), embedding, embedding + _dimension);
+        _levels.push_back(level);
+        _links.emplace_back(level + 1);
+        _links.back().front().reserve(max_links(0) + 1);
+    }
+} // namespace efuzz
@@ -0,0 +1,94 @@
+#ifndef EFUZZ_HNSW_INDEX_HPP
+#define EFUZZ_HNSW_INDEX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <cereal/cereal.hpp>
+#include <cereal/types/vector.hpp>
+
+#include <efuzz/vector_index.hpp>
+
+namespace efuzz {
+    struct HnswParameters {
+        std::size_t m {16}; // Links per node on the upper layers, twice that on layer 0
+        std::size_t ef_construction {200};
+        std::size_t ef_search {64};
+        std::size_t thread_count {}; // Used by add_batch, zero picks the hardware concurrency
+        std::uint64_t seed {42};
+
+        template <class Archive>
+        void serialize(Archive& archive) {
+            archive(m, ef_construction, ef_search, thread_count, seed);
+        }
+    };
+
+    // Hierarchical navigable small world graph (Malkov & Yashunin) over squared L2 distance.
+    // Embeddings can be added at any time; add_batch inserts on several threads.
+    class HnswVectorIndex : public VectorIndex {
+        public:
+
+        HnswVectorIndex() = default;
+        explicit HnswVectorIndex(std::size_t dimension, HnswParameters parameters = {});
+
+        void add(const float* embedding) override;
+        void add_batch(const float* embeddings, std::size_t count) override;
+
+        [[nodiscard]] std::vector<std::size_t> nearest(const float* query,
+                                                       std::size_t count) const override;
+
+        [[nodiscard]] std::size_t size() const noexcept override;
+        [[nodiscard]] std::size_t get_dimension() const noexcept override;
+        [[nodiscard]] VectorIndexType get_type() const noexcept override;
+        [[nodiscard]] std::unique_ptr<VectorIndex> clone() const override;
+
+        void set_ef_search(std::size_t ef_search) noexcept;
+        [[nodiscard]] const HnswParameters& get_parameters() const noexcept;
+        [[nodiscard]] std::size_t get_max_level() const noexcept;
+
+        template <class Archive>
+        void serialize(Archive& archive) {
+            archive(_dimension, _parameters, _embeddings, _levels, _links, _entry_point,
+                    _max_level, _random_state);
+        }
+
+        private:
+
+        using Candidate = std::pair<float, std::uint32_t>; // Distance, node
+
+        // Node insertion shared by add and add_batch. `locks` holds one mutex per node while
+        // several threads insert, and is null otherwise.
+        void insert(std::uint32_t node, std::vector<std::mutex>* locks, std::mutex* entry_lock);
+        [[nodiscard]] std::vector<Candidate> search_layer(const float* query,
+                                                          const std::vector<Candidate>& entries,
+                                                          std::size_t ef, std::size_t level,
+                                                          std::vector<std::mutex>* locks) const;
+        [[nodiscard]] std::uint32_t greedy_closest(const float* query, std::uint32_t entry,
+                                                   std::size_t level,
+                                                   std::vector<std::mutex>* locks) const;
+        // Keeps candidates not closer to an already kept neighbour than to the base point, which
+        // preserves links between clusters.
+        [[nodiscard]] std::vector<std::uint32_t>
+            select_neighbors(std::vector<Candidate> candidates, std::size_t max_count) const;
+        [[nodiscard]] std::size_t max_links(std::size_t level) const noexcept;
+        [[nodiscard]] std::uint32_t random_level();
+        [[nodiscard]] const float* embedding(std::uint32_t node) const noexcept;
+        [[nodiscard]] float distance(const float* lhs, const float* rhs) const noexcept;
+        void append_node(const float* embedding);
+
+        std::size_t _dimension {};
+        HnswParameters _parameters;
+        std::vector<float> _embeddings;
+        std::vector<std::uint32_t> _levels;
+        std::vector<std::vector<std::vector<std::uint32_t>>> _links; // [node][level]
+        std::uint32_t _entry_point {};
+        std::uint32_t _max_level {};
+        std::uint64_t _random_state {};
+    };
+} // namespace efuzz
+
+#endif // EFUZZ_HNSW_INDEX_HPP
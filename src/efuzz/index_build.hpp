@@ -0,0 +1,122 @@
+#ifndef EFUZZ_INDEX_BUILD_HPP
+#define EFUZZ_INDEX_BUILD_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace efuzz {
+    struct IndexBuildProgress {
+        enum class Stage : std::uint8_t { encode, index };
+
+        Stage stage {};
+        std::size_t completed {};
+        std::size_t total {}; // Items known so far; grows while insert_lines reads its stream
+    };
+
+    struct IndexBuildOptions {
+        constexpr static std::size_t DEFAULT_CHUNK_SIZE {1024};
+
+        std::size_t thread_count {}; // Zero picks the hardware concurrency
+        std::size_t chunk_size {DEFAULT_CHUNK_SIZE};
+        // Called after every chunk, one call at a time but possibly from a worker thread.
+        std::function<void(const IndexBuildProgress&)> progress;
+
+        [[nodiscard]] std::size_t resolved_thread_count() const {
+            return thread_count > 0 ? thread_count
+                                    : std::max<std::size_t>(1, std::thread::hardware_concurrency());
+        }
+
+        [[nodiscard]] std::size_t resolved_chunk_size() const {
+            return std::max<std::size_t>(1, chunk_size);
+        }
+    };
+
+    // Splits [0, item_count) into chunks of chunk_size and runs chunk_function(begin, end) on
+    // each, spread over thread_count threads including the caller. Rethrows the first exception
+    // a chunk throws; chunks not yet started are then skipped.
+    template <typename ChunkFunction>
+    void parallel_for_chunks(std::size_t item_count, std::size_t chunk_size,
+                             std::size_t thread_count, ChunkFunction&& chunk_function) {
+        chunk_size = std::max<std::size_t>(1, chunk_size);
+
+        const std::size_t chunk_count = (item_count + chunk_size - 1) / chunk_size;
+
+        thread_count = std::min(thread_count, chunk_count);
+
+        std::atomic<std::size_t> next_chunk {};
+        std::mutex exception_mutex;
+        std::exception_ptr exception;
+
+        const auto work = [&]() {
+            for (std::size_t chunk = next_chunk.fetch_add(1); chunk < chunk_count;
+                 chunk = next_chunk.fetch_add(1)) {
+                const std::size_t begin = chunk * chunk_size;
+
+                try {
+                    chunk_function(begin, std::min(begin + chunk_size, item_count));
+                }
+                catch (...) {
+                    const std::lock_guard lock {exception_mutex};
+
+                    if (!exception) {
+                        exception = std::current_exception();
+                    }
+
+                    next_chunk.store(chunk_count);
+
+                    return;
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+
+        for (std::size_t thread {1}; thread < thread_count; ++thread) {
+            threads.emplace_back(work);
+        }
+
+        work();
+
+        for (auto& thread: threads) {
+            thread.join();
+        }
+
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+    }
+
+    // parallel_for_chunks as configured by `options`, reporting progress for `stage` after each
+    // chunk.
+    template <typename ChunkFunction>
+    void for_each_chunk(std::size_t item_count, const IndexBuildOptions& options,
+                        IndexBuildProgress::Stage stage, ChunkFunction&& chunk_function) {
+        std::mutex progress_mutex;
+        std::size_t completed {};
+
+        parallel_for_chunks(item_count, options.resolved_chunk_size(),
+                            options.resolved_thread_count(),
+                            [&](std::size_t begin, std::size_t end) {
+                                chunk_function(begin, end);
+
+                                const std::lock_guard lock {progress_mutex};
+
+                                completed += end - begin;
+
+                                if (options.progress) {
+                                    options.progress({.stage = stage,
+                                                      .completed = completed,
+                                                      .total = item_count});
+                                }
+                            });
+    }
+} // namespace efuzz
+
+#endif // EFUZZ_INDEX_BUILD_HPP
@@ -0,0 +1,180 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include <efuzz/neural_network/layer_kernel.hpp>
+
+#if EFUZZ_LAYER_KERNEL_X86
+ #include <immintrin.h>
+#endif
+
+namespace efuzz {
+    namespace {
+        // Same as NeuralNetwork::sigmoid_abs, kept here so the fallback kernel can inline it.
+        inline float fused_sigmoid_abs(float value) {
+            return 0.5F + value / (2 * (1 + std::abs(value)));
+        }
+    } // namespace
+
+    void layer_kernel_portable(const float* weights, const float* biases, const float* input,
+                               float* output, std::size_t rows, std::size_t cols) noexcept {
+        constexpr std::size_t block_size {8};
+
+        for (std::size_t row {0}; row < rows; row += block_size) {
+            const std::size_t block_rows = std::min(block_size, rows - row);
+            std::array<float, block_size> accumulator {};
+
+            std::copy_n(biases + row, block_rows, accumulator.begin());
+
+            for (std::size_t col {0}; col < cols; ++col) {
+                const float* column = weights + (col * rows) + row;
+                const float value = input [col];
+
+                for (std::size_t lane {0}; lane < block_rows; ++lane) {
+                    accumulator [lane] += column [lane] * value;
+                }
+            }
+
+            for (std::size_t lane {0}; lane < block_rows; ++lane) {
+                output [row + lane] = fused_sigmoid_abs(accumulator [lane]);
+            }
+        }
+    }
+
+#if EFUZZ_LAYER_KERNEL_X86
+    namespace {
+        __attribute__((target("avx2,fma"))) inline __m256 sigmoid_abs_avx2(__m256 value) {
+            const __m256 two = _mm256_set1_ps(2.0F);
+            const __m256 absolute = _mm256_andnot_ps(_mm256_set1_ps(-0.0F), value);
+            const __m256 denominator = _mm256_fmadd_ps(absolute, two, two);
+
+            return _mm256_add_ps(_mm256_set1_ps(0.5F), _mm256_div_ps(value, denominator));
+        }
+
+        __attribute__((target("avx512f"))) inline __m512 sigmoid_abs_avx512(__m512 value) {
+            const __m512 two = _mm512_set1_ps(2.0F);
+            const __m512 absolute = _mm512_abs_ps(value);
+            const __m512 denominator = _mm512_fmadd_ps(absolute, two, two);
+
+            return _mm512_add_ps(_mm512_set1_ps(0.5F), _mm512_div_ps(value, denominator));
+        }
+    } // namespace
+
+    __attribute__((target("avx2,fma"))) void
+        layer_kernel_avx2(const float* weights, const float* biases, const float* input,
+                          float* output, std::size_t rows, std::size_t cols) noexcept {
+        constexpr std::size_t lanes {8};
+        // Sliding window into this table yields a load mask for the first `n` lanes.
+        alignas(64) static constexpr std::array<std::int32_t, 2 * lanes> mask_table {
+            -1, -1, -1, -1, -1, -1, -1, -1, 0, 0, 0, 0, 0, 0, 0, 0};
+
+        std::size_t row {0};
+
+        // Two row blocks at a time so the FMA chains are independent.
+        for (; row + (2 * lanes) <= rows; row += 2 * lanes) {
+            __m256 accumulator_1 = _mm256_loadu_ps(biases + row);
+            __m256 accumulator_2 = _mm256_loadu_ps(biases + row + lanes);
+
+            for (std::size_t col {0}; col < cols; ++col) {
+                const float* column = weights + (col * rows) + row;
+                const __m256 value = _mm256_broadcast_ss(input + col);
+
+                accumulator_1 = _mm256_fmadd_ps(_mm256_loadu_ps(column), value, accumulator_1);
+                accumulator_2 =
+                    _mm256_fmadd_ps(_mm256_loadu_ps(column + lanes), value, accumulator_2);
+            }
+
+            _mm256_storeu_ps(output + row, sigmoid_abs_avx2(accumulator_1));
+            _mm256_storeu_ps(output + row + lanes, sigmoid_abs_avx2(accumulator_2));
+        }
+
+        for (; row + lanes <= rows; row += lanes) {
+            __m256 accumulator = _mm256_loadu_ps(biases + row);
+
+            for (std::size_t col {0}; col < cols; ++col) {
+                accumulator = _mm256_fmadd_ps(_mm256_loadu_ps(weights + (col * rows) + row),
+                                              _mm256_broadcast_ss(input + col), accumulator);
+            }
+
+            _mm256_storeu_ps(output + row, sigmoid_abs_avx2(accumulator));
+        }
+
+        if (row < rows) {
+            const std::size_t remaining = rows - row;
+            const __m256i mask = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(mask_table.data() + lanes - remaining));
+
+            __m256 accumulator = _mm256_maskload_ps(biases + row, mask);
+
+            for (std::size_t col {0}; col < cols; ++col) {
+                accumulator =
+                    _mm256_fmadd_ps(_mm256_maskload_ps(weights + (col * rows) + row, mask),
+                                    _mm256_broadcast_ss(input + col), accumulator);
+            }
+
+            _mm256_maskstore_ps(output + row, mask, sigmoid_abs_avx2(accumulator));
+        }
+    }
+
+    __attribute__((target("avx512f"))) void
+        layer_kernel_avx512(const float* weights, const float* biases, const float* input,
+                            float* output, std::size_t rows, std::size_t cols) noexcept {
+        constexpr std::size_t lanes {16};
+
+        for (std::size_t row {0}; row < rows; row += lanes) {
+            const std::size_t remaining = std::min(lanes, rows - row);
+            const __mmask16 mask = static_cast<__mmask16>((1U << remaining) - 1U);
+
+            __m512 accumulator = _mm512_maskz_loadu_ps(mask, biases + row);
+
+            for (std::size_t col {0}; col < cols; ++col) {
+                accumulator =
+                    _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, weights + (col * rows) + row),
+                                    _mm512_set1_ps(input [col]), accumulator);
+            }
+
+            _mm512_mask_storeu_ps(output + row, mask, sigmoid_abs_avx512(accumulator));
+        }
+    }
+#endif
+
+    LayerKernel select_layer_kernel() noexcept {
+#if EFUZZ_LAYER_KERNEL_X86
+        __builtin_cpu_init();
+
+        if (__builtin_cpu_supports("avx512f")) {
+            return layer_kernel_avx512;
+        }
+
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+            return layer_kernel_avx2;
+        }
+#endif
+
+        return layer_kernel_portable;
+    }
+
+    LayerKernel layer_kernel() noexcept {
+        static const LayerKernel kernel = select_layer_kernel();
+
+        return kernel;
+    }
+
+    const char* layer_kernel_name() noexcept {
+        const LayerKernel kernel = layer_kernel();
+
+#if EFUZZ_LAYER_KERNEL_X86
+        if (kernel == layer_kernel_avx512) {
+            return "avx512";
+        }
+
+        if (kernel == layer_kernel_avx2) {
+            return "avx2";
+        }
+#endif
+
+        return kernel == layer_kernel_portable ? "portable" : "unknown";
+    }
+} // namespace efuzz
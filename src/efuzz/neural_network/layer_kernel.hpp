@@ -0,0 +1,40 @@
+#ifndef EFUZZ_LAYER_KERNEL_HPP
+#define EFUZZ_LAYER_KERNEL_HPP
+
+#include <cstddef>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__)) && \
+    !defined(EFUZZ_DISABLE_SIMD_DISPATCH)
+ #define EFUZZ_LAYER_KERNEL_X86 1
+#else
+ #define EFUZZ_LAYER_KERNEL_X86 0
+#endif
+
+namespace efuzz {
+    // Computes output = sigmoid_abs(weights * input + biases) for a single dense layer in one pass.
+    // `weights` is column-major with `rows` rows and `cols` columns (the Eigen::MatrixXf layout).
+    // `output` must not alias `input`.
+    using LayerKernel = void (*)(const float* weights, const float* biases, const float* input,
+                                 float* output, std::size_t rows, std::size_t cols) noexcept;
+
+    void layer_kernel_portable(const float* weights, const float* biases, const float* input,
+                               float* output, std::size_t rows, std::size_t cols) noexcept;
+
+#if EFUZZ_LAYER_KERNEL_X86
+    void layer_kernel_avx2(const float* weights, const float* biases, const float* input,
+                           float* output, std::size_t rows, std::size_t cols) noexcept;
+    void layer_kernel_avx512(const float* weights, const float* biases, const float* input,
+                             float* output, std::size_t rows, std::size_t cols) noexcept;
+#endif
+
+    // Picks the widest kernel the running CPU supports.
+    [[nodiscard]] LayerKernel select_layer_kernel() noexcept;
+
+    // The kernel chosen by select_layer_kernel(), resolved once per process.
+    [[nodiscard]] LayerKernel layer_kernel() noexcept;
+
+    // Name of the kernel returned by layer_kernel(), for logging.
+    [[nodiscard]] const char* layer_kernel_name() noexcept;
+} // namespace efuzz
+
+#endif // EFUZZ_LAYER_KERNEL_HPP
@@ -1,44 +1,190 @@
+#include <algorithm>
+#include <array>
 #include <cmath>
 #include <filesystem>
 #include <fstream>
+#include <stdexcept>
 #include <vector>
 
 #include <cereal/cereal.hpp>
 
+#include <efuzz/neural_network/layer_kernel.hpp>
 #include <efuzz/neural_network/neural_network.hpp>
 
 namespace efuzz {
+    namespace {
+        // Floats per alignment boundary; parameter blocks are padded to a multiple of it.
+        constexpr std::size_t PARAMETER_ALIGNMENT {
+            std::max<std::size_t>(1, EIGEN_MAX_ALIGN_BYTES / sizeof(float))};
+
+        constexpr std::size_t padded_block_size(std::size_t size) {
+            return (size + PARAMETER_ALIGNMENT - 1) / PARAMETER_ALIGNMENT * PARAMETER_ALIGNMENT;
+        }
+    } // namespace
+
     NeuralNetwork::NeuralNetwork(std::vector<std::size_t> layer_sizes, bool randomize) :
         layer_sizes(layer_sizes), most_recent_diff(layer_sizes) {
+        allocate_parameters(layer_sizes, _parameters, weights, biases);
+
+        if (randomize) {
+            this->randomize();
+        }
+    }
+
+    NeuralNetwork::NeuralNetwork(const NeuralNetwork& other) :
+        iterations(other.iterations), layer_sizes(other.layer_sizes),
+        most_recent_diff(other.most_recent_diff), most_recent_cost(other.most_recent_cost),
+        diff_improvement_streak(other.diff_improvement_streak), _parameters(other._parameters) {
+        bind_parameters(layer_sizes, _parameters, weights, biases);
+    }
+
+    NeuralNetwork& NeuralNetwork::operator=(const NeuralNetwork& other) {
+        if (this != &other) {
+            iterations = other.iterations;
+            layer_sizes = other.layer_sizes;
+            most_recent_diff = other.most_recent_diff;
+            most_recent_cost = other.most_recent_cost;
+            diff_improvement_streak = other.diff_improvement_streak;
+            _parameters = other._parameters;
+            bind_parameters(layer_sizes, _parameters, weights, biases);
+        }
+
+        return *this;
+    }
+
+    std::size_t
+        NeuralNetwork::parameter_buffer_size(const std::vector<std::size_t>& layer_sizes) noexcept {
+        std::size_t size {};
+
         for (std::size_t index {1}; index < layer_sizes.size(); ++index) {
-            weights.emplace_back(layer_sizes [index], layer_sizes [index - 1]);
-            biases.emplace_back(layer_sizes [index]);
+            size += padded_block_size(layer_sizes [index] * layer_sizes [index - 1]) +
+                    padded_block_size(layer_sizes [index]);
         }
 
-        if (randomize) {
-            for (auto& weight: weights) {
-                weight = Eigen::MatrixXf::Random(weight.rows(), weight.cols());
+        return size;
+    }
+
+    void NeuralNetwork::allocate_parameters(const std::vector<std::size_t>& layer_sizes,
+                                            ParameterBuffer& parameters,
+                                            std::vector<WeightMap>& weights,
+                                            std::vector<BiasMap>& biases) {
+        parameters.assign(parameter_buffer_size(layer_sizes), 0.0F);
+        bind_parameters(layer_sizes, parameters, weights, biases);
+    }
+
+    void NeuralNetwork::bind_parameters(const std::vector<std::size_t>& layer_sizes,
+                                        ParameterBuffer& parameters,
+                                        std::vector<WeightMap>& weights,
+                                        std::vector<BiasMap>& biases) {
+        weights.clear();
+        biases.clear();
+
+        float* block = parameters.data();
+
+        for (std::size_t index {1}; index < layer_sizes.size(); ++index) {
+            const auto rows = static_cast<Eigen::Index>(layer_sizes [index]);
+            const auto cols = static_cast<Eigen::Index>(layer_sizes [index - 1]);
+
+            weights.emplace_back(block, rows, cols);
+            block += padded_block_size(layer_sizes [index] * layer_sizes [index - 1]);
+            biases.emplace_back(block, rows);
+            block += padded_block_size(layer_sizes [index]);
+        }
+    }
+
+    void NeuralNetwork::copy_layers(const std::vector<Eigen::MatrixXf>& source_weights,
+                                    const std::vector<Eigen::VectorXf>& source_biases,
+                                    std::vector<WeightMap>& weights,
+                                    std::vector<BiasMap>& biases) {
+        if (source_weights.size() != weights.size() || source_biases.size() != biases.size()) {
+            throw std::runtime_error("Network layer count does not match its layer sizes");
+        }
+
+        for (std::size_t index {0}; index < weights.size(); ++index) {
+            if (source_weights [index].rows() != weights [index].rows() ||
+                source_weights [index].cols() != weights [index].cols() ||
+                source_biases [index].size() != biases [index].size()) {
+                throw std::runtime_error("Network layer sizes do not match its weights");
             }
 
-            for (auto& bias: biases) {
-                bias = Eigen::VectorXf::Random(bias.rows());
+            weights [index] = source_weights [index];
+            biases [index] = source_biases [index];
+        }
+    }
+
+    Eigen::Map<Eigen::VectorXf, Eigen::AlignedMax> NeuralNetwork::flat() noexcept {
+        return {_parameters.data(), static_cast<Eigen::Index>(_parameters.size())};
+    }
+
+    Eigen::VectorXf NeuralNetwork::compute(Eigen::VectorXf input) const {
+        if (weights.empty()) {
+            return input;
+        }
+
+        Eigen::VectorXf output(layer_sizes.back());
+
+        compute_into(input.data(), output.data());
+
+        return output;
+    }
+
+    void NeuralNetwork::compute_into(const float* input, float* output,
+                                     std::size_t first_layer) const {
+        if (first_layer >= weights.size()) {
+            std::copy_n(input, first_layer < layer_sizes.size() ? layer_sizes [first_layer] : 0,
+                        output);
+
+            return;
+        }
+
+        thread_local std::array<std::vector<float>, 2> buffers;
+
+        const LayerKernel kernel = layer_kernel();
+        const float* layer_input = input;
+
+        for (std::size_t index {first_layer}; index < weights.size(); ++index) {
+            const auto& weight = weights [index];
+            float* layer_output = output;
+
+            if (index + 1 < weights.size()) {
+                auto& buffer = buffers [index % 2];
+
+                if (buffer.size() < static_cast<std::size_t>(weight.rows())) {
+                    buffer.resize(weight.rows());
+                }
+
+                layer_output = buffer.data();
             }
+
+            kernel(weight.data(), biases [index].data(), layer_input, layer_output, weight.rows(),
+                   weight.cols());
+
+            layer_input = layer_output;
         }
     }
 
-    Eigen::VectorXf NeuralNetwork::compute(Eigen::VectorXf input) const noexcept {
-        for (std::size_t index {0}; index < weights.size(); ++index) {
-            input = weights [index] * input + biases [index];
-            input = input.unaryExpr([](float value) { return sigmoid_abs(value); });
+    Eigen::MatrixXf NeuralNetwork::compute_batch(const Eigen::MatrixXf& inputs,
+                                                 std::size_t first_layer) const {
+        Eigen::MatrixXf activations = inputs;
+
+        for (std::size_t index {first_layer}; index < weights.size(); ++index) {
+            Eigen::MatrixXf layer_output = weights [index] * activations;
+
+            layer_output.colwise() += biases [index];
+            activations = layer_output.unaryExpr(&NeuralNetwork::sigmoid_abs);
         }
 
-        return input;
+        return activations;
     }
 
-    NeuralNetwork::NeuralNetworkDiff NeuralNetwork::random_diff() const noexcept {
+    NeuralNetwork::NeuralNetworkDiff NeuralNetwork::random_diff() const {
         return NeuralNetworkDiff(layer_sizes);
     }
 
+    NeuralNetwork::NeuralNetworkDiff NeuralNetwork::random_diff(std::uint64_t seed) const {
+        return {layer_sizes, seed};
+    }
+
     float NeuralNetwork::sigmoid_abs(float value) {
         return 0.5F + value / (2 * (1 + std::abs(value)));
     }
@@ -53,8 +199,14 @@ namespace efuzz {
         }
     }
 
-    void NeuralNetwork::modify(NeuralNetwork::NeuralNetworkDiff diff, bool apply_biases,
+    void NeuralNetwork::modify(const NeuralNetwork::NeuralNetworkDiff& diff, bool apply_biases,
                                bool apply_weights) {
+        if (apply_biases && apply_weights && diff._parameters.size() == _parameters.size()) {
+            flat() += diff.flat();
+
+            return;
+        }
+
         if (apply_biases) {
             for (std::size_t index {0}; index < biases.size(); ++index) {
                 biases [index] += diff.bias_diffs [index];
@@ -68,6 +220,18 @@ namespace efuzz {
         }
     }
 
+    void NeuralNetwork::copy_parameters_to(ParameterBuffer& snapshot) const {
+        snapshot.assign(_parameters.begin(), _parameters.end());
+    }
+
+    void NeuralNetwork::copy_parameters_from(const ParameterBuffer& snapshot) {
+        if (snapshot.size() != _parameters.size()) {
+            throw std::runtime_error("Parameter snapshot is from a network of another shape");
+        }
+
+        std::copy(snapshot.begin(), snapshot.end(), _parameters.begin());
+    }
+
     /* Example usage:
      repeat {
          NeuralNetwork nn {...};
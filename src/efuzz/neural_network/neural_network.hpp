@@ -18,42 +18,75 @@ namespace efuzz {
     class NeuralNetwork {
         public:
 
+        // Every weight and bias of a network (or diff) lives in one aligned buffer, layer after
+        // layer, each block starting on an alignment boundary. weights / biases (weight_diffs /
+        // bias_diffs) are views into it, so a network and a diff of the same layer sizes can be
+        // combined with one pass over the buffer and a snapshot is one copy.
+        using ParameterBuffer = std::vector<float, Eigen::aligned_allocator<float>>;
+        using WeightMap = Eigen::Map<Eigen::MatrixXf, Eigen::AlignedMax>;
+        using BiasMap = Eigen::Map<Eigen::VectorXf, Eigen::AlignedMax>;
+
         class NeuralNetworkDiff {
             public:
 
             constexpr static std::size_t FIELD_COUNT {3};
-            std::vector<Eigen::MatrixXf> weight_diffs;
-            std::vector<Eigen::VectorXf> bias_diffs;
+            std::vector<WeightMap> weight_diffs;
+            std::vector<BiasMap> bias_diffs;
             std::vector<std::size_t> layer_sizes;
 
             NeuralNetworkDiff() = default;
+            // Moving keeps the buffer, so the views stay valid
             NeuralNetworkDiff(NeuralNetworkDiff&& other) noexcept = default;
-            NeuralNetworkDiff(const NeuralNetworkDiff& other) noexcept = default;
+            NeuralNetworkDiff(const NeuralNetworkDiff& other);
             explicit NeuralNetworkDiff(const std::vector<std::size_t>& layer_sizes);
+            // Deterministic for a given seed, so processes holding the same network can rebuild
+            // an identical diff from the seed alone.
+            NeuralNetworkDiff(const std::vector<std::size_t>& layer_sizes, std::uint64_t seed);
 
             NeuralNetworkDiff& operator=(NeuralNetworkDiff&& other) noexcept = default;
-            NeuralNetworkDiff& operator=(const NeuralNetworkDiff& other) noexcept = default;
+            NeuralNetworkDiff& operator=(const NeuralNetworkDiff& other);
 
             NeuralNetworkDiff& operator+=(const NeuralNetworkDiff& other) noexcept;
             NeuralNetworkDiff& operator-=(const NeuralNetworkDiff& other) noexcept;
             NeuralNetworkDiff& operator*=(float scalar) noexcept;
             NeuralNetworkDiff& operator/=(float scalar);
 
-            NeuralNetworkDiff operator+(const NeuralNetworkDiff& other) const noexcept;
-            NeuralNetworkDiff operator-(const NeuralNetworkDiff& other) const noexcept;
-            NeuralNetworkDiff operator*(float scalar) const noexcept;
+            NeuralNetworkDiff operator+(const NeuralNetworkDiff& other) const;
+            NeuralNetworkDiff operator-(const NeuralNetworkDiff& other) const;
+            NeuralNetworkDiff operator*(float scalar) const;
             NeuralNetworkDiff operator/(float scalar) const;
 
             void invert() noexcept;
+            // Zeroes the weight diffs of every weight that is exactly zero in `network`, so pruned
+            // connections stay pruned when the diff is applied.
+            void mask_pruned_weights(const NeuralNetwork& network) noexcept;
 
-            [[nodiscard]] NeuralNetworkDiff inverted() const noexcept;
+            [[nodiscard]] NeuralNetworkDiff inverted() const;
 
             friend class NeuralNetwork;
 
             template <class Archive>
-            void serialize(Archive& archive) {
+            void save(Archive& archive) const {
                 archive(weight_diffs, bias_diffs, layer_sizes);
             }
+
+            template <class Archive>
+            void load(Archive& archive) {
+                std::vector<Eigen::MatrixXf> loaded_weight_diffs;
+                std::vector<Eigen::VectorXf> loaded_bias_diffs;
+
+                archive(loaded_weight_diffs, loaded_bias_diffs, layer_sizes);
+                allocate_parameters(layer_sizes, _parameters, weight_diffs, bias_diffs);
+                copy_layers(loaded_weight_diffs, loaded_bias_diffs, weight_diffs, bias_diffs);
+            }
+
+            private:
+
+            [[nodiscard]] Eigen::Map<Eigen::VectorXf, Eigen::AlignedMax> flat() noexcept;
+            [[nodiscard]] Eigen::Map<const Eigen::VectorXf, Eigen::AlignedMax>
+                flat() const noexcept;
+
+            ParameterBuffer _parameters;
         };
 
         constexpr static float GOOD_COST {0.1F};
@@ -62,40 +95,100 @@ namespace efuzz {
         std::size_t iterations {};
         std::vector<std::size_t> layer_sizes;
 
-        std::vector<Eigen::MatrixXf> weights;
-        std::vector<Eigen::VectorXf> biases;
+        std::vector<WeightMap> weights;
+        std::vector<BiasMap> biases;
 
         NeuralNetworkDiff most_recent_diff;
         float most_recent_cost {};
         std::size_t diff_improvement_streak {};
 
         NeuralNetwork() = default;
+        // Moving keeps the buffer, so the views stay valid
         NeuralNetwork(NeuralNetwork&& other) noexcept = default;
-        NeuralNetwork(const NeuralNetwork& other) noexcept = default;
+        NeuralNetwork(const NeuralNetwork& other);
 
         NeuralNetwork& operator=(NeuralNetwork&& other) noexcept = default;
-        NeuralNetwork& operator=(const NeuralNetwork& other) noexcept = default;
+        NeuralNetwork& operator=(const NeuralNetwork& other);
 
         explicit NeuralNetwork(std::vector<std::size_t> layer_sizes, bool randomize = true);
 
         void randomize();
-        void modify(NeuralNetworkDiff diff, bool apply_biases = true, bool apply_weights = true);
+        // With both parts applied this is one vectorized add over the parameter buffer.
+        void modify(const NeuralNetworkDiff& diff, bool apply_biases = true,
+                    bool apply_weights = true);
+        // Copy every parameter into `snapshot` (reusing its storage) or back from a snapshot of a
+        // network with the same layer sizes, e.g. to undo a trial modify() exactly.
+        void copy_parameters_to(ParameterBuffer& snapshot) const;
+        void copy_parameters_from(const ParameterBuffer& snapshot);
 
         void train(float cost);
 
-        [[nodiscard]] Eigen::VectorXf compute(Eigen::VectorXf input) const noexcept;
-        [[nodiscard]] NeuralNetworkDiff random_diff() const noexcept;
+        // Zeroes the smallest `fraction` of weights by magnitude. Returns the number zeroed.
+        std::size_t prune_weights(float fraction);
+        // Removes the least influential `fraction` of neurons from every hidden layer, shrinking
+        // layer_sizes. A removed neuron's resting activation is folded into the next layer's
+        // biases. Returns the number of neurons removed.
+        std::size_t prune_neurons(float fraction);
+        [[nodiscard]] float weight_density() const noexcept;
+
+        [[nodiscard]] Eigen::VectorXf compute(Eigen::VectorXf input) const;
+        // Writes the network output for `input` into `output` (layer_sizes.back() floats).
+        // Hidden activations go through per-thread ping-pong buffers, so no allocation happens
+        // once those buffers have grown to the widest layer; growing them may throw. A nonzero
+        // `first_layer` skips the layers before it, `input` then being the activations of
+        // layer_sizes [first_layer].
+        void compute_into(const float* input, float* output,
+                          std::size_t first_layer = 0) const;
+        // Evaluates every column of `inputs` at once, one matrix product per layer.
+        [[nodiscard]] Eigen::MatrixXf compute_batch(const Eigen::MatrixXf& inputs,
+                                                    std::size_t first_layer = 0) const;
+        [[nodiscard]] NeuralNetworkDiff random_diff() const;
+        [[nodiscard]] NeuralNetworkDiff random_diff(std::uint64_t seed) const;
 
         void save_file(const std::filesystem::path& filepath) const;
 
+        // Same format as when weights and biases were separate matrices
         template <class Archive>
-        void serialize(Archive& archive) {
+        void save(Archive& archive) const {
             archive(iterations, layer_sizes, weights, biases, most_recent_diff, most_recent_cost,
                     diff_improvement_streak);
         }
 
+        template <class Archive>
+        void load(Archive& archive) {
+            std::vector<Eigen::MatrixXf> loaded_weights;
+            std::vector<Eigen::VectorXf> loaded_biases;
+
+            archive(iterations, layer_sizes, loaded_weights, loaded_biases, most_recent_diff,
+                    most_recent_cost, diff_improvement_streak);
+            allocate_parameters(layer_sizes, _parameters, weights, biases);
+            copy_layers(loaded_weights, loaded_biases, weights, biases);
+        }
+
         static NeuralNetwork load_file(const std::filesystem::path& filepath);
         static float sigmoid_abs(float value);
+
+        private:
+
+        // Sizes `parameters` for `layer_sizes` (zeroed) and points the views into it.
+        static void allocate_parameters(const std::vector<std::size_t>& layer_sizes,
+                                        ParameterBuffer& parameters,
+                                        std::vector<WeightMap>& weights,
+                                        std::vector<BiasMap>& biases);
+        // Points the views into `parameters`, already sized for `layer_sizes`.
+        static void bind_parameters(const std::vector<std::size_t>& layer_sizes,
+                                    ParameterBuffer& parameters, std::vector<WeightMap>& weights,
+                                    std::vector<BiasMap>& biases);
+        // Throws if the matrices do not have the shapes of the views.
+        static void copy_layers(const std::vector<Eigen::MatrixXf>& source_weights,
+                                const std::vector<Eigen::VectorXf>& source_biases,
+                                std::vector<WeightMap>& weights, std::vector<BiasMap>& biases);
+        [[nodiscard]] static std::size_t parameter_buffer_size(
+            const std::vector<std::size_t>& layer_sizes) noexcept;
+
+        [[nodiscard]] Eigen::Map<Eigen::VectorXf, Eigen::AlignedMax> flat() noexcept;
+
+        ParameterBuffer _parameters;
     };
 } // namespace efuzz
 
@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <random>
 #include <vector>
 
 #include <Eigen/Eigen>
@@ -9,52 +10,82 @@ namespace efuzz {
     // Give each random float values between -1 and 1.
     NeuralNetwork::NeuralNetworkDiff::NeuralNetworkDiff(
         const std::vector<std::size_t>& layer_sizes) :
-        weight_diffs(std::max(std::size_t {0}, layer_sizes.size() - 1)),
-        bias_diffs(std::max(std::size_t {0}, layer_sizes.size() - 1)), layer_sizes {layer_sizes} {
-        for (std::size_t index {0}; index < layer_sizes.size() - 1; index++) {
+        layer_sizes {layer_sizes} {
+        allocate_parameters(layer_sizes, _parameters, weight_diffs, bias_diffs);
+
+        for (std::size_t index {0}; index < weight_diffs.size(); index++) {
             weight_diffs [index] =
-                Eigen::MatrixXf::Random(layer_sizes [index + 1], layer_sizes [index]);
-            bias_diffs [index] = Eigen::VectorXf::Random(layer_sizes [index + 1]);
+                Eigen::MatrixXf::Random(weight_diffs [index].rows(), weight_diffs [index].cols());
+            bias_diffs [index] = Eigen::VectorXf::Random(bias_diffs [index].rows());
+        }
+    }
+
+    NeuralNetwork::NeuralNetworkDiff::NeuralNetworkDiff(const std::vector<std::size_t>& layer_sizes,
+                                                        std::uint64_t seed) :
+        layer_sizes {layer_sizes} {
+        std::mt19937_64 random_engine(seed);
+        std::uniform_real_distribution<float> distribution(-1.0F, 1.0F);
+
+        allocate_parameters(layer_sizes, _parameters, weight_diffs, bias_diffs);
+
+        // Drawn in the same order as before the diffs shared one buffer, so seeds stay portable
+        for (std::size_t index {0}; index < weight_diffs.size(); index++) {
+            weight_diffs [index] = Eigen::MatrixXf::NullaryExpr(
+                weight_diffs [index].rows(), weight_diffs [index].cols(),
+                [&]() { return distribution(random_engine); });
+            bias_diffs [index] = Eigen::VectorXf::NullaryExpr(
+                bias_diffs [index].rows(), [&]() { return distribution(random_engine); });
+        }
+    }
+
+    NeuralNetwork::NeuralNetworkDiff::NeuralNetworkDiff(
+        const NeuralNetwork::NeuralNetworkDiff& other) :
+        layer_sizes(other.layer_sizes), _parameters(other._parameters) {
+        bind_parameters(layer_sizes, _parameters, weight_diffs, bias_diffs);
+    }
+
+    NeuralNetwork::NeuralNetworkDiff& NeuralNetwork::NeuralNetworkDiff::operator=(
+        const NeuralNetwork::NeuralNetworkDiff& other) {
+        if (this != &other) {
+            layer_sizes = other.layer_sizes;
+            _parameters = other._parameters;
+            bind_parameters(layer_sizes, _parameters, weight_diffs, bias_diffs);
         }
+
+        return *this;
     }
 
+    // Both diffs must have the same layer sizes, and so the same buffer layout; the padding
+    // between blocks stays zero.
     NeuralNetwork::NeuralNetworkDiff& NeuralNetwork::NeuralNetworkDiff::operator+=(
         const NeuralNetwork::NeuralNetworkDiff& other) noexcept {
-        for (std::size_t index {0}; index < layer_sizes.size() - 1; index++) {
-            weight_diffs [index] += other.weight_diffs [index];
-            bias_diffs [index] += other.bias_diffs [index];
-        }
+        flat() += other.flat();
+
         return *this;
     }
 
     NeuralNetwork::NeuralNetworkDiff& NeuralNetwork::NeuralNetworkDiff::operator-=(
         const NeuralNetwork::NeuralNetworkDiff& other) noexcept {
-        for (std::size_t index {0}; index < layer_sizes.size() - 1; index++) {
-            weight_diffs [index] -= other.weight_diffs [index];
-            bias_diffs [index] -= other.bias_diffs [index];
-        }
+        flat() -= other.flat();
+
         return *this;
     }
 
     NeuralNetwork::NeuralNetworkDiff&
         NeuralNetwork::NeuralNetworkDiff::operator*=(float scalar) noexcept {
-        for (std::size_t index {0}; index < layer_sizes.size() - 1; index++) {
-            weight_diffs [index] *= scalar;
-            bias_diffs [index] *= scalar;
-        }
+        flat() *= scalar;
+
         return *this;
     }
 
     NeuralNetwork::NeuralNetworkDiff& NeuralNetwork::NeuralNetworkDiff::operator/=(float scalar) {
-        for (std::size_t index {0}; index < layer_sizes.size() - 1; index++) {
-            weight_diffs [index] /= scalar;
-            bias_diffs [index] /= scalar;
-        }
+        flat() /= scalar;
+
         return *this;
     }
 
     NeuralNetwork::NeuralNetworkDiff NeuralNetwork::NeuralNetworkDiff::operator+(
-        const NeuralNetwork::NeuralNetworkDiff& other) const noexcept {
+        const NeuralNetwork::NeuralNetworkDiff& other) const {
         NeuralNetwork::NeuralNetworkDiff copy_of_this {*this};
 
         copy_of_this += other;
@@ -63,7 +94,7 @@ namespace efuzz {
     }
 
     NeuralNetwork::NeuralNetworkDiff NeuralNetwork::NeuralNetworkDiff::operator-(
-        const NeuralNetwork::NeuralNetworkDiff& other) const noexcept {
+        const NeuralNetwork::NeuralNetworkDiff& other) const {
         NeuralNetwork::NeuralNetworkDiff copy_of_this {*this};
 
         copy_of_this -= other;
@@ -72,7 +103,7 @@ namespace efuzz {
     }
 
     NeuralNetwork::NeuralNetworkDiff
-        NeuralNetwork::NeuralNetworkDiff::operator*(float scalar) const noexcept {
+        NeuralNetwork::NeuralNetworkDiff::operator*(float scalar) const {
         NeuralNetwork::NeuralNetworkDiff copy_of_this {*this};
 
         copy_of_this *= scalar;
@@ -93,9 +124,27 @@ namespace efuzz {
         *this *= -1;
     }
 
-    NeuralNetwork::NeuralNetworkDiff NeuralNetwork::NeuralNetworkDiff::inverted() const noexcept {
+    NeuralNetwork::NeuralNetworkDiff NeuralNetwork::NeuralNetworkDiff::inverted() const {
         return *this * -1;
     }
+
+    Eigen::Map<Eigen::VectorXf, Eigen::AlignedMax>
+        NeuralNetwork::NeuralNetworkDiff::flat() noexcept {
+        return {_parameters.data(), static_cast<Eigen::Index>(_parameters.size())};
+    }
+
+    Eigen::Map<const Eigen::VectorXf, Eigen::AlignedMax>
+        NeuralNetwork::NeuralNetworkDiff::flat() const noexcept {
+        return {_parameters.data(), static_cast<Eigen::Index>(_parameters.size())};
+    }
+
+    void NeuralNetwork::NeuralNetworkDiff::mask_pruned_weights(
+        const NeuralNetwork& network) noexcept {
+        for (std::size_t index {0}; index < weight_diffs.size(); index++) {
+            weight_diffs [index] =
+                (network.weights [index].array() == 0.0F).select(0.0F, weight_diffs [index]);
+        }
+    }
 } // namespace lc
 
 // Print neural network diff
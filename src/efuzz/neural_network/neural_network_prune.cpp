@@ -0,0 +1,127 @@
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+#include <Eigen/Eigen>
+
+#include <efuzz/neural_network/neural_network.hpp>
+
+namespace efuzz {
+    std::size_t NeuralNetwork::prune_weights(float fraction) {
+        std::vector<float> magnitudes;
+
+        for (const auto& weight: weights) {
+            for (Eigen::Index index {0}; index < weight.size(); ++index) {
+                magnitudes.push_back(std::abs(weight.data() [index]));
+            }
+        }
+
+        const auto prune_count =
+            static_cast<std::size_t>(std::clamp(fraction, 0.0F, 1.0F) * magnitudes.size());
+
+        if (prune_count == 0) {
+            return 0;
+        }
+
+        std::nth_element(magnitudes.begin(), magnitudes.begin() + (prune_count - 1),
+                         magnitudes.end());
+
+        const float threshold = magnitudes [prune_count - 1];
+        std::size_t pruned {};
+
+        for (auto& weight: weights) {
+            for (Eigen::Index index {0}; index < weight.size(); ++index) {
+                float& value = weight.data() [index];
+
+                if (value != 0.0F && std::abs(value) <= threshold) {
+                    value = 0.0F;
+                    ++pruned;
+                }
+            }
+        }
+
+        return pruned;
+    }
+
+    std::size_t NeuralNetwork::prune_neurons(float fraction) {
+        std::size_t removed {};
+        // Layers shrink, so they are pruned as separate matrices and moved into a new buffer
+        std::vector<Eigen::MatrixXf> pruned_weights(weights.begin(), weights.end());
+        std::vector<Eigen::VectorXf> pruned_biases(biases.begin(), biases.end());
+
+        // Only hidden layers; the input and output widths are fixed by the encoder.
+        for (std::size_t layer {1}; layer + 1 < layer_sizes.size(); ++layer) {
+            Eigen::MatrixXf& incoming = pruned_weights [layer - 1];
+            Eigen::VectorXf& incoming_biases = pruned_biases [layer - 1];
+            Eigen::MatrixXf& outgoing = pruned_weights [layer];
+            Eigen::VectorXf& outgoing_biases = pruned_biases [layer];
+
+            const std::size_t neuron_count = layer_sizes [layer];
+            const std::size_t remove_count = std::min(
+                static_cast<std::size_t>(std::clamp(fraction, 0.0F, 1.0F) * neuron_count),
+                neuron_count - 1);
+
+            if (remove_count == 0) {
+                continue;
+            }
+
+            // A neuron matters in proportion to how much its activation varies (incoming weights)
+            // times how far that variation is carried (outgoing weights).
+            std::vector<float> scores(neuron_count);
+
+            for (std::size_t neuron {0}; neuron < neuron_count; ++neuron) {
+                scores [neuron] = incoming.row(neuron).norm() * outgoing.col(neuron).norm();
+            }
+
+            std::vector<std::size_t> order(neuron_count);
+            std::iota(order.begin(), order.end(), 0);
+            std::sort(order.begin(), order.end(), [&scores](std::size_t lhs, std::size_t rhs) {
+                return scores [lhs] < scores [rhs];
+            });
+
+            std::vector<std::size_t> kept(order.begin() + remove_count, order.end());
+            std::sort(kept.begin(), kept.end());
+
+            for (auto neuron = order.begin(); neuron != order.begin() + remove_count; ++neuron) {
+                outgoing_biases += outgoing.col(*neuron) * sigmoid_abs(incoming_biases(*neuron));
+            }
+
+            Eigen::MatrixXf new_incoming(kept.size(), incoming.cols());
+            Eigen::VectorXf new_incoming_biases(kept.size());
+            Eigen::MatrixXf new_outgoing(outgoing.rows(), kept.size());
+
+            for (std::size_t index {0}; index < kept.size(); ++index) {
+                new_incoming.row(index) = incoming.row(kept [index]);
+                new_incoming_biases(index) = incoming_biases(kept [index]);
+                new_outgoing.col(index) = outgoing.col(kept [index]);
+            }
+
+            incoming = std::move(new_incoming);
+            incoming_biases = std::move(new_incoming_biases);
+            outgoing = std::move(new_outgoing);
+            layer_sizes [layer] = kept.size();
+            removed += remove_count;
+        }
+
+        if (removed > 0) {
+            allocate_parameters(layer_sizes, _parameters, weights, biases);
+            copy_layers(pruned_weights, pruned_biases, weights, biases);
+            most_recent_diff = NeuralNetworkDiff(layer_sizes);
+        }
+
+        return removed;
+    }
+
+    float NeuralNetwork::weight_density() const noexcept {
+        std::size_t total {};
+        std::size_t non_zero {};
+
+        for (const auto& weight: weights) {
+            total += weight.size();
+            non_zero += (weight.array() != 0.0F).count();
+        }
+
+        return total == 0 ? 1.0F : static_cast<float>(non_zero) / static_cast<float>(total);
+    }
+} // namespace efuzz
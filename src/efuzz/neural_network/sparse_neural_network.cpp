@@ -0,0 +1,99 @@
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include <efuzz/neural_network/sparse_neural_network.hpp>
+
+namespace efuzz {
+    SparseNeuralNetwork::SparseNeuralNetwork(const NeuralNetwork& network) :
+        layer_sizes(network.layer_sizes), biases(network.biases.begin(), network.biases.end()) {
+        for (const auto& weight: network.weights) {
+            SparseMatrixT sparse_weight = weight.sparseView(0.0F, 0.0F);
+
+            sparse_weight.makeCompressed();
+            weights.push_back(std::move(sparse_weight));
+        }
+    }
+
+    Eigen::VectorXf SparseNeuralNetwork::compute(const Eigen::VectorXf& input) const {
+        if (weights.empty()) {
+            return input;
+        }
+
+        Eigen::VectorXf output(layer_sizes.back());
+
+        compute_into(input.data(), output.data());
+
+        return output;
+    }
+
+    void SparseNeuralNetwork::compute_into(const float* input, float* output) const {
+        if (weights.empty()) {
+            std::copy_n(input, layer_sizes.empty() ? 0 : layer_sizes.front(), output);
+
+            return;
+        }
+
+        thread_local std::array<std::vector<float>, 2> buffers;
+
+        const float* layer_input = input;
+
+        for (std::size_t index {0}; index < weights.size(); ++index) {
+            const SparseMatrixT& weight = weights [index];
+            const float* bias = biases [index].data();
+            const auto* row_starts = weight.outerIndexPtr();
+            const auto* columns = weight.innerIndexPtr();
+            const float* values = weight.valuePtr();
+            float* layer_output = output;
+
+            if (index + 1 < weights.size()) {
+                auto& buffer = buffers [index % 2];
+
+                if (buffer.size() < static_cast<std::size_t>(weight.rows())) {
+                    buffer.resize(weight.rows());
+                }
+
+                layer_output = buffer.data();
+            }
+
+            for (Eigen::Index row {0}; row < weight.rows(); ++row) {
+                float accumulator = bias [row];
+
+                for (auto entry = row_starts [row]; entry < row_starts [row + 1]; ++entry) {
+                    accumulator += values [entry] * layer_input [columns [entry]];
+                }
+
+                layer_output [row] = NeuralNetwork::sigmoid_abs(accumulator);
+            }
+
+            layer_input = layer_output;
+        }
+    }
+
+    Eigen::MatrixXf SparseNeuralNetwork::compute_batch(const Eigen::MatrixXf& inputs) const {
+        Eigen::MatrixXf activations = inputs;
+
+        for (std::size_t index {0}; index < weights.size(); ++index) {
+            Eigen::MatrixXf layer_output = weights [index] * activations;
+
+            layer_output.colwise() += biases [index];
+            activations = layer_output.unaryExpr(&NeuralNetwork::sigmoid_abs);
+        }
+
+        return activations;
+    }
+
+    std::size_t SparseNeuralNetwork::non_zero_count() const noexcept {
+        std::size_t count {};
+
+        for (const auto& weight: weights) {
+            count += weight.nonZeros();
+        }
+
+        return count;
+    }
+
+    bool SparseNeuralNetwork::is_worthwhile(const NeuralNetwork& network) noexcept {
+        return !network.weights.empty() && network.weight_density() <= DENSITY_THRESHOLD;
+    }
+} // namespace efuzz
@@ -0,0 +1,45 @@
+#ifndef EFUZZ_SPARSE_NEURAL_NETWORK_HPP
+#define EFUZZ_SPARSE_NEURAL_NETWORK_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+
+#include <efuzz/neural_network/neural_network.hpp>
+
+namespace efuzz {
+    // Inference-only copy of a pruned NeuralNetwork with its weights in compressed row storage.
+    class SparseNeuralNetwork {
+        public:
+
+        using SparseMatrixT = Eigen::SparseMatrix<float, Eigen::RowMajor>;
+
+        // Below this weight density the sparse product beats the dense kernel.
+        constexpr static float DENSITY_THRESHOLD {0.35F};
+
+        std::vector<std::size_t> layer_sizes;
+        std::vector<SparseMatrixT> weights;
+        std::vector<Eigen::VectorXf> biases;
+
+        SparseNeuralNetwork() = default;
+        SparseNeuralNetwork(SparseNeuralNetwork&& other) noexcept = default;
+        SparseNeuralNetwork(const SparseNeuralNetwork& other) = default;
+
+        SparseNeuralNetwork& operator=(SparseNeuralNetwork&& other) noexcept = default;
+        SparseNeuralNetwork& operator=(const SparseNeuralNetwork& other) = default;
+
+        explicit SparseNeuralNetwork(const NeuralNetwork& network);
+
+        [[nodiscard]] Eigen::VectorXf compute(const Eigen::VectorXf& input) const;
+        void compute_into(const float* input, float* output) const;
+        // One input per column, like NeuralNetwork::compute_batch
+        [[nodiscard]] Eigen::MatrixXf compute_batch(const Eigen::MatrixXf& inputs) const;
+        [[nodiscard]] std::size_t non_zero_count() const noexcept;
+
+        [[nodiscard]] static bool is_worthwhile(const NeuralNetwork& network) noexcept;
+    };
+} // namespace efuzz
+
+#endif // EFUZZ_SPARSE_NEURAL_NETWORK_HPP
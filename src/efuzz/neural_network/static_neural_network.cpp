@@ -0,0 +1,130 @@
+#include <cctype>
+#include <cmath>
+#include <fstream>
+#include <ios>
+#include <locale>
+#include <sstream>
+#include <stdexcept>
+
+#include <efuzz/neural_network/static_neural_network.hpp>
+
+namespace efuzz {
+    namespace {
+        constexpr std::size_t VALUES_PER_LINE {4};
+
+        void write_array(std::ostream& stream, const std::string& name, const float* values,
+                         std::size_t size) {
+            stream << "    alignas(64) inline constexpr float " << name << " [" << size << "] {";
+
+            for (std::size_t index {0}; index < size; ++index) {
+                if (!std::isfinite(values [index])) {
+                    throw std::runtime_error(
+                        "Cannot export a network with non-finite parameters");
+                }
+
+                stream << (index % VALUES_PER_LINE == 0 ? "\n        " : " ") << values [index]
+                       << 'F' << (index + 1 < size ? "," : "");
+            }
+
+            stream << "};\n\n";
+        }
+
+        std::string layer_array_name(std::size_t layer, const char* kind) {
+            return "layer_" + std::to_string(layer) + "_" + kind;
+        }
+    } // namespace
+
+    void write_static_neural_network(std::ostream& stream, const NeuralNetwork& network,
+                                     std::string_view namespace_name) {
+        const std::string guard = static_header_guard(namespace_name);
+
+        stream << "// Generated by efuzz::write_static_neural_network. Do not edit.\n"
+               << "#ifndef " << guard << "\n#define " << guard << "\n\n"
+               << "#include <efuzz/neural_network/static_neural_network.hpp>\n\n"
+               << "namespace " << namespace_name << " {\n";
+        write_static_neural_network_definitions(stream, network);
+        stream << "} // namespace " << namespace_name << "\n\n#endif // " << guard << '\n';
+    }
+
+    void write_static_neural_network(const std::filesystem::path& filepath,
+                                     const NeuralNetwork& network,
+                                     std::string_view namespace_name) {
+        std::ofstream file {filepath};
+
+        write_static_neural_network(file, network, namespace_name);
+
+        if (!file) {
+            throw std::runtime_error("Failed to write " + filepath.string());
+        }
+    }
+
+    void write_static_neural_network_definitions(std::ostream& stream,
+                                                 const NeuralNetwork& network) {
+        const std::size_t layer_count = network.weights.size();
+
+        if (layer_count == 0 || network.layer_sizes.size() != layer_count + 1 ||
+            network.biases.size() != layer_count) {
+            throw std::runtime_error("Cannot export an empty or inconsistent network");
+        }
+
+        std::ostringstream definitions;
+
+        definitions.imbue(std::locale::classic());
+        definitions << std::hexfloat;
+
+        for (std::size_t layer {0}; layer < layer_count; ++layer) {
+            const auto& weights = network.weights [layer];
+            const auto& biases = network.biases [layer];
+
+            if (static_cast<std::size_t>(weights.rows()) != network.layer_sizes [layer + 1] ||
+                static_cast<std::size_t>(weights.cols()) != network.layer_sizes [layer] ||
+                biases.size() != weights.rows()) {
+                throw std::runtime_error("Network layer sizes do not match its weights");
+            }
+
+            write_array(definitions, layer_array_name(layer, "weights"), weights.data(),
+                        static_cast<std::size_t>(weights.size()));
+            write_array(definitions, layer_array_name(layer, "biases"), biases.data(),
+                        static_cast<std::size_t>(biases.size()));
+        }
+
+        definitions << "    inline constexpr efuzz::StaticNeuralNetwork<";
+
+        for (std::size_t layer {0}; layer < network.layer_sizes.size(); ++layer) {
+            definitions << (layer > 0 ? ", " : "") << network.layer_sizes [layer];
+        }
+
+        definitions << "> network {\n        {";
+
+        for (std::size_t layer {0}; layer < layer_count; ++layer) {
+            definitions << (layer > 0 ? ", " : "") << layer_array_name(layer, "weights");
+        }
+
+        definitions << "},\n        {";
+
+        for (std::size_t layer {0}; layer < layer_count; ++layer) {
+            definitions << (layer > 0 ? ", " : "") << layer_array_name(layer, "biases");
+        }
+
+        definitions << "}};\n";
+        stream << definitions.str();
+    }
+
+    std::string static_header_guard(std::string_view namespace_name) {
+        std::string guard;
+
+        for (const char character: namespace_name) {
+            const auto byte = static_cast<unsigned char>(character);
+
+            guard += std::isalnum(byte) != 0 ? static_cast<char>(std::toupper(byte)) : '_';
+        }
+
+        // "a::b" becomes A__B; collapse the doubled separator
+        for (std::size_t position = guard.find("__"); position != std::string::npos;
+             position = guard.find("__", position)) {
+            guard.erase(position, 1);
+        }
+
+        return guard + "_HPP";
+    }
+} // namespace efuzz
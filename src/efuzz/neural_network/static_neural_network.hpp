@@ -0,0 +1,79 @@
+#ifndef EFUZZ_STATIC_NEURAL_NETWORK_HPP
+#define EFUZZ_STATIC_NEURAL_NETWORK_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <filesystem>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#include <efuzz/neural_network/layer_kernel.hpp>
+#include <efuzz/neural_network/neural_network.hpp>
+
+namespace efuzz {
+    // Inference-only network with its topology fixed at compile time, evaluated straight from
+    // weight arrays it does not own. Paired with write_static_neural_network, a trained network
+    // can be compiled into a binary as constexpr data and used without loading anything.
+    template <std::size_t... layer_sizes_>
+    class StaticNeuralNetwork {
+        public:
+
+        static_assert(sizeof...(layer_sizes_) >= 2, "A network needs an input and output layer");
+
+        constexpr static std::array<std::size_t, sizeof...(layer_sizes_)> layer_sizes {
+            layer_sizes_...};
+        constexpr static std::size_t layer_count {layer_sizes.size() - 1};
+        constexpr static std::size_t input_size {layer_sizes.front()};
+        constexpr static std::size_t output_size {layer_sizes.back()};
+        constexpr static std::size_t max_layer_size {std::max({layer_sizes_...})};
+
+        // Weights of every layer are column-major, `layer_sizes [n + 1]` rows by
+        // `layer_sizes [n]` columns, like NeuralNetwork::weights.
+        constexpr StaticNeuralNetwork(std::array<const float*, layer_count> weights,
+                                      std::array<const float*, layer_count> biases) noexcept :
+            _weights(weights),
+            _biases(biases) {
+        }
+
+        // Writes output_size floats to `output`, which may alias `input`.
+        void compute_into(const float* input, float* output) const noexcept {
+            const LayerKernel kernel = layer_kernel();
+            std::array<std::array<float, max_layer_size>, 2> buffers;
+            const float* layer_input = input;
+
+            for (std::size_t layer {0}; layer < layer_count; ++layer) {
+                float* layer_output = buffers [layer % 2].data();
+
+                kernel(_weights [layer], _biases [layer], layer_input, layer_output,
+                       layer_sizes [layer + 1], layer_sizes [layer]);
+                layer_input = layer_output;
+            }
+
+            std::copy_n(layer_input, output_size, output);
+        }
+
+        private:
+
+        std::array<const float*, layer_count> _weights;
+        std::array<const float*, layer_count> _biases;
+    };
+
+    // Writes `network` as a C++ header: one alignas(64) constexpr array per weight matrix and
+    // bias vector, and a constexpr StaticNeuralNetwork named `network` over them, all inside
+    // `namespace_name`. Floats are printed in hexadecimal so they round-trip exactly.
+    void write_static_neural_network(std::ostream& stream, const NeuralNetwork& network,
+                                     std::string_view namespace_name);
+    void write_static_neural_network(const std::filesystem::path& filepath,
+                                     const NeuralNetwork& network,
+                                     std::string_view namespace_name);
+    // Only the arrays and the `network` definition, for generators that write the rest of the
+    // header themselves.
+    void write_static_neural_network_definitions(std::ostream& stream,
+                                                 const NeuralNetwork& network);
+    // Include guard macro for a generated header, derived from its namespace.
+    [[nodiscard]] std::string static_header_guard(std::string_view namespace_name);
+} // namespace efuzz
+
+#endif // EFUZZ_STATIC_NEURAL_NETWORK_HPP
@@ -0,0 +1,300 @@
+#ifndef EFUZZ_NGRAM_ENCODE_HPP
+#define EFUZZ_NGRAM_ENCODE_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <cereal/cereal.hpp>
+#include <Eigen/Core>
+
+#include <efuzz/encode.hpp>
+#include <efuzz/neural_network/neural_network.hpp>
+
+namespace efuzz {
+    // Non-recurrent alternative to Encoder with the same interface, so it can be used as the
+    // EncoderPolicy_ of EncoderTrainer and SearchContainer. Every character n-gram (up to
+    // MAX_NGRAM_LENGTH, with the word boundaries as extra symbols) is hashed into one of
+    // feature_count buckets, and the bucket counts are projected by a trainable NeuralNetwork.
+    // No position depends on another, so the cost is one pass of hashing plus a sum of weight
+    // columns instead of one network evaluation per letter.
+    template <StdString StringT_,
+              IntegralConstant encoding_result_size_ = std::integral_constant<int, -1>>
+    class NGramEncoder {
+        public:
+
+        using StringT = StringT_;
+        static constexpr std::integral auto encoding_result_size = encoding_result_size_::value;
+        using char_type = typename StringT::value_type;
+        using string_view_type = std::basic_string_view<char_type>;
+        using this_type = NGramEncoder<StringT, encoding_result_size_>;
+        // True for a fixed encoding size, like Encoder::encoding_result_size_is_dynamic
+        using encoding_result_size_is_dynamic =
+            std::bool_constant<std::greater()(encoding_result_size, 0)>;
+        using encoding_result_type =
+            std::conditional_t<encoding_result_size_is_dynamic::value,
+                               Eigen::Vector<float, encoding_result_size>, Eigen::VectorXf>;
+
+        constexpr static std::size_t DEFAULT_FEATURE_COUNT {1024};
+        constexpr static std::size_t MAX_NGRAM_LENGTH {3};
+
+        NGramEncoder() = default;
+        NGramEncoder(const NGramEncoder&) = default;
+        NGramEncoder(NGramEncoder&&) = default;
+        this_type& operator=(const this_type&) = default;
+        this_type& operator=(this_type&&) = default;
+
+        explicit NGramEncoder(std::size_t feature_count);
+
+        template <typename Archive>
+        void serialize(Archive& archive) {
+            archive(_feature_count, _word_vector_encoder_nn);
+        }
+
+        [[nodiscard]] encoding_result_type encode(string_view_type word) const;
+        // Same encodings as encode(), one column per word; the layers after the first are
+        // evaluated for all words with one matrix product each. Takes strings or views.
+        template <typename WordT>
+        [[nodiscard]] Eigen::MatrixXf encode_batch(const std::vector<WordT>& words) const
+            requires std::convertible_to<const WordT&, string_view_type>;
+        // Appends the bucket of every n-gram of `word`, repeats included.
+        void hash_ngrams(string_view_type word, std::vector<std::uint32_t>& buckets) const;
+
+        this_type& set_word_vector_encoder_nn(const NeuralNetwork& neural_network);
+        this_type& modify_word_vector_encoder_nn(const NeuralNetwork::NeuralNetworkDiff& diff);
+        // Takes parameters saved with get_word_vector_encoder_nn().copy_parameters_to(), so a
+        // trial modification can be undone without copying the whole network.
+        this_type& restore_word_vector_encoder_nn_parameters(
+            const NeuralNetwork::ParameterBuffer& snapshot);
+        [[nodiscard]] const NeuralNetwork& get_word_vector_encoder_nn() const;
+        this_type& set_encoding_nn_layer_sizes(const std::vector<std::size_t>& layer_sizes,
+                                               bool random = true);
+        // Like Encoder::set_encoding_result_size; drops the network.
+        this_type& set_encoding_result_size(std::size_t size)
+            requires(!encoding_result_size_is_dynamic::value);
+
+        [[nodiscard]] std::size_t get_feature_count() const;
+        [[nodiscard]] std::size_t get_nn_input_size() const;
+        [[nodiscard]] std::size_t get_nn_output_size() const;
+        [[nodiscard]] float output_norm_max() const;
+
+        private:
+
+        // Sums the first layer weight columns of the n-gram buckets of `word` into `activations`
+        // and applies the bias and activation, giving the input of the second layer.
+        void first_layer_into(string_view_type word, float* activations) const;
+
+        std::size_t _feature_count {DEFAULT_FEATURE_COUNT};
+        NeuralNetwork _word_vector_encoder_nn;
+        std::optional<std::size_t> _encoding_result_size;
+    };
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_>
+    NGramEncoder<StringT_, encoding_result_size_>::NGramEncoder(std::size_t feature_count) :
+        _feature_count(feature_count) {
+        if (_feature_count == 0) {
+            throw std::runtime_error("An n-gram encoder needs at least one feature");
+        }
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_>
+    auto NGramEncoder<StringT_, encoding_result_size_>::encode(string_view_type word) const
+        -> encoding_result_type {
+        if (_word_vector_encoder_nn.weights.empty()) {
+            throw std::runtime_error("Word vector encoder neural network not set");
+        }
+
+        thread_local Eigen::VectorXf activations;
+        encoding_result_type encoding_result;
+
+        if constexpr (!encoding_result_size_is_dynamic::value) {
+            encoding_result.resize(_word_vector_encoder_nn.layer_sizes.back());
+        }
+
+        activations.resize(_word_vector_encoder_nn.weights.front().rows());
+        first_layer_into(word, activations.data());
+        _word_vector_encoder_nn.compute_into(activations.data(), encoding_result.data(), 1);
+
+        return encoding_result;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_>
+    template <typename WordT>
+    auto NGramEncoder<StringT_, encoding_result_size_>::encode_batch(
+        const std::vector<WordT>& words) const -> Eigen::MatrixXf
+        requires std::convertible_to<const WordT&, string_view_type> {
+        if (_word_vector_encoder_nn.weights.empty()) {
+            throw std::runtime_error("Word vector encoder neural network not set");
+        }
+
+        Eigen::MatrixXf activations(_word_vector_encoder_nn.weights.front().rows(),
+                                    static_cast<Eigen::Index>(words.size()));
+
+        for (std::size_t index {0}; index < words.size(); ++index) {
+            first_layer_into(words [index],
+                             activations.col(static_cast<Eigen::Index>(index)).data());
+        }
+
+        return _word_vector_encoder_nn.compute_batch(activations, 1);
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_>
+    void NGramEncoder<StringT_, encoding_result_size_>::hash_ngrams(
+        string_view_type word, std::vector<std::uint32_t>& buckets) const {
+        constexpr std::uint32_t FNV_OFFSET_BASIS {2166136261U};
+        constexpr std::uint32_t FNV_PRIME {16777619U};
+
+        // Position 0 and size + 1 are the word boundaries; letters are shifted up by one so
+        // the boundary symbol cannot collide with a letter. Letters go through the unsigned
+        // type, so a saved encoder hashes the same whether char is signed or not.
+        const std::size_t padded_size = word.size() + 2;
+        const auto symbol = [&word, padded_size](std::size_t position) -> std::uint32_t {
+            return position == 0 || position + 1 == padded_size
+                       ? 0U
+                       : static_cast<std::uint32_t>(
+                             static_cast<std::make_unsigned_t<char_type>>(word [position - 1])) +
+                             1U;
+        };
+
+        for (std::size_t length {1}; length <= MAX_NGRAM_LENGTH && length <= padded_size;
+             ++length) {
+            // A lone boundary symbol carries no information
+            const std::size_t first = length == 1 ? 1 : 0;
+            const std::size_t end = length == 1 ? padded_size - 1 : padded_size - length + 1;
+
+            for (std::size_t position {first}; position < end; ++position) {
+                std::uint32_t hash =
+                    (FNV_OFFSET_BASIS ^ static_cast<std::uint32_t>(length)) * FNV_PRIME;
+
+                for (std::size_t offset {0}; offset < length; ++offset) {
+                    hash = (hash ^ symbol(position + offset)) * FNV_PRIME;
+                }
+
+                buckets.push_back(hash % static_cast<std::uint32_t>(_feature_count));
+            }
+        }
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_>
+    void NGramEncoder<StringT_, encoding_result_size_>::first_layer_into(
+        string_view_type word, float* activations) const {
+        thread_local std::vector<std::uint32_t> buckets;
+
+        buckets.clear();
+        hash_ngrams(word, buckets);
+
+        const NeuralNetwork::WeightMap& weights = _word_vector_encoder_nn.weights.front();
+        Eigen::Map<Eigen::VectorXf> output(activations, weights.rows());
+
+        output.setZero();
+
+        for (const std::uint32_t bucket: buckets) {
+            output += weights.col(bucket);
+        }
+
+        // Scaled so long strings do not saturate the first layer
+        const float scale =
+            1.0F / std::sqrt(static_cast<float>(std::max<std::size_t>(1, buckets.size())));
+
+        output = (output * scale + _word_vector_encoder_nn.biases.front())
+                     .unaryExpr(&NeuralNetwork::sigmoid_abs);
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_>
+    auto NGramEncoder<StringT_, encoding_result_size_>::set_word_vector_encoder_nn(
+        const NeuralNetwork& neural_network) -> this_type& {
+        if (neural_network.layer_sizes.empty() ||
+            neural_network.layer_sizes.front() != _feature_count) {
+            throw std::runtime_error("Network input size must equal the n-gram feature count");
+        }
+
+        _word_vector_encoder_nn = neural_network;
+
+        return *this;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_>
+    auto NGramEncoder<StringT_, encoding_result_size_>::modify_word_vector_encoder_nn(
+        const NeuralNetwork::NeuralNetworkDiff& diff) -> this_type& {
+        _word_vector_encoder_nn.modify(diff);
+
+        return *this;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_>
+    auto NGramEncoder<StringT_, encoding_result_size_>::restore_word_vector_encoder_nn_parameters(
+        const NeuralNetwork::ParameterBuffer& snapshot) -> this_type& {
+        _word_vector_encoder_nn.copy_parameters_from(snapshot);
+
+        return *this;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_>
+    auto NGramEncoder<StringT_, encoding_result_size_>::get_word_vector_encoder_nn() const
+        -> const NeuralNetwork& {
+        return _word_vector_encoder_nn;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_>
+    auto NGramEncoder<StringT_, encoding_result_size_>::set_encoding_nn_layer_sizes(
+        const std::vector<std::size_t>& layer_sizes, bool random) -> this_type& {
+        assert(layer_sizes.size() >= 2);
+        assert(layer_sizes.front() == get_nn_input_size());
+        assert(layer_sizes.back() == get_nn_output_size());
+
+        _word_vector_encoder_nn = NeuralNetwork(layer_sizes, random);
+
+        return *this;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_>
+    auto NGramEncoder<StringT_, encoding_result_size_>::set_encoding_result_size(std::size_t size)
+        -> this_type& requires(!encoding_result_size_is_dynamic::value) {
+        _encoding_result_size = size;
+        _word_vector_encoder_nn = NeuralNetwork();
+
+        return *this;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_>
+    auto NGramEncoder<StringT_, encoding_result_size_>::get_feature_count() const -> std::size_t {
+        return _feature_count;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_>
+    auto NGramEncoder<StringT_, encoding_result_size_>::get_nn_input_size() const -> std::size_t {
+        return _feature_count;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_>
+    auto NGramEncoder<StringT_, encoding_result_size_>::get_nn_output_size() const
+        -> std::size_t {
+        if constexpr (encoding_result_size_is_dynamic::value) {
+            return encoding_result_size;
+        }
+        else {
+            if (_encoding_result_size.has_value()) {
+                return _encoding_result_size.value();
+            }
+
+            assert(!_word_vector_encoder_nn.layer_sizes.empty());
+
+            return _word_vector_encoder_nn.layer_sizes.back();
+        }
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_>
+    auto NGramEncoder<StringT_, encoding_result_size_>::output_norm_max() const -> float {
+        return std::sqrt(static_cast<float>(get_nn_output_size()));
+    }
+} // namespace efuzz
+
+#endif // EFUZZ_NGRAM_ENCODE_HPP
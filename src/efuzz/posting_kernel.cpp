@@ -0,0 +1,259 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+#include <efuzz/posting_kernel.hpp>
+
+#if EFUZZ_POSTING_KERNEL_X86
+ #include <immintrin.h>
+#endif
+
+namespace efuzz {
+    namespace {
+        constexpr std::size_t GROUP_SIZE {4};
+        constexpr std::uint32_t LENGTH_BITS {2};
+        constexpr std::uint32_t LENGTH_MASK {3};
+
+        // Bytes taken by the group a control byte describes.
+        constexpr std::array<std::uint8_t, 256> GROUP_LENGTHS = [] {
+            std::array<std::uint8_t, 256> lengths {};
+
+            for (std::uint32_t control {0}; control < lengths.size(); ++control) {
+                for (std::uint32_t value {0}; value < GROUP_SIZE; ++value) {
+                    lengths [control] += ((control >> (LENGTH_BITS * value)) & LENGTH_MASK) + 1;
+                }
+            }
+
+            return lengths;
+        }();
+
+        // Decodes values first to count of a stream from data, starting at offset, continuing
+        // the running sum from previous.
+        inline void decode_scalar(const std::uint8_t* control, const std::uint8_t* data,
+                                  std::size_t offset, std::size_t first, std::size_t count,
+                                  bool delta, std::uint32_t previous,
+                                  std::uint32_t* output) noexcept {
+            for (std::size_t index {first}; index < count; ++index) {
+                const std::uint32_t length =
+                    ((control [index / GROUP_SIZE] >> (LENGTH_BITS * (index % GROUP_SIZE))) &
+                     LENGTH_MASK) +
+                    1;
+                std::uint32_t value {};
+
+                for (std::uint32_t byte {0}; byte < length; ++byte) {
+                    value |= static_cast<std::uint32_t>(data [offset + byte]) << (8 * byte);
+                }
+
+                offset += length;
+                previous = delta ? previous + value : value;
+                output [index] = previous;
+            }
+        }
+    } // namespace
+
+    void stream_vbyte_append(StreamVByte& stream, std::size_t count, std::uint32_t value) {
+        const std::uint32_t length =
+            value < (1U << 8) ? 1 : (value < (1U << 16) ? 2 : (value < (1U << 24) ? 3 : 4));
+
+        if (count % GROUP_SIZE == 0) {
+            stream.control.push_back(0);
+        }
+
+        stream.control.back() |=
+            static_cast<std::uint8_t>((length - 1) << (LENGTH_BITS * (count % GROUP_SIZE)));
+
+        for (std::uint32_t byte {0}; byte < length; ++byte) {
+            stream.data.push_back(static_cast<std::uint8_t>(value >> (8 * byte)));
+        }
+    }
+
+    void stream_vbyte_truncate(StreamVByte& stream, std::size_t count,
+                               std::size_t data_size) noexcept {
+        stream.control.resize((count + GROUP_SIZE - 1) / GROUP_SIZE);
+
+        // The lengths of the dropped values of the last group
+        if (count % GROUP_SIZE != 0) {
+            stream.control.back() &=
+                static_cast<std::uint8_t>((1U << (LENGTH_BITS * (count % GROUP_SIZE))) - 1);
+        }
+
+        stream.data.resize(data_size);
+    }
+
+    void posting_decode_portable(const std::uint8_t* control, const std::uint8_t* data,
+                                 std::size_t /* data_size */, std::size_t count, bool delta,
+                                 std::uint32_t* output) noexcept {
+        decode_scalar(control, data, 0, 0, count, delta, 0, output);
+    }
+
+    std::size_t posting_filter_portable(const std::uint32_t* ids, const std::uint32_t* positions,
+                                        std::size_t count, std::uint32_t low, std::uint32_t high,
+                                        std::uint32_t* matched) noexcept {
+        std::size_t matched_count {0};
+
+        // Branch-free: every id is written, and only kept ones advance the output
+        for (std::size_t index {0}; index < count; ++index) {
+            matched [matched_count] = ids [index];
+            matched_count += static_cast<std::size_t>(positions [index] - low <= high - low);
+        }
+
+        return matched_count;
+    }
+
+#if EFUZZ_POSTING_KERNEL_X86
+    namespace {
+        // pshufb pattern moving a group's bytes into four 32-bit lanes, zeroing the rest
+        constexpr std::array<std::array<std::uint8_t, 16>, 256> GROUP_SHUFFLES = [] {
+            std::array<std::array<std::uint8_t, 16>, 256> shuffles {};
+
+            for (std::uint32_t control {0}; control < shuffles.size(); ++control) {
+                std::uint8_t source {0};
+
+                for (std::uint32_t value {0}; value < GROUP_SIZE; ++value) {
+                    const std::uint32_t length =
+                        ((control >> (LENGTH_BITS * value)) & LENGTH_MASK) + 1;
+
+                    for (std::uint32_t byte {0}; byte < 4; ++byte) {
+                        shuffles [control][(4 * value) + byte] =
+                            byte < length ? source++ : std::uint8_t {0x80};
+                    }
+                }
+            }
+
+            return shuffles;
+        }();
+
+        // permutevar8x32 pattern moving the lanes set in an 8-bit mask to the front
+        constexpr std::array<std::array<std::uint32_t, 8>, 256> COMPRESS_PERMUTATIONS = [] {
+            std::array<std::array<std::uint32_t, 8>, 256> permutations {};
+
+            for (std::uint32_t mask {0}; mask < permutations.size(); ++mask) {
+                std::uint32_t next {0};
+
+                for (std::uint32_t lane {0}; lane < 8; ++lane) {
+                    if ((mask >> lane) & 1U) {
+                        permutations [mask][next++] = lane;
+                    }
+                }
+            }
+
+            return permutations;
+        }();
+    } // namespace
+
+    __attribute__((target("avx2"))) void
+        posting_decode_avx2(const std::uint8_t* control, const std::uint8_t* data,
+                            std::size_t data_size, std::size_t count, bool delta,
+                            std::uint32_t* output) noexcept {
+        std::size_t offset {0};
+        std::size_t group {0};
+        __m128i previous = _mm_setzero_si128();
+
+        // Whole groups whose 16-byte load stays inside the data; the rest decodes one by one
+        for (; (group + 1) * GROUP_SIZE <= count && offset + 16 <= data_size; ++group) {
+            const std::uint8_t group_control = control [group];
+            const __m128i bytes =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + offset));
+            __m128i values = _mm_shuffle_epi8(
+                bytes, _mm_loadu_si128(reinterpret_cast<const __m128i*>(
+                           GROUP_SHUFFLES [group_control].data())));
+
+            if (delta) {
+                values = _mm_add_epi32(values, _mm_slli_si128(values, 4));
+                values = _mm_add_epi32(values, _mm_slli_si128(values, 8));
+                values = _mm_add_epi32(values, previous);
+                previous = _mm_shuffle_epi32(values, 0xFF);
+            }
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(output + (group * GROUP_SIZE)), values);
+            offset += GROUP_LENGTHS [group_control];
+        }
+
+        decode_scalar(control, data, offset, group * GROUP_SIZE, count, delta,
+                      static_cast<std::uint32_t>(_mm_cvtsi128_si32(previous)), output);
+    }
+
+    __attribute__((target("avx2,popcnt"))) std::size_t
+        posting_filter_avx2(const std::uint32_t* ids, const std::uint32_t* positions,
+                            std::size_t count, std::uint32_t low, std::uint32_t high,
+                            std::uint32_t* matched) noexcept {
+        constexpr std::size_t lanes {8};
+        // In range when position - low, wrapping below low, is at most high - low
+        const __m256i low_vector = _mm256_set1_epi32(static_cast<int>(low));
+        const __m256i width = _mm256_set1_epi32(static_cast<int>(high - low));
+        std::size_t matched_count {0};
+        std::size_t index {0};
+
+        for (; index + lanes <= count; index += lanes) {
+            const __m256i offsets = _mm256_sub_epi32(
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(positions + index)),
+                low_vector);
+            const __m256i kept = _mm256_cmpeq_epi32(_mm256_max_epu32(offsets, width), width);
+            const auto mask =
+                static_cast<std::uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(kept)));
+            const __m256i permutation = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(COMPRESS_PERMUTATIONS [mask].data()));
+
+            _mm256_storeu_si256(
+                reinterpret_cast<__m256i*>(matched + matched_count),
+                _mm256_permutevar8x32_epi32(
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ids + index)),
+                    permutation));
+            matched_count += static_cast<std::size_t>(std::popcount(mask));
+        }
+
+        return matched_count + posting_filter_portable(ids + index, positions + index,
+                                                       count - index, low, high,
+                                                       matched + matched_count);
+    }
+
+    __attribute__((target("avx512f"))) std::size_t
+        posting_filter_avx512(const std::uint32_t* ids, const std::uint32_t* positions,
+                              std::size_t count, std::uint32_t low, std::uint32_t high,
+                              std::uint32_t* matched) noexcept {
+        constexpr std::size_t lanes {16};
+        const __m512i low_vector = _mm512_set1_epi32(static_cast<int>(low));
+        const __m512i width = _mm512_set1_epi32(static_cast<int>(high - low));
+        std::size_t matched_count {0};
+
+        for (std::size_t index {0}; index < count; index += lanes) {
+            const std::size_t remaining = std::min(lanes, count - index);
+            const auto load_mask = static_cast<__mmask16>((1U << remaining) - 1U);
+            const __m512i offsets = _mm512_sub_epi32(
+                _mm512_maskz_loadu_epi32(load_mask, positions + index), low_vector);
+            const __mmask16 kept =
+                _mm512_mask_cmple_epu32_mask(load_mask, offsets, width);
+
+            _mm512_mask_compressstoreu_epi32(matched + matched_count, kept,
+                                             _mm512_maskz_loadu_epi32(load_mask, ids + index));
+            matched_count += static_cast<std::size_t>(std::popcount(static_cast<unsigned>(kept)));
+        }
+
+        return matched_count;
+    }
+#endif
+
+    PostingKernels select_posting_kernels() noexcept {
+#if EFUZZ_POSTING_KERNEL_X86
+        __builtin_cpu_init();
+
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx2")) {
+            return {posting_decode_avx2, posting_filter_avx512, "avx512"};
+        }
+
+        if (__builtin_cpu_supports("avx2")) {
+            return {posting_decode_avx2, posting_filter_avx2, "avx2"};
+        }
+#endif
+
+        return {posting_decode_portable, posting_filter_portable, "portable"};
+    }
+
+    const PostingKernels& posting_kernels() noexcept {
+        static const PostingKernels kernels = select_posting_kernels();
+
+        return kernels;
+    }
+} // namespace efuzz
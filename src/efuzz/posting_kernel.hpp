@@ -0,0 +1,81 @@
+#ifndef EFUZZ_POSTING_KERNEL_HPP
+#define EFUZZ_POSTING_KERNEL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__)) && \
+    !defined(EFUZZ_DISABLE_SIMD_DISPATCH)
+ #define EFUZZ_POSTING_KERNEL_X86 1
+#else
+ #define EFUZZ_POSTING_KERNEL_X86 0
+#endif
+
+namespace efuzz {
+    // Stream VByte posting lists: values in groups of four, one control byte per group holding
+    // each value's byte count minus one in two bits (first value lowest), and the values'
+    // little-endian bytes, without the leading zero bytes, in a separate data stream. A group's
+    // bytes are found from its control byte alone, so a group decodes with one shuffle.
+    struct StreamVByte {
+        std::vector<std::uint8_t> control;
+        std::vector<std::uint8_t> data;
+
+        template <typename Archive>
+        void serialize(Archive& archive) {
+            archive(control, data);
+        }
+    };
+
+    // Appends value as the count-th value of stream.
+    void stream_vbyte_append(StreamVByte& stream, std::size_t count, std::uint32_t value);
+    // Drops the values from the count-th on; data_size is the data stream's size when the stream
+    // held count values.
+    void stream_vbyte_truncate(StreamVByte& stream, std::size_t count,
+                               std::size_t data_size) noexcept;
+
+    // Decodes the count values of a stream into output. With delta, the values are differences
+    // and output gets their running sums from zero.
+    using PostingDecodeKernel = void (*)(const std::uint8_t* control, const std::uint8_t* data,
+                                         std::size_t data_size, std::size_t count, bool delta,
+                                         std::uint32_t* output) noexcept;
+    // Copies ids [i] to matched, in order, for every i < count with low <= positions [i] <=
+    // high, and returns how many it copied. matched must have room for count + 16 values.
+    using PostingFilterKernel = std::size_t (*)(const std::uint32_t* ids,
+                                                const std::uint32_t* positions, std::size_t count,
+                                                std::uint32_t low, std::uint32_t high,
+                                                std::uint32_t* matched) noexcept;
+
+    struct PostingKernels {
+        PostingDecodeKernel decode;
+        PostingFilterKernel filter;
+        const char* name; // For logging
+    };
+
+    void posting_decode_portable(const std::uint8_t* control, const std::uint8_t* data,
+                                 std::size_t data_size, std::size_t count, bool delta,
+                                 std::uint32_t* output) noexcept;
+    std::size_t posting_filter_portable(const std::uint32_t* ids, const std::uint32_t* positions,
+                                        std::size_t count, std::uint32_t low, std::uint32_t high,
+                                        std::uint32_t* matched) noexcept;
+
+#if EFUZZ_POSTING_KERNEL_X86
+    void posting_decode_avx2(const std::uint8_t* control, const std::uint8_t* data,
+                             std::size_t data_size, std::size_t count, bool delta,
+                             std::uint32_t* output) noexcept;
+    std::size_t posting_filter_avx2(const std::uint32_t* ids, const std::uint32_t* positions,
+                                    std::size_t count, std::uint32_t low, std::uint32_t high,
+                                    std::uint32_t* matched) noexcept;
+    std::size_t posting_filter_avx512(const std::uint32_t* ids, const std::uint32_t* positions,
+                                      std::size_t count, std::uint32_t low, std::uint32_t high,
+                                      std::uint32_t* matched) noexcept;
+#endif
+
+    // Picks the widest kernels the running CPU supports.
+    [[nodiscard]] PostingKernels select_posting_kernels() noexcept;
+
+    // The kernels chosen by select_posting_kernels(), resolved once per process.
+    [[nodiscard]] const PostingKernels& posting_kernels() noexcept;
+} // namespace efuzz
+
+#endif // EFUZZ_POSTING_KERNEL_HPP
@@ -0,0 +1,164 @@
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <efuzz/product_quantizer.hpp>
+
+namespace efuzz {
+    ProductQuantizer::ProductQuantizer(std::size_t dimension, std::size_t subspace_count) :
+        _dimension(dimension) {
+        if (subspace_count == 0 || subspace_count > dimension) {
+            throw std::invalid_argument("Subspace count must be between 1 and the dimension");
+        }
+
+        for (std::size_t subspace {0}; subspace <= subspace_count; ++subspace) {
+            _subspace_offsets.push_back(subspace * dimension / subspace_count);
+        }
+    }
+
+    void ProductQuantizer::train(const Eigen::Ref<const Eigen::MatrixXf>& sample,
+                                 std::size_t iterations, std::uint64_t seed) {
+        if (static_cast<std::size_t>(sample.rows()) != _dimension || sample.cols() == 0) {
+            throw std::invalid_argument("Training sample does not match the quantizer dimension");
+        }
+
+        const auto sample_count = static_cast<std::size_t>(sample.cols());
+        const std::size_t centroid_count = std::min(MAX_CENTROID_COUNT, sample_count);
+
+        std::mt19937_64 random_engine(seed);
+        std::vector<std::size_t> order(sample_count);
+        std::vector<std::size_t> assignments(sample_count);
+        std::vector<std::size_t> cluster_sizes(centroid_count);
+
+        _codebooks.clear();
+
+        for (std::size_t subspace {0}; subspace + 1 < _subspace_offsets.size(); ++subspace) {
+            const auto offset = static_cast<Eigen::Index>(_subspace_offsets [subspace]);
+            const auto length =
+                static_cast<Eigen::Index>(_subspace_offsets [subspace + 1]) - offset;
+            const Eigen::MatrixXf subspace_sample = sample.middleRows(offset, length);
+
+            // Lloyd's k-means, seeded with distinct random sample points
+            std::iota(order.begin(), order.end(), 0);
+            std::shuffle(order.begin(), order.end(), random_engine);
+
+            Eigen::MatrixXf& codebook = _codebooks.emplace_back(length, centroid_count);
+
+            for (std::size_t centroid {0}; centroid < centroid_count; ++centroid) {
+                codebook.col(centroid) = subspace_sample.col(order [centroid]);
+            }
+
+            for (std::size_t iteration {0}; iteration < iterations; ++iteration) {
+                for (std::size_t point {0}; point < sample_count; ++point) {
+                    assignments [point] =
+                        nearest_centroid(subspace, subspace_sample.col(point).data());
+                }
+
+                codebook.setZero();
+                std::fill(cluster_sizes.begin(), cluster_sizes.end(), 0);
+
+                for (std::size_t point {0}; point < sample_count; ++point) {
+                    codebook.col(assignments [point]) += subspace_sample.col(point);
+                    cluster_sizes [assignments [point]]++;
+                }
+
+                std::uniform_int_distribution<std::size_t> distribution(0, sample_count - 1);
+
+                for (std::size_t centroid {0}; centroid < centroid_count; ++centroid) {
+                    if (cluster_sizes [centroid] == 0) {
+                        codebook.col(centroid) = subspace_sample.col(distribution(random_engine));
+                    }
+                    else {
+                        codebook.col(centroid) /= static_cast<float>(cluster_sizes [centroid]);
+                    }
+                }
+            }
+        }
+    }
+
+    void ProductQuantizer::encode(const float* vector, std::uint8_t* code) const {
+        for (std::size_t subspace {0}; subspace < _codebooks.size(); ++subspace) {
+            code [subspace] = static_cast<std::uint8_t>(
+                nearest_centroid(subspace, vector + _subspace_offsets [subspace]));
+        }
+    }
+
+    void ProductQuantizer::decode(const std::uint8_t* code, float* vector) const {
+        for (std::size_t subspace {0}; subspace < _codebooks.size(); ++subspace) {
+            const auto& centroid = _codebooks [subspace].col(code [subspace]);
+
+            std::copy_n(centroid.data(), centroid.size(), vector + _subspace_offsets [subspace]);
+        }
+    }
+
+    Eigen::MatrixXf ProductQuantizer::distance_table(const float* query) const {
+        Eigen::MatrixXf table(get_centroid_count(), _codebooks.size());
+
+        for (std::size_t subspace {0}; subspace < _codebooks.size(); ++subspace) {
+            const auto& codebook = _codebooks [subspace];
+            const Eigen::Map<const Eigen::VectorXf> subquery(query + _subspace_offsets [subspace],
+                                                             codebook.rows());
+
+            table.col(subspace) = (codebook.colwise() - subquery).colwise().squaredNorm();
+        }
+
+        return table;
+    }
+
+    float ProductQuantizer::table_distance(const Eigen::MatrixXf& table,
+                                           const std::uint8_t* code) noexcept {
+        const float* column = table.data();
+        const auto centroid_count = static_cast<std::size_t>(table.rows());
+        float distance {};
+
+        for (Eigen::Index subspace {0}; subspace < table.cols(); ++subspace) {
+            distance += column [code [subspace]];
+            column += centroid_count;
+        }
+
+        return distance;
+    }
+
+    bool ProductQuantizer::is_trained() const noexcept {
+        return !_codebooks.empty();
+    }
+
+    std::size_t ProductQuantizer::get_dimension() const noexcept {
+        return _dimension;
+    }
+
+    std::size_t ProductQuantizer::get_subspace_count() const noexcept {
+        return _subspace_offsets.empty() ? 0 : _subspace_offsets.size() - 1;
+    }
+
+    std::size_t ProductQuantizer::get_centroid_count() const noexcept {
+        return _codebooks.empty() ? 0 : static_cast<std::size_t>(_codebooks.front().cols());
+    }
+
+    std::size_t ProductQuantizer::nearest_centroid(std::size_t subspace,
+                                                   const float* subvector) const {
+        const auto& codebook = _codebooks [subspace];
+        std::size_t nearest {};
+        float nearest_distance = std::numeric_limits<float>::max();
+
+        for (Eigen::Index centroid {0}; centroid < codebook.cols(); ++centroid) {
+            float distance {};
+
+            for (Eigen::Index component {0}; component < codebook.rows(); ++component) {
+                const float difference = codebook(component, centroid) - subvector [component];
+
+                distance += difference * difference;
+            }
+
+            if (distance < nearest_distance) {
+                nearest_distance = distance;
+                nearest = static_cast<std::size_t>(centroid);
+            }
+        }
+
+        return nearest;
+    }
+} // namespace efuzz
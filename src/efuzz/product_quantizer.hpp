@@ -0,0 +1,59 @@
+#ifndef EFUZZ_PRODUCT_QUANTIZER_HPP
+#define EFUZZ_PRODUCT_QUANTIZER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <cereal/cereal.hpp>
+#include <cereal/types/vector.hpp>
+#include <Eigen/Core>
+
+#include <efuzz/cereal_eigen.hpp>
+
+namespace efuzz {
+    // Splits vectors into subspaces and stores each subspace as the index of its nearest centroid,
+    // one byte per subspace. Distances to a query are read from a per-query lookup table
+    // (asymmetric distance computation), so stored vectors are never decompressed.
+    class ProductQuantizer {
+        public:
+
+        constexpr static std::size_t MAX_CENTROID_COUNT {256};
+        constexpr static std::size_t DEFAULT_TRAINING_ITERATIONS {16};
+
+        ProductQuantizer() = default;
+        ProductQuantizer(std::size_t dimension, std::size_t subspace_count);
+
+        // `sample` holds one training vector per column.
+        void train(const Eigen::Ref<const Eigen::MatrixXf>& sample,
+                   std::size_t iterations = DEFAULT_TRAINING_ITERATIONS, std::uint64_t seed = 0);
+        void encode(const float* vector, std::uint8_t* code) const;
+        void decode(const std::uint8_t* code, float* vector) const;
+
+        // Squared distances from `query` to every centroid, one column per subspace.
+        [[nodiscard]] Eigen::MatrixXf distance_table(const float* query) const;
+        [[nodiscard]] static float table_distance(const Eigen::MatrixXf& table,
+                                                  const std::uint8_t* code) noexcept;
+
+        [[nodiscard]] bool is_trained() const noexcept;
+        [[nodiscard]] std::size_t get_dimension() const noexcept;
+        [[nodiscard]] std::size_t get_subspace_count() const noexcept;
+        [[nodiscard]] std::size_t get_centroid_count() const noexcept;
+
+        template <class Archive>
+        void serialize(Archive& archive) {
+            archive(_dimension, _subspace_offsets, _codebooks);
+        }
+
+        private:
+
+        [[nodiscard]] std::size_t nearest_centroid(std::size_t subspace,
+                                                   const float* subvector) const;
+
+        std::size_t _dimension {};
+        std::vector<std::size_t> _subspace_offsets; // subspace_count + 1 entries
+        std::vector<Eigen::MatrixXf> _codebooks;    // Per subspace, one centroid per column
+    };
+} // namespace efuzz
+
+#endif // EFUZZ_PRODUCT_QUANTIZER_HPP
@@ -0,0 +1,386 @@
+#ifndef EFUZZ_QGRAM_INDEX_HPP
+#define EFUZZ_QGRAM_INDEX_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <cereal/cereal.hpp>
+#include <cereal/types/unordered_map.hpp>
+#include <cereal/types/vector.hpp>
+
+#include <efuzz/efuzz.hpp>
+#include <efuzz/index_build.hpp>
+#include <efuzz/posting_kernel.hpp>
+#include <efuzz/string_pool.hpp>
+
+namespace efuzz {
+    struct QGramIndexOptions {
+        constexpr static std::size_t DEFAULT_Q {3};
+        constexpr static std::size_t DEFAULT_MAX_EDIT_DISTANCE {3};
+
+        std::size_t q {DEFAULT_Q};
+        // Edit distance of searches that do not give one.
+        std::size_t max_edit_distance {DEFAULT_MAX_EDIT_DISTANCE};
+
+        template <typename Archive>
+        void serialize(Archive& archive) {
+            archive(q, max_edit_distance);
+        }
+    };
+
+    struct QGramSearchStats {
+        std::size_t posting_count {};   // Postings decoded
+        std::size_t candidate_count {}; // Entries passing the count filter, verified with rapidfuzz
+    };
+
+    // Positional q-gram inverted index for long strings. Each edit changes at most q of a
+    // string's q-grams and shifts the others by at most one position, so an entry within d edits
+    // of a query of length L shares at least L - q + 1 - q * d of the query's q-grams at
+    // positions at most d apart (count filtering). A search counts those shared q-grams per entry
+    // from the posting lists (ScanCount), then verifies the entries reaching the bound with
+    // rapidfuzz's Levenshtein distance and a score cutoff. Results are exactly the entries within
+    // the edit distance. Posting lists hold (id, position) pairs sorted by id, ids delta encoded,
+    // both in Stream VByte; a search decodes them and keeps the postings in the position window
+    // with the widest SIMD kernels the CPU has (see posting_kernels()).
+    template <StdString StringT_>
+    class QGramIndex {
+        public:
+
+        using StringT = StringT_;
+        using char_type = typename StringT::value_type;
+        using string_view_type = typename StringPool<StringT>::string_view_type;
+        using this_type = QGramIndex<StringT>;
+
+        QGramIndex() = default;
+        explicit QGramIndex(QGramIndexOptions options);
+
+        template <typename Archive>
+        void serialize(Archive& archive) {
+            archive(_options, _strings, _postings);
+        }
+
+        this_type& insert(const StringT& string);
+        // Inserts nothing if it throws.
+        this_type& insert(const std::vector<StringT>& strings);
+        this_type& insert_lines(std::basic_istream<char_type>& stream);
+
+        // The k best entries within the options' max_edit_distance of query. Safe to call from
+        // several threads at once, as long as nothing modifies the index.
+        [[nodiscard]] std::vector<SearchResult> search(const StringT& query, std::size_t k) const;
+        [[nodiscard]] std::vector<SearchResult>
+            search(const StringT& query, std::size_t k, std::size_t max_edit_distance,
+                   QGramSearchStats* stats = nullptr) const;
+        // Searches are spread over thread_count threads.
+        [[nodiscard]] std::vector<std::vector<SearchResult>>
+            search_batch(const std::vector<StringT>& queries, std::size_t k,
+                         std::size_t thread_count = 1) const;
+
+        // Valid until the next insert.
+        [[nodiscard]] string_view_type get(std::size_t id) const;
+        [[nodiscard]] std::size_t size() const;
+        // Bytes taken by the encoded posting lists.
+        [[nodiscard]] std::size_t get_posting_bytes() const;
+        [[nodiscard]] const QGramIndexOptions& get_options() const;
+
+        private:
+
+        struct PostingList {
+            StreamVByte id_deltas;
+            StreamVByte positions;
+            std::uint32_t last_id {}; // Of the last posting, which the next id is a delta from
+            std::uint32_t count {};
+
+            template <typename Archive>
+            void serialize(Archive& archive) {
+                archive(id_deltas, positions, last_id, count);
+            }
+        };
+
+        // Posting lists are keyed by the 64-bit FNV-1a hash of the q-gram's character values.
+        // The keys are serialized, so the hash must not depend on the standard library or the
+        // platform, as std::hash does; a collision only lets more candidates through to
+        // verification.
+        [[nodiscard]] static std::uint64_t gram_key(string_view_type gram);
+
+        QGramIndexOptions _options;
+        StringPool<StringT> _strings; // Ids are positions, as in SearchContainer
+        std::unordered_map<std::uint64_t, PostingList> _postings;
+    };
+
+    template <StdString StringT_>
+    QGramIndex<StringT_>::QGramIndex(QGramIndexOptions options) : _options(options) {
+        if (_options.q == 0) {
+            throw std::runtime_error("q-grams must have at least one character");
+        }
+    }
+
+    template <StdString StringT_>
+    auto QGramIndex<StringT_>::insert(const StringT& string) -> this_type& {
+        return insert(std::vector<StringT> {string});
+    }
+
+    template <StdString StringT_>
+    auto QGramIndex<StringT_>::insert(const std::vector<StringT>& strings) -> this_type& {
+        const std::size_t first_id = _strings.size();
+
+        if (first_id + strings.size() > std::numeric_limits<std::uint32_t>::max()) {
+            throw std::runtime_error("Too many entries for a q-gram index");
+        }
+
+        // How each list this insert appends to ended before it, to truncate it back to
+        struct PostingListEnd {
+            std::uint64_t key {};
+            std::size_t id_delta_bytes {};
+            std::size_t position_bytes {};
+            std::uint32_t last_id {};
+            std::uint32_t count {};
+        };
+
+        std::vector<PostingListEnd> list_ends;
+
+        try {
+            for (std::size_t index {0}; index < strings.size(); ++index) {
+                const auto id = static_cast<std::uint32_t>(first_id + index);
+                const string_view_type string = strings [index];
+
+                for (std::size_t position {0}; position + _options.q <= string.size();
+                     ++position) {
+                    const std::uint64_t key = gram_key(string.substr(position, _options.q));
+                    PostingList& postings = _postings [key];
+
+                    // Not appended to by this insert yet
+                    if (postings.count == 0 || postings.last_id < first_id) {
+                        list_ends.push_back({.key = key,
+                                             .id_delta_bytes = postings.id_deltas.data.size(),
+                                             .position_bytes = postings.positions.data.size(),
+                                             .last_id = postings.last_id,
+                                             .count = postings.count});
+                    }
+
+                    // A repeated gram of the same entry has an id delta of zero
+                    stream_vbyte_append(postings.id_deltas, postings.count,
+                                        id - postings.last_id);
+                    stream_vbyte_append(postings.positions, postings.count,
+                                        static_cast<std::uint32_t>(position));
+                    postings.last_id = id;
+                    ++postings.count;
+                }
+            }
+
+            _strings.add_all(strings);
+        }
+        catch (...) {
+            for (const PostingListEnd& list_end: list_ends) {
+                if (list_end.count == 0) {
+                    _postings.erase(list_end.key);
+
+                    continue;
+                }
+
+                PostingList& postings = _postings.find(list_end.key)->second;
+
+                stream_vbyte_truncate(postings.id_deltas, list_end.count,
+                                      list_end.id_delta_bytes);
+                stream_vbyte_truncate(postings.positions, list_end.count,
+                                      list_end.position_bytes);
+                postings.last_id = list_end.last_id;
+                postings.count = list_end.count;
+            }
+
+            throw;
+        }
+
+        return *this;
+    }
+
+    template <StdString StringT_>
+    auto QGramIndex<StringT_>::insert_lines(std::basic_istream<char_type>& stream) -> this_type& {
+        for_each_line_chunk<StringT>(stream, IndexBuildOptions::DEFAULT_CHUNK_SIZE,
+                                     [this](const std::vector<StringT>& lines) { insert(lines); });
+
+        return *this;
+    }
+
+    template <StdString StringT_>
+    std::vector<SearchResult> QGramIndex<StringT_>::search(const StringT& query,
+                                                           std::size_t k) const {
+        return search(query, k, _options.max_edit_distance);
+    }
+
+    template <StdString StringT_>
+    std::vector<SearchResult> QGramIndex<StringT_>::search(const StringT& query, std::size_t k,
+                                                           std::size_t max_edit_distance,
+                                                           QGramSearchStats* stats) const {
+        const std::size_t q = _options.q;
+        const std::size_t gram_count = query.size() >= q ? query.size() - q + 1 : 0;
+        const std::size_t destroyed_grams = q * max_edit_distance;
+        std::vector<std::uint32_t> candidates;
+        std::size_t posting_count {};
+
+        if (gram_count > destroyed_grams) {
+            const std::size_t min_shared_grams = gram_count - destroyed_grams;
+            // ScanCount: one counter per entry, and the entries touched so they can be listed
+            // and reset without scanning every counter. Reused across searches, and zero
+            // between them.
+            thread_local std::vector<std::uint32_t> counts;
+            thread_local std::vector<std::uint32_t> touched;
+            // Decoded postings of one list, and the ids in its position window
+            thread_local std::vector<std::uint32_t> ids;
+            thread_local std::vector<std::uint32_t> positions;
+            thread_local std::vector<std::uint32_t> matched;
+            const PostingKernels& kernels = posting_kernels();
+            const string_view_type query_view = query;
+
+            // Puts the touched counters back to zero however the search ends, an exception
+            // included, so a later search on this thread does not start from stale counts
+            struct CountReset {
+                std::vector<std::uint32_t>& counts;
+                std::vector<std::uint32_t>& touched;
+
+                ~CountReset() {
+                    for (const std::uint32_t id: touched) {
+                        counts [id] = 0;
+                    }
+
+                    touched.clear();
+                }
+            };
+
+            counts.resize(std::max(counts.size(), _strings.size()));
+            // Room for every entry up front, so recording a touched counter cannot throw and
+            // leave it nonzero without a record
+            touched.reserve(_strings.size());
+
+            const CountReset count_reset {counts, touched};
+
+            for (std::size_t position {0}; position < gram_count; ++position) {
+                const auto found = _postings.find(gram_key(query_view.substr(position, q)));
+
+                if (found == _postings.end()) {
+                    continue;
+                }
+
+                const PostingList& postings = found->second;
+                const std::size_t count = postings.count;
+                const auto window_low = static_cast<std::uint32_t>(
+                    position > max_edit_distance ? position - max_edit_distance : 0);
+                const auto window_high = static_cast<std::uint32_t>(
+                    std::min<std::size_t>(position + max_edit_distance,
+                                          std::numeric_limits<std::uint32_t>::max()));
+
+                posting_count += count;
+                ids.resize(std::max(ids.size(), count));
+                positions.resize(std::max(positions.size(), count));
+                matched.resize(std::max(matched.size(), count + 16));
+                kernels.decode(postings.id_deltas.control.data(), postings.id_deltas.data.data(),
+                               postings.id_deltas.data.size(), count, true, ids.data());
+                kernels.decode(postings.positions.control.data(), postings.positions.data.data(),
+                               postings.positions.data.size(), count, false, positions.data());
+
+                const std::size_t matched_count = kernels.filter(
+                    ids.data(), positions.data(), count, window_low, window_high, matched.data());
+                std::uint32_t counted_id = std::numeric_limits<std::uint32_t>::max();
+
+                for (std::size_t posting {0}; posting < matched_count; ++posting) {
+                    const std::uint32_t id = matched [posting];
+
+                    // Once per entry and query gram, however often the entry repeats it
+                    if (id == counted_id) {
+                        continue;
+                    }
+
+                    counted_id = id;
+
+                    if (counts [id]++ == 0) {
+                        touched.push_back(id);
+                    }
+                }
+            }
+
+            for (const std::uint32_t id: touched) {
+                if (counts [id] >= min_shared_grams) {
+                    candidates.push_back(id);
+                }
+            }
+
+            std::sort(candidates.begin(), candidates.end());
+        }
+        else {
+            // Too short for the bound to exclude anything; the length filter below still applies
+            candidates.resize(_strings.size());
+
+            for (std::size_t id {0}; id < candidates.size(); ++id) {
+                candidates [id] = static_cast<std::uint32_t>(id);
+            }
+        }
+
+        std::vector<SearchResult> results =
+            verify_edit_distance(query, _strings, candidates, max_edit_distance);
+
+        if (stats != nullptr) {
+            *stats = QGramSearchStats {.posting_count = posting_count,
+                                       .candidate_count = candidates.size()};
+        }
+
+        return merge_results(std::move(results), k);
+    }
+
+    template <StdString StringT_>
+    std::vector<std::vector<SearchResult>>
+        QGramIndex<StringT_>::search_batch(const std::vector<StringT>& queries, std::size_t k,
+                                           std::size_t thread_count) const {
+        return search_each(queries, thread_count,
+                           [&](const StringT& query) { return search(query, k); });
+    }
+
+    template <StdString StringT_>
+    auto QGramIndex<StringT_>::get(std::size_t id) const -> string_view_type {
+        return _strings.at(id);
+    }
+
+    template <StdString StringT_>
+    std::size_t QGramIndex<StringT_>::size() const {
+        return _strings.size();
+    }
+
+    template <StdString StringT_>
+    std::size_t QGramIndex<StringT_>::get_posting_bytes() const {
+        std::size_t bytes {};
+
+        for (const auto& [key, postings]: _postings) {
+            bytes += postings.id_deltas.control.size() + postings.id_deltas.data.size() +
+                     postings.positions.control.size() + postings.positions.data.size();
+        }
+
+        return bytes;
+    }
+
+    template <StdString StringT_>
+    const QGramIndexOptions& QGramIndex<StringT_>::get_options() const {
+        return _options;
+    }
+
+    template <StdString StringT_>
+    std::uint64_t QGramIndex<StringT_>::gram_key(string_view_type gram) {
+        constexpr std::uint64_t FNV_OFFSET_BASIS {14695981039346656037ULL};
+        constexpr std::uint64_t FNV_PRIME {1099511628211ULL};
+        std::uint64_t hash {FNV_OFFSET_BASIS};
+
+        // By value, so the signedness of char does not change the key
+        for (const char_type character: gram) {
+            hash = (hash ^ static_cast<std::make_unsigned_t<char_type>>(character)) * FNV_PRIME;
+        }
+
+        return hash;
+    }
+} // namespace efuzz
+
+#endif // EFUZZ_QGRAM_INDEX_HPP
@@ -0,0 +1,203 @@
+#ifndef EFUZZ_QUERY_CACHE_HPP
+#define EFUZZ_QUERY_CACHE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace efuzz {
+    struct QueryCacheStats {
+        std::uint64_t hits {};
+        std::uint64_t misses {};
+        std::uint64_t evictions {};
+        std::uint64_t invalidations {}; // Entries dropped because their snapshot went stale
+        std::size_t size {};
+        std::size_t capacity {};
+    };
+
+    // Sharded, thread-safe cache with CLOCK eviction. Every entry records the snapshot it was
+    // computed against; looking it up under a different snapshot drops it, so bumping the
+    // snapshot invalidates the whole cache without touching it.
+    template <typename KeyT, typename ValueT, typename HashT = std::hash<KeyT>>
+    class QueryCache {
+        public:
+
+        constexpr static std::size_t DEFAULT_SHARD_COUNT {16};
+
+        explicit QueryCache(std::size_t capacity, std::size_t shard_count = DEFAULT_SHARD_COUNT);
+        QueryCache(const QueryCache&) = delete;
+        QueryCache& operator=(const QueryCache&) = delete;
+
+        [[nodiscard]] std::optional<ValueT> find(const KeyT& key, std::uint64_t snapshot);
+        void insert(const KeyT& key, ValueT value, std::uint64_t snapshot);
+        void clear();
+
+        [[nodiscard]] QueryCacheStats get_stats() const;
+
+        private:
+
+        struct Entry {
+            KeyT key;
+            ValueT value;
+            std::uint64_t snapshot {};
+            bool referenced {};
+            bool occupied {};
+        };
+
+        struct Shard {
+            std::mutex mutex;
+            std::vector<Entry> entries;
+            std::unordered_map<KeyT, std::size_t, HashT> slots;
+            std::size_t clock_hand {};
+        };
+
+        Shard& shard_for(const KeyT& key);
+        std::size_t claim_slot(Shard& shard);
+
+        std::vector<std::unique_ptr<Shard>> _shards;
+        std::size_t _capacity {};
+        HashT _hash;
+        std::atomic<std::uint64_t> _hits {};
+        std::atomic<std::uint64_t> _misses {};
+        std::atomic<std::uint64_t> _evictions {};
+        std::atomic<std::uint64_t> _invalidations {};
+    };
+
+    template <typename KeyT, typename ValueT, typename HashT>
+    QueryCache<KeyT, ValueT, HashT>::QueryCache(std::size_t capacity, std::size_t shard_count) {
+        shard_count = std::max<std::size_t>(1, std::min(shard_count, capacity));
+
+        const std::size_t shard_capacity = (capacity + shard_count - 1) / shard_count;
+
+        for (std::size_t shard {0}; shard < shard_count; ++shard) {
+            _shards.push_back(std::make_unique<Shard>());
+            _shards.back()->entries.resize(shard_capacity);
+            _shards.back()->slots.reserve(shard_capacity);
+        }
+
+        _capacity = shard_capacity * shard_count;
+    }
+
+    template <typename KeyT, typename ValueT, typename HashT>
+    std::optional<ValueT> QueryCache<KeyT, ValueT, HashT>::find(const KeyT& key,
+                                                                std::uint64_t snapshot) {
+        Shard& shard = shard_for(key);
+        const std::lock_guard lock {shard.mutex};
+        const auto slot = shard.slots.find(key);
+
+        if (slot == shard.slots.end()) {
+            _misses.fetch_add(1, std::memory_order_relaxed);
+
+            return std::nullopt;
+        }
+
+        Entry& entry = shard.entries [slot->second];
+
+        if (entry.snapshot != snapshot) {
+            entry = Entry {};
+            shard.slots.erase(slot);
+            _invalidations.fetch_add(1, std::memory_order_relaxed);
+            _misses.fetch_add(1, std::memory_order_relaxed);
+
+            return std::nullopt;
+        }
+
+        entry.referenced = true;
+        _hits.fetch_add(1, std::memory_order_relaxed);
+
+        return entry.value;
+    }
+
+    template <typename KeyT, typename ValueT, typename HashT>
+    void QueryCache<KeyT, ValueT, HashT>::insert(const KeyT& key, ValueT value,
+                                                 std::uint64_t snapshot) {
+        if (_capacity == 0) {
+            return;
+        }
+
+        Shard& shard = shard_for(key);
+        const std::lock_guard lock {shard.mutex};
+        const auto slot = shard.slots.find(key);
+        const std::size_t index = slot != shard.slots.end() ? slot->second : claim_slot(shard);
+
+        shard.entries [index] = Entry {.key = key,
+                                       .value = std::move(value),
+                                       .snapshot = snapshot,
+                                       .referenced = false,
+                                       .occupied = true};
+        shard.slots [key] = index;
+    }
+
+    template <typename KeyT, typename ValueT, typename HashT>
+    void QueryCache<KeyT, ValueT, HashT>::clear() {
+        for (auto& shard: _shards) {
+            const std::lock_guard lock {shard->mutex};
+
+            for (auto& entry: shard->entries) {
+                entry = Entry {};
+            }
+
+            shard->slots.clear();
+            shard->clock_hand = 0;
+        }
+    }
+
+    template <typename KeyT, typename ValueT, typename HashT>
+    QueryCacheStats QueryCache<KeyT, ValueT, HashT>::get_stats() const {
+        QueryCacheStats stats {.hits = _hits.load(std::memory_order_relaxed),
+                               .misses = _misses.load(std::memory_order_relaxed),
+                               .evictions = _evictions.load(std::memory_order_relaxed),
+                               .invalidations = _invalidations.load(std::memory_order_relaxed),
+                               .capacity = _capacity};
+
+        for (const auto& shard: _shards) {
+            const std::lock_guard lock {shard->mutex};
+
+            stats.size += shard->slots.size();
+        }
+
+        return stats;
+    }
+
+    template <typename KeyT, typename ValueT, typename HashT>
+    auto QueryCache<KeyT, ValueT, HashT>::shard_for(const KeyT& key) -> Shard& {
+        return *_shards [_hash(key) % _shards.size()];
+    }
+
+    template <typename KeyT, typename ValueT, typename HashT>
+    std::size_t QueryCache<KeyT, ValueT, HashT>::claim_slot(Shard& shard) {
+        // Second-chance sweep: referenced entries get their bit cleared and are skipped once.
+        while (true) {
+            const std::size_t index = shard.clock_hand;
+            Entry& entry = shard.entries [index];
+
+            shard.clock_hand = (shard.clock_hand + 1) % shard.entries.size();
+
+            if (!entry.occupied) {
+                return index;
+            }
+
+            if (entry.referenced) {
+                entry.referenced = false;
+
+                continue;
+            }
+
+            shard.slots.erase(entry.key);
+            entry = Entry {};
+            _evictions.fetch_add(1, std::memory_order_relaxed);
+
+            return index;
+        }
+    }
+} // namespace efuzz
+
+#endif // EFUZZ_QUERY_CACHE_HPP
@@ -0,0 +1,188 @@
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+#include <efuzz/query_profiler.hpp>
+
+namespace efuzz {
+    const char* query_stage_name(QueryStage stage) noexcept {
+        switch (stage) {
+            case QueryStage::encode: return "encode";
+            case QueryStage::vector_lookup: return "vector_lookup";
+            case QueryStage::prefilter: return "prefilter";
+            case QueryStage::rerank: return "rerank";
+            case QueryStage::merge: return "merge";
+        }
+
+        return "unknown";
+    }
+
+    void LatencyHistogram::record(std::chrono::nanoseconds duration) noexcept {
+        const auto nanoseconds =
+            static_cast<std::uint64_t>(std::max<std::int64_t>(0, duration.count()));
+
+        _buckets [bucket_index(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+        _count.fetch_add(1, std::memory_order_relaxed);
+        _total.fetch_add(nanoseconds, std::memory_order_relaxed);
+
+        std::uint64_t max = _max.load(std::memory_order_relaxed);
+
+        while (nanoseconds > max &&
+               !_max.compare_exchange_weak(max, nanoseconds, std::memory_order_relaxed)) {
+        }
+    }
+
+    void LatencyHistogram::reset() noexcept {
+        for (auto& bucket: _buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+
+        _count.store(0, std::memory_order_relaxed);
+        _total.store(0, std::memory_order_relaxed);
+        _max.store(0, std::memory_order_relaxed);
+    }
+
+    LatencySummary LatencyHistogram::summary() const noexcept {
+        const std::uint64_t count = this->count();
+
+        return {.count = count,
+                .p50 = quantile(0.5),
+                .p90 = quantile(0.9),
+                .p99 = quantile(0.99),
+                .max = std::chrono::nanoseconds(_max.load(std::memory_order_relaxed)),
+                .mean = std::chrono::nanoseconds(
+                    count > 0 ? _total.load(std::memory_order_relaxed) / count : 0)};
+    }
+
+    std::chrono::nanoseconds LatencyHistogram::quantile(double quantile) const noexcept {
+        const std::uint64_t count = this->count();
+
+        if (count == 0) {
+            return {};
+        }
+
+        const auto target = std::max<std::uint64_t>(
+            1, static_cast<std::uint64_t>(std::ceil(quantile * static_cast<double>(count))));
+        const std::uint64_t max = _max.load(std::memory_order_relaxed);
+        std::uint64_t cumulative {};
+
+        for (std::size_t index {0}; index < BUCKET_COUNT; ++index) {
+            cumulative += _buckets [index].load(std::memory_order_relaxed);
+
+            if (cumulative >= target) {
+                return std::chrono::nanoseconds(std::min(bucket_upper_bound(index), max));
+            }
+        }
+
+        return std::chrono::nanoseconds(max);
+    }
+
+    std::uint64_t LatencyHistogram::count() const noexcept {
+        return _count.load(std::memory_order_relaxed);
+    }
+
+    std::size_t LatencyHistogram::bucket_index(std::uint64_t nanoseconds) noexcept {
+        if (nanoseconds < SUB_BUCKET_COUNT) {
+            return static_cast<std::size_t>(nanoseconds);
+        }
+
+        // The leading bit picks the row, the SUB_BUCKET_BITS bits after it the bucket in the row.
+        const auto leading_bit = static_cast<std::size_t>(std::bit_width(nanoseconds) - 1);
+        const std::size_t row = leading_bit - SUB_BUCKET_BITS + 1;
+        const auto sub_bucket = static_cast<std::size_t>(
+            (nanoseconds >> (leading_bit - SUB_BUCKET_BITS)) & (SUB_BUCKET_COUNT - 1));
+
+        return std::min((row * SUB_BUCKET_COUNT) + sub_bucket, BUCKET_COUNT - 1);
+    }
+
+    std::uint64_t LatencyHistogram::bucket_upper_bound(std::size_t index) noexcept {
+        if (index < SUB_BUCKET_COUNT) {
+            return index;
+        }
+
+        const std::size_t row = index / SUB_BUCKET_COUNT;
+        const std::size_t shift = row - 1;
+        const std::uint64_t lower = (SUB_BUCKET_COUNT + (index % SUB_BUCKET_COUNT)) << shift;
+
+        return lower + (std::uint64_t {1} << shift) - 1;
+    }
+
+    QueryProfiler::QueryProfiler(std::size_t trace_interval, std::size_t trace_capacity) :
+        _trace_interval(trace_interval), _trace_capacity(trace_capacity) {
+        _traces.reserve(trace_capacity);
+    }
+
+    std::uint64_t QueryProfiler::start_query() noexcept {
+        return _query_sequence.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void QueryProfiler::record(QueryStage stage, std::chrono::nanoseconds duration) noexcept {
+        _stage_histograms [static_cast<std::size_t>(stage)].record(duration);
+    }
+
+    void QueryProfiler::finish_query(const QueryTrace& trace) {
+        _total_histogram.record(trace.total);
+
+        if (!is_traced(trace.sequence) || _trace_capacity == 0) {
+            return;
+        }
+
+        const std::lock_guard lock {_trace_mutex};
+
+        if (_traces.size() < _trace_capacity) {
+            _traces.push_back(trace);
+        }
+        else {
+            _traces [_next_trace] = trace;
+        }
+
+        _next_trace = (_next_trace + 1) % _trace_capacity;
+    }
+
+    bool QueryProfiler::is_traced(std::uint64_t sequence) const noexcept {
+        return _trace_interval > 0 && sequence % _trace_interval == 0;
+    }
+
+    void QueryProfiler::reset() {
+        for (auto& histogram: _stage_histograms) {
+            histogram.reset();
+        }
+
+        _total_histogram.reset();
+
+        const std::lock_guard lock {_trace_mutex};
+
+        _traces.clear();
+        _next_trace = 0;
+    }
+
+    QueryLatencySnapshot QueryProfiler::snapshot() const noexcept {
+        QueryLatencySnapshot snapshot {.stages = {}, .total = _total_histogram.summary()};
+
+        for (std::size_t stage {0}; stage < QUERY_STAGE_COUNT; ++stage) {
+            snapshot.stages [stage] = _stage_histograms [stage].summary();
+        }
+
+        return snapshot;
+    }
+
+    std::vector<QueryTrace> QueryProfiler::get_traces() const {
+        const std::lock_guard lock {_trace_mutex};
+        std::vector<QueryTrace> traces;
+
+        traces.reserve(_traces.size());
+
+        // Once the ring is full, _next_trace points at the oldest trace
+        const std::size_t oldest = _traces.size() < _trace_capacity ? 0 : _next_trace;
+
+        for (std::size_t index {0}; index < _traces.size(); ++index) {
+            traces.push_back(_traces [(oldest + index) % _traces.size()]);
+        }
+
+        return traces;
+    }
+
+    const LatencyHistogram& QueryProfiler::get_histogram(QueryStage stage) const noexcept {
+        return _stage_histograms [static_cast<std::size_t>(stage)];
+    }
+} // namespace efuzz
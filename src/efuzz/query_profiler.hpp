@@ -0,0 +1,219 @@
+#ifndef EFUZZ_QUERY_PROFILER_HPP
+#define EFUZZ_QUERY_PROFILER_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#if defined(EFUZZ_DISABLE_QUERY_PROFILING)
+ #define EFUZZ_QUERY_PROFILING 0
+#else
+ #define EFUZZ_QUERY_PROFILING 1
+#endif
+
+namespace efuzz {
+    enum class QueryStage : std::uint8_t {
+        encode,
+        vector_lookup,
+        prefilter, // Candidate filtering between lookup and rerank, when a search uses one
+        rerank,
+        merge,
+    };
+
+    constexpr std::size_t QUERY_STAGE_COUNT {5};
+
+    [[nodiscard]] const char* query_stage_name(QueryStage stage) noexcept;
+
+    struct LatencySummary {
+        std::uint64_t count {};
+        std::chrono::nanoseconds p50 {};
+        std::chrono::nanoseconds p90 {};
+        std::chrono::nanoseconds p99 {};
+        std::chrono::nanoseconds max {};
+        std::chrono::nanoseconds mean {};
+    };
+
+    // Log-linear histogram of durations: every power of two is split into SUB_BUCKET_COUNT
+    // buckets, so percentiles are within 1/SUB_BUCKET_COUNT of the recorded value. Recording is a
+    // few relaxed atomic increments and never blocks.
+    class LatencyHistogram {
+        public:
+
+        constexpr static std::size_t SUB_BUCKET_BITS {4};
+        constexpr static std::size_t SUB_BUCKET_COUNT {std::size_t {1} << SUB_BUCKET_BITS};
+        // Durations below 2^(MAX_EXPONENT + SUB_BUCKET_BITS) ns, about 4.9 hours; longer ones
+        // land in the last bucket.
+        constexpr static std::size_t MAX_EXPONENT {40};
+        constexpr static std::size_t BUCKET_COUNT {(MAX_EXPONENT + 1) * SUB_BUCKET_COUNT};
+
+        void record(std::chrono::nanoseconds duration) noexcept;
+        void reset() noexcept;
+
+        // Concurrent records may or may not be included.
+        [[nodiscard]] LatencySummary summary() const noexcept;
+        // Upper bound of the bucket holding the given quantile, 0 to 1.
+        [[nodiscard]] std::chrono::nanoseconds quantile(double quantile) const noexcept;
+        [[nodiscard]] std::uint64_t count() const noexcept;
+
+        private:
+
+        [[nodiscard]] static std::size_t bucket_index(std::uint64_t nanoseconds) noexcept;
+        [[nodiscard]] static std::uint64_t bucket_upper_bound(std::size_t index) noexcept;
+
+        std::array<std::atomic<std::uint64_t>, BUCKET_COUNT> _buckets {};
+        std::atomic<std::uint64_t> _count {};
+        std::atomic<std::uint64_t> _total {};
+        std::atomic<std::uint64_t> _max {};
+    };
+
+    struct QueryTrace {
+        std::uint64_t sequence {}; // Number of the query since profiling was enabled
+        std::array<std::chrono::nanoseconds, QUERY_STAGE_COUNT> stages {};
+        std::chrono::nanoseconds total {};
+        std::size_t candidate_count {};
+        std::size_t result_count {};
+        bool cache_hit {};
+    };
+
+    struct QueryLatencySnapshot {
+        std::array<LatencySummary, QUERY_STAGE_COUNT> stages;
+        LatencySummary total;
+    };
+
+    // Per-stage latency histograms for a search path, plus a ring of sampled per-query traces.
+    // All members are safe to call from several threads at once.
+    class QueryProfiler {
+        public:
+
+        constexpr static std::size_t DEFAULT_TRACE_CAPACITY {256};
+
+        // Keeps a trace of every trace_interval-th query, none if zero.
+        explicit QueryProfiler(std::size_t trace_interval = 0,
+                               std::size_t trace_capacity = DEFAULT_TRACE_CAPACITY);
+        QueryProfiler(const QueryProfiler&) = delete;
+        QueryProfiler& operator=(const QueryProfiler&) = delete;
+
+        // Starts a query; the returned sequence number is passed back to finish_query.
+        [[nodiscard]] std::uint64_t start_query() noexcept;
+        void record(QueryStage stage, std::chrono::nanoseconds duration) noexcept;
+        void finish_query(const QueryTrace& trace);
+        [[nodiscard]] bool is_traced(std::uint64_t sequence) const noexcept;
+
+        void reset();
+
+        [[nodiscard]] QueryLatencySnapshot snapshot() const noexcept;
+        // Sampled traces, oldest first.
+        [[nodiscard]] std::vector<QueryTrace> get_traces() const;
+        [[nodiscard]] const LatencyHistogram& get_histogram(QueryStage stage) const noexcept;
+
+        private:
+
+        std::array<LatencyHistogram, QUERY_STAGE_COUNT> _stage_histograms;
+        LatencyHistogram _total_histogram;
+        std::atomic<std::uint64_t> _query_sequence {};
+        std::size_t _trace_interval {};
+        std::size_t _trace_capacity {};
+        mutable std::mutex _trace_mutex;
+        std::vector<QueryTrace> _traces;
+        std::size_t _next_trace {};
+    };
+
+    // Times the stages of one query. Each stage runs from the previous mark (or construction) to
+    // its own mark. With EFUZZ_DISABLE_QUERY_PROFILING every member compiles to nothing.
+    class QueryTimer {
+        public:
+
+        using clock = std::chrono::steady_clock;
+
+        explicit QueryTimer(QueryProfiler* profiler) noexcept;
+        QueryTimer(const QueryTimer&) = delete;
+        QueryTimer& operator=(const QueryTimer&) = delete;
+
+        void mark(QueryStage stage) noexcept;
+        void set_candidate_count(std::size_t candidate_count) noexcept;
+        void set_result_count(std::size_t result_count) noexcept;
+        void set_cache_hit() noexcept;
+        void finish();
+
+        private:
+
+#if EFUZZ_QUERY_PROFILING
+        QueryProfiler* _profiler;
+        std::uint64_t _sequence {};
+        clock::time_point _start;
+        clock::time_point _last_mark;
+        QueryTrace _trace;
+#endif
+    };
+
+#if EFUZZ_QUERY_PROFILING
+    inline QueryTimer::QueryTimer(QueryProfiler* profiler) noexcept : _profiler(profiler) {
+        if (_profiler != nullptr) {
+            _sequence = _profiler->start_query();
+            _start = _last_mark = clock::now();
+        }
+    }
+
+    inline void QueryTimer::mark(QueryStage stage) noexcept {
+        if (_profiler == nullptr) {
+            return;
+        }
+
+        const clock::time_point now = clock::now();
+        const auto duration =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(now - _last_mark);
+
+        _profiler->record(stage, duration);
+        _trace.stages [static_cast<std::size_t>(stage)] += duration;
+        _last_mark = now;
+    }
+
+    inline void QueryTimer::set_candidate_count(std::size_t candidate_count) noexcept {
+        _trace.candidate_count = candidate_count;
+    }
+
+    inline void QueryTimer::set_result_count(std::size_t result_count) noexcept {
+        _trace.result_count = result_count;
+    }
+
+    inline void QueryTimer::set_cache_hit() noexcept {
+        _trace.cache_hit = true;
+    }
+
+    inline void QueryTimer::finish() {
+        if (_profiler == nullptr) {
+            return;
+        }
+
+        _trace.sequence = _sequence;
+        _trace.total =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - _start);
+        _profiler->finish_query(_trace);
+        _profiler = nullptr;
+    }
+#else
+    inline QueryTimer::QueryTimer(QueryProfiler* /*profiler*/) noexcept {
+    }
+
+    inline void QueryTimer::mark(QueryStage /*stage*/) noexcept {
+    }
+
+    inline void QueryTimer::set_candidate_count(std::size_t /*candidate_count*/) noexcept {
+    }
+
+    inline void QueryTimer::set_result_count(std::size_t /*result_count*/) noexcept {
+    }
+
+    inline void QueryTimer::set_cache_hit() noexcept {
+    }
+
+    inline void QueryTimer::finish() {
+    }
+#endif
+} // namespace efuzz
+
+#endif // EFUZZ_QUERY_PROFILER_HPP
@@ -0,0 +1,124 @@
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+#include <efuzz/racing.hpp>
+
+namespace efuzz {
+    CandidateRace::CandidateRace() : CandidateRace(RacingOptions {}) {
+    }
+
+    CandidateRace::CandidateRace(RacingOptions options) :
+        _options(options),
+        _random_engine(options.seed) {
+        if (!(_options.failure_probability > 0.0F && _options.failure_probability < 1.0F)) {
+            throw std::runtime_error("Racing failure probability must be between 0 and 1");
+        }
+
+        if (!(_options.cost_range > 0.0F)) {
+            throw std::runtime_error("Racing cost range must be positive");
+        }
+
+        _options.min_pairs = std::max<std::size_t>(2, _options.min_pairs);
+        _options.check_interval = std::max<std::size_t>(1, _options.check_interval);
+    }
+
+    void CandidateRace::start(std::size_t pair_count, float original_average_cost) {
+        _pair_count = pair_count;
+        _scored_count = 0;
+        _original_average_cost = original_average_cost;
+        _modified_cost_sum = 0.0;
+        _difference_sum = 0.0;
+        _squared_difference_sum = 0.0;
+        _order.clear();
+
+        const std::size_t check_count =
+            pair_count < _options.min_pairs
+                ? 1
+                : 1 + ((pair_count - _options.min_pairs) / _options.check_interval);
+
+        _log_inverse_failure_probability =
+            std::log(static_cast<double>(check_count) / _options.failure_probability);
+    }
+
+    auto CandidateRace::order() -> const std::vector<std::size_t>& {
+        if (_order.size() != _pair_count) {
+            _order.resize(_pair_count);
+            std::iota(_order.begin(), _order.end(), 0);
+            std::shuffle(_order.begin(), _order.end(), _random_engine);
+        }
+
+        return _order;
+    }
+
+    void CandidateRace::record(float original_pair_cost, float modified_pair_cost) noexcept {
+        const double difference = static_cast<double>(modified_pair_cost) - original_pair_cost;
+
+        ++_scored_count;
+        _modified_cost_sum += modified_pair_cost;
+        _difference_sum += difference;
+        _squared_difference_sum += difference * difference;
+    }
+
+    bool CandidateRace::lost() const noexcept {
+        const auto pair_count = static_cast<double>(_pair_count);
+        const double original_cost_sum = _original_average_cost * pair_count;
+
+        if (_scored_count == 0 || _options.rule == RacingRule::off) {
+            return false;
+        }
+
+        // Costs are never negative, so this much is certain
+        if (_modified_cost_sum > original_cost_sum || _scored_count == _pair_count) {
+            return _modified_cost_sum >= original_cost_sum;
+        }
+
+        if (_scored_count < _options.min_pairs ||
+            (_scored_count - _options.min_pairs) % _options.check_interval != 0) {
+            return false;
+        }
+
+        const auto scored_count = static_cast<double>(_scored_count);
+        const double range = _options.cost_range;
+
+        if (_options.rule == RacingRule::hoeffding) {
+            // Without replacement the bound narrows as the scored pairs cover more of the total
+            const double remaining_fraction = 1.0 - ((scored_count - 1.0) / pair_count);
+            const double margin = range * std::sqrt(_log_inverse_failure_probability *
+                                                    remaining_fraction / (2.0 * scored_count));
+
+            return _modified_cost_sum / scored_count - margin >= _original_average_cost;
+        }
+
+        // The Gaussian tail bound exp(-z^2 / 2) stands in for the normal quantile
+        const double z = std::sqrt(2.0 * _log_inverse_failure_probability);
+        const double mean_difference = _difference_sum / scored_count;
+        const double squared_deviation_sum =
+            _squared_difference_sum - (scored_count * mean_difference * mean_difference);
+        const double variance = std::max(0.0, squared_deviation_sum / (scored_count - 1.0));
+        const double margin = z * std::sqrt(variance / scored_count);
+
+        return mean_difference - margin >= 0.0;
+    }
+
+    std::size_t CandidateRace::scored_count() const noexcept {
+        return _scored_count;
+    }
+
+    std::size_t CandidateRace::pair_count() const noexcept {
+        return _pair_count;
+    }
+
+    float CandidateRace::modified_average_cost() const noexcept {
+        if (_scored_count == 0) {
+            return 0.0F;
+        }
+
+        return static_cast<float>(_modified_cost_sum / static_cast<double>(_scored_count));
+    }
+
+    const RacingOptions& CandidateRace::get_options() const noexcept {
+        return _options;
+    }
+} // namespace efuzz
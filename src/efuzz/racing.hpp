@@ -0,0 +1,77 @@
+#ifndef EFUZZ_RACING_HPP
+#define EFUZZ_RACING_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace efuzz {
+    enum class RacingRule : std::uint8_t {
+        off, // Every pair is scored
+        // Bounds the modified network's average cost from the pairs scored so far, knowing only
+        // the range of a pair's cost (Hoeffding-Serfling, for sampling without replacement)
+        hoeffding,
+        // Running normal confidence interval of the per-pair cost differences: far tighter when
+        // a diff moves most costs a little, but only approximate until enough pairs are scored
+        confidence_interval,
+    };
+
+    struct RacingOptions {
+        constexpr static std::size_t DEFAULT_MIN_PAIRS {32};
+        constexpr static std::size_t DEFAULT_CHECK_INTERVAL {16};
+
+        RacingRule rule {RacingRule::off};
+        // Chance of rejecting a candidate whose average cost over all pairs is lower than the
+        // original's, shared between all checks of one race
+        float failure_probability {0.05F};
+        // Pairs scored before the first check, and between two checks
+        std::size_t min_pairs {DEFAULT_MIN_PAIRS};
+        std::size_t check_interval {DEFAULT_CHECK_INTERVAL};
+        // hoeffding: upper bound of a single pair's cost; normalized distances and targets keep
+        // it at 1
+        float cost_range {1.0F};
+        // Of the order pairs are scored in
+        std::uint64_t seed {};
+    };
+
+    // Scores a candidate network against the original one pair at a time and tells when the
+    // candidate can no longer reach a lower average cost than the original over all pairs.
+    class CandidateRace {
+        public:
+
+        CandidateRace();
+        explicit CandidateRace(RacingOptions options);
+
+        // A new race over pair_count pairs. The original's costs of all of them are known.
+        void start(std::size_t pair_count, float original_average_cost);
+        // Scoring order for the current race: a random permutation of the pair indices.
+        [[nodiscard]] const std::vector<std::size_t>& order();
+        void record(float original_pair_cost, float modified_pair_cost) noexcept;
+        // True once the bound shows, with the configured confidence, that the candidate's
+        // average cost over all pairs is not below the original's. Never true with rule off.
+        [[nodiscard]] bool lost() const noexcept;
+
+        [[nodiscard]] std::size_t scored_count() const noexcept;
+        [[nodiscard]] std::size_t pair_count() const noexcept;
+        // Average of the candidate's costs of the pairs scored so far
+        [[nodiscard]] float modified_average_cost() const noexcept;
+        [[nodiscard]] const RacingOptions& get_options() const noexcept;
+
+        private:
+
+        RacingOptions _options;
+        std::mt19937_64 _random_engine;
+        std::vector<std::size_t> _order;
+        std::size_t _pair_count {};
+        std::size_t _scored_count {};
+        double _original_average_cost {};
+        double _modified_cost_sum {};
+        double _difference_sum {};
+        double _squared_difference_sum {};
+        // log(1 / failure probability of one check), from the union over all checks of a race
+        double _log_inverse_failure_probability {};
+    };
+} // namespace efuzz
+
+#endif // EFUZZ_RACING_HPP
@@ -0,0 +1,319 @@
+#ifndef EFUZZ_SEARCH_ROUTER_HPP
+#define EFUZZ_SEARCH_ROUTER_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <efuzz/deletion_index.hpp>
+#include <efuzz/efuzz.hpp>
+#include <efuzz/index_build.hpp>
+#include <efuzz/qgram_index.hpp>
+
+namespace efuzz {
+    enum class SearchRoute : std::uint8_t {
+        deletion_index,
+        qgram_index,
+        container,
+    };
+
+    struct SearchRouterOptions {
+        constexpr static std::size_t DEFAULT_MAX_DELETION_QUERY_LENGTH {16};
+        constexpr static std::size_t DEFAULT_MIN_QGRAM_QUERY_LENGTH {24};
+
+        // Longer queries go to the q-gram index or the container.
+        std::size_t max_deletion_query_length {DEFAULT_MAX_DELETION_QUERY_LENGTH};
+        // Queries at least this long go to the q-gram index, where the count filter is selective
+        // and the encoder's embeddings lose quality (0 to keep the q-gram index off and empty).
+        std::size_t min_qgram_query_length {DEFAULT_MIN_QGRAM_QUERY_LENGTH};
+        // When the deletion or q-gram index finds fewer than k entries within the edit distance,
+        // the container's results fill the rest.
+        bool fill_from_container {true};
+    };
+
+    // One dictionary behind up to three engines: a DeletionIndex answers short queries exactly
+    // for a small edit distance, a QGramIndex long ones, and the embedding SearchContainer
+    // everything else. All hold the same entries under the same ids. Queries reach the exact
+    // indexes as given; the container's query normalizer only applies on its own route.
+    template <typename SearchContainerT>
+    class SearchRouter {
+        public:
+
+        using StringT = typename SearchContainerT::StringT;
+        using DeletionIndexT = DeletionIndex<StringT>;
+        using QGramIndexT = QGramIndex<StringT>;
+        using string_view_type = typename DeletionIndexT::string_view_type;
+        using this_type = SearchRouter<SearchContainerT>;
+
+        // The exact indexes are built from the container's entries.
+        explicit SearchRouter(SearchContainerT container,
+                              DeletionIndexOptions deletion_index_options = {},
+                              SearchRouterOptions options = {},
+                              QGramIndexOptions qgram_index_options = {});
+
+        this_type& insert(const StringT& string);
+        // Inserts nothing into any engine if one of them throws.
+        this_type& insert(const std::vector<StringT>& strings);
+
+        // Within the max_edit_distance of the deletion or q-gram index where that route is taken.
+        [[nodiscard]] std::vector<SearchResult> search(const StringT& query, std::size_t k) const;
+        [[nodiscard]] std::vector<SearchResult>
+            search(const StringT& query, std::size_t k, std::size_t max_edit_distance) const;
+        // Deletion and q-gram index queries are spread over thread_count threads; the
+        // container's go through its own search_batch.
+        [[nodiscard]] std::vector<std::vector<SearchResult>>
+            search_batch(const std::vector<StringT>& queries, std::size_t k,
+                         std::size_t thread_count = 1) const;
+        // The deletion index for queries up to max_deletion_query_length characters and edit
+        // distances it can answer, the q-gram index for queries of at least
+        // min_qgram_query_length characters, the container otherwise.
+        [[nodiscard]] SearchRoute route(const StringT& query,
+                                        std::size_t max_edit_distance) const;
+
+        [[nodiscard]] string_view_type get(std::size_t id) const;
+        [[nodiscard]] std::size_t size() const;
+        [[nodiscard]] const SearchContainerT& get_container() const;
+        [[nodiscard]] const DeletionIndexT& get_deletion_index() const;
+        [[nodiscard]] const QGramIndexT& get_qgram_index() const;
+
+        private:
+
+        // The edit distance of searches that do not give one: the deletion index's for short
+        // queries, the q-gram index's otherwise.
+        [[nodiscard]] std::size_t default_edit_distance(const StringT& query) const;
+        // Results of the deletion or q-gram index, by route.
+        [[nodiscard]] std::vector<SearchResult> search_exact(const StringT& query, std::size_t k,
+                                                             std::size_t max_edit_distance,
+                                                             SearchRoute exact_route) const;
+
+        // exact_results, then the best of container_results not among them, k at most.
+        [[nodiscard]] static std::vector<SearchResult>
+            fill(std::vector<SearchResult> exact_results,
+                 const std::vector<SearchResult>& container_results, std::size_t k);
+
+        SearchContainerT _container;
+        DeletionIndexT _deletion_index;
+        QGramIndexT _qgram_index;
+        SearchRouterOptions _options;
+    };
+
+    template <typename SearchContainerT>
+    SearchRouter<SearchContainerT>::SearchRouter(SearchContainerT container,
+                                                 DeletionIndexOptions deletion_index_options,
+                                                 SearchRouterOptions options,
+                                                 QGramIndexOptions qgram_index_options) :
+        _container(std::move(container)),
+        _deletion_index(deletion_index_options), _qgram_index(qgram_index_options),
+        _options(options) {
+        std::vector<StringT> strings;
+
+        strings.reserve(_container.size());
+
+        for (std::size_t id {0}; id < _container.size(); ++id) {
+            strings.emplace_back(_container.get(id));
+        }
+
+        _deletion_index.insert(strings);
+
+        if (_options.min_qgram_query_length > 0) {
+            _qgram_index.insert(strings);
+        }
+    }
+
+    template <typename SearchContainerT>
+    auto SearchRouter<SearchContainerT>::insert(const StringT& string) -> this_type& {
+        return insert(std::vector<StringT> {string});
+    }
+
+    template <typename SearchContainerT>
+    auto SearchRouter<SearchContainerT>::insert(const std::vector<StringT>& strings)
+        -> this_type& {
+        const std::size_t first_id = _container.size();
+
+        // Each engine inserts nothing if it throws; the ones before it are truncated back, so
+        // all keep holding the same entries
+        _container.insert(strings);
+
+        try {
+            _deletion_index.insert(strings);
+
+            if (_options.min_qgram_query_length > 0) {
+                _qgram_index.insert(strings);
+            }
+        }
+        catch (...) {
+            _deletion_index.truncate(first_id);
+            _container.truncate(first_id);
+            throw;
+        }
+
+        return *this;
+    }
+
+    template <typename SearchContainerT>
+    std::vector<SearchResult> SearchRouter<SearchContainerT>::search(const StringT& query,
+                                                                     std::size_t k) const {
+        return search(query, k, default_edit_distance(query));
+    }
+
+    template <typename SearchContainerT>
+    std::vector<SearchResult> SearchRouter<SearchContainerT>::search(
+        const StringT& query, std::size_t k, std::size_t max_edit_distance) const {
+        const SearchRoute query_route = route(query, max_edit_distance);
+
+        if (query_route == SearchRoute::container) {
+            return _container.search(query, k);
+        }
+
+        std::vector<SearchResult> results =
+            search_exact(query, k, max_edit_distance, query_route);
+
+        if (results.size() < k && _options.fill_from_container) {
+            return fill(std::move(results), _container.search(query, k), k);
+        }
+
+        return results;
+    }
+
+    template <typename SearchContainerT>
+    std::vector<std::vector<SearchResult>> SearchRouter<SearchContainerT>::search_batch(
+        const std::vector<StringT>& queries, std::size_t k, std::size_t thread_count) const {
+        std::vector<std::vector<SearchResult>> results(queries.size());
+        std::vector<SearchRoute> routes;
+        std::vector<std::size_t> exact_queries;
+
+        routes.reserve(queries.size());
+
+        for (std::size_t index {0}; index < queries.size(); ++index) {
+            routes.push_back(route(queries [index], default_edit_distance(queries [index])));
+
+            if (routes.back() != SearchRoute::container) {
+                exact_queries.push_back(index);
+            }
+        }
+
+        parallel_for_chunks(exact_queries.size(), 1, std::max<std::size_t>(1, thread_count),
+                            [&](std::size_t begin, std::size_t end) {
+                                for (std::size_t position {begin}; position < end; ++position) {
+                                    const std::size_t index = exact_queries [position];
+                                    const StringT& query = queries [index];
+
+                                    results [index] = search_exact(
+                                        query, k, default_edit_distance(query), routes [index]);
+                                }
+                            });
+
+        // Container queries, and exact index queries still short of k results
+        std::vector<std::size_t> container_queries;
+        std::vector<StringT> container_query_strings;
+
+        for (std::size_t index {0}; index < queries.size(); ++index) {
+            if (routes [index] == SearchRoute::container ||
+                (results [index].size() < k && _options.fill_from_container)) {
+                container_queries.push_back(index);
+                container_query_strings.push_back(queries [index]);
+            }
+        }
+
+        std::vector<std::vector<SearchResult>> container_results =
+            _container.search_batch(container_query_strings, k, thread_count);
+
+        for (std::size_t position {0}; position < container_queries.size(); ++position) {
+            auto& query_results = results [container_queries [position]];
+
+            query_results = fill(std::move(query_results), container_results [position], k);
+        }
+
+        return results;
+    }
+
+    template <typename SearchContainerT>
+    SearchRoute SearchRouter<SearchContainerT>::route(const StringT& query,
+                                                      std::size_t max_edit_distance) const {
+        if (query.size() <= _options.max_deletion_query_length &&
+            max_edit_distance <= _deletion_index.get_options().max_edit_distance) {
+            return SearchRoute::deletion_index;
+        }
+
+        if (_options.min_qgram_query_length > 0 &&
+            query.size() >= _options.min_qgram_query_length) {
+            return SearchRoute::qgram_index;
+        }
+
+        return SearchRoute::container;
+    }
+
+    template <typename SearchContainerT>
+    auto SearchRouter<SearchContainerT>::get(std::size_t id) const -> string_view_type {
+        return _deletion_index.get(id);
+    }
+
+    template <typename SearchContainerT>
+    std::size_t SearchRouter<SearchContainerT>::size() const {
+        return _deletion_index.size();
+    }
+
+    template <typename SearchContainerT>
+    const SearchContainerT& SearchRouter<SearchContainerT>::get_container() const {
+        return _container;
+    }
+
+    template <typename SearchContainerT>
+    auto SearchRouter<SearchContainerT>::get_deletion_index() const -> const DeletionIndexT& {
+        return _deletion_index;
+    }
+
+    template <typename SearchContainerT>
+    auto SearchRouter<SearchContainerT>::get_qgram_index() const -> const QGramIndexT& {
+        return _qgram_index;
+    }
+
+    template <typename SearchContainerT>
+    std::size_t SearchRouter<SearchContainerT>::default_edit_distance(const StringT& query) const {
+        if (query.size() <= _options.max_deletion_query_length) {
+            return _deletion_index.get_options().max_edit_distance;
+        }
+
+        return _qgram_index.get_options().max_edit_distance;
+    }
+
+    template <typename SearchContainerT>
+    std::vector<SearchResult>
+        SearchRouter<SearchContainerT>::search_exact(const StringT& query, std::size_t k,
+                                                     std::size_t max_edit_distance,
+                                                     SearchRoute exact_route) const {
+        if (exact_route == SearchRoute::deletion_index) {
+            return _deletion_index.search(query, k, max_edit_distance);
+        }
+
+        return _qgram_index.search(query, k, max_edit_distance);
+    }
+
+    template <typename SearchContainerT>
+    std::vector<SearchResult> SearchRouter<SearchContainerT>::fill(
+        std::vector<SearchResult> exact_results,
+        const std::vector<SearchResult>& container_results, std::size_t k) {
+        std::unordered_set<std::size_t> ids;
+
+        for (const SearchResult& result: exact_results) {
+            ids.insert(result.id);
+        }
+
+        for (const SearchResult& result: container_results) {
+            if (exact_results.size() >= k) {
+                break;
+            }
+
+            if (ids.insert(result.id).second) {
+                exact_results.push_back(result);
+            }
+        }
+
+        return exact_results;
+    }
+} // namespace efuzz
+
+#endif // EFUZZ_SEARCH_ROUTER_HPP
@@ -0,0 +1,263 @@
+#ifndef EFUZZ_SEARCH_SCHEDULER_HPP
+#define EFUZZ_SEARCH_SCHEDULER_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <efuzz/efuzz.hpp>
+
+namespace efuzz {
+    struct SearchSchedulerOptions {
+        constexpr static std::size_t DEFAULT_MAX_BATCH_SIZE {64};
+        constexpr static std::chrono::microseconds DEFAULT_BATCH_WINDOW {200};
+        constexpr static std::size_t DEFAULT_QUEUE_CAPACITY {4096};
+
+        // A batch is dispatched once it holds max_batch_size queries, or batch_window after its
+        // oldest query was submitted, whichever comes first.
+        std::size_t max_batch_size {DEFAULT_MAX_BATCH_SIZE};
+        std::chrono::microseconds batch_window {DEFAULT_BATCH_WINDOW};
+        // Queries waiting for a batch; submit() blocks and try_submit() fails beyond this.
+        std::size_t queue_capacity {DEFAULT_QUEUE_CAPACITY};
+        // Threads for the candidate lookups and reranking of a batch, including the dispatcher.
+        std::size_t lookup_thread_count {1};
+    };
+
+    struct SearchSchedulerStats {
+        std::size_t query_count {};
+        std::size_t batch_count {};
+        std::size_t largest_batch {};
+        std::size_t rejected_count {}; // try_submit() calls refused because the queue was full
+    };
+
+    // Answers searches submitted from any number of threads by grouping them into micro-batches,
+    // so their encodings come from one matrix product per letter instead of one matrix-vector
+    // product per query. The container must outlive the scheduler and must not be modified
+    // while it runs.
+    template <typename SearchContainerT>
+    class SearchScheduler {
+        public:
+
+        using StringT = typename SearchContainerT::StringT;
+        using ResultCallback =
+            std::function<void(std::vector<SearchResult> results, std::exception_ptr exception)>;
+
+        explicit SearchScheduler(const SearchContainerT& container,
+                                 SearchSchedulerOptions options = {});
+        SearchScheduler(const SearchScheduler&) = delete;
+        SearchScheduler& operator=(const SearchScheduler&) = delete;
+        // Answers every query already submitted before returning.
+        ~SearchScheduler();
+
+        // Blocks while the queue is full.
+        [[nodiscard]] std::future<std::vector<SearchResult>> submit(StringT query, std::size_t k);
+        // Calls `callback` from the dispatcher thread with the results, or with the exception
+        // the search threw. The callback must not throw.
+        void submit(StringT query, std::size_t k, ResultCallback callback);
+        // Like submit(), but returns nothing instead of blocking when the queue is full.
+        [[nodiscard]] std::optional<std::future<std::vector<SearchResult>>>
+            try_submit(StringT query, std::size_t k);
+
+        [[nodiscard]] SearchSchedulerStats get_stats() const;
+
+        private:
+
+        using clock = std::chrono::steady_clock;
+
+        struct PendingQuery {
+            StringT query;
+            std::size_t k {};
+            ResultCallback callback;
+            clock::time_point submitted;
+        };
+
+        static std::pair<std::future<std::vector<SearchResult>>, ResultCallback> make_promise();
+        void enqueue(PendingQuery pending_query);
+        void dispatch();
+        void run_batch(std::vector<PendingQuery>& batch);
+
+        const SearchContainerT* _container;
+        SearchSchedulerOptions _options;
+        mutable std::mutex _mutex;
+        std::condition_variable _queue_not_empty;
+        std::condition_variable _queue_not_full;
+        std::deque<PendingQuery> _queue;
+        bool _stopping {};
+        SearchSchedulerStats _stats;
+        std::thread _dispatcher;
+    };
+
+    template <typename SearchContainerT>
+    SearchScheduler<SearchContainerT>::SearchScheduler(const SearchContainerT& container,
+                                                       SearchSchedulerOptions options) :
+        _container(&container),
+        _options(options) {
+        _options.max_batch_size = std::max<std::size_t>(1, _options.max_batch_size);
+        _options.queue_capacity = std::max(_options.queue_capacity, _options.max_batch_size);
+        _dispatcher = std::thread(&SearchScheduler::dispatch, this);
+    }
+
+    template <typename SearchContainerT>
+    SearchScheduler<SearchContainerT>::~SearchScheduler() {
+        {
+            const std::lock_guard lock {_mutex};
+
+            _stopping = true;
+        }
+
+        _queue_not_empty.notify_all();
+        _dispatcher.join();
+    }
+
+    template <typename SearchContainerT>
+    std::future<std::vector<SearchResult>>
+        SearchScheduler<SearchContainerT>::submit(StringT query, std::size_t k) {
+        auto [future, callback] = make_promise();
+
+        submit(std::move(query), k, std::move(callback));
+
+        return std::move(future);
+    }
+
+    template <typename SearchContainerT>
+    void SearchScheduler<SearchContainerT>::submit(StringT query, std::size_t k,
+                                                   ResultCallback callback) {
+        std::unique_lock lock {_mutex};
+
+        _queue_not_full.wait(lock, [this]() { return _queue.size() < _options.queue_capacity; });
+        _queue.push_back(PendingQuery {.query = std::move(query),
+                                       .k = k,
+                                       .callback = std::move(callback),
+                                       .submitted = clock::now()});
+        lock.unlock();
+        _queue_not_empty.notify_one();
+    }
+
+    template <typename SearchContainerT>
+    std::optional<std::future<std::vector<SearchResult>>>
+        SearchScheduler<SearchContainerT>::try_submit(StringT query, std::size_t k) {
+        auto [future, callback] = make_promise();
+        std::unique_lock lock {_mutex};
+
+        if (_queue.size() >= _options.queue_capacity) {
+            ++_stats.rejected_count;
+
+            return std::nullopt;
+        }
+
+        _queue.push_back(PendingQuery {.query = std::move(query),
+                                       .k = k,
+                                       .callback = std::move(callback),
+                                       .submitted = clock::now()});
+        lock.unlock();
+        _queue_not_empty.notify_one();
+
+        return std::move(future);
+    }
+
+    template <typename SearchContainerT>
+    SearchSchedulerStats SearchScheduler<SearchContainerT>::get_stats() const {
+        const std::lock_guard lock {_mutex};
+
+        return _stats;
+    }
+
+    template <typename SearchContainerT>
+    auto SearchScheduler<SearchContainerT>::make_promise()
+        -> std::pair<std::future<std::vector<SearchResult>>, ResultCallback> {
+        auto promise = std::make_shared<std::promise<std::vector<SearchResult>>>();
+        std::future<std::vector<SearchResult>> future = promise->get_future();
+
+        return {std::move(future),
+                [promise](std::vector<SearchResult> results, std::exception_ptr exception) {
+                    if (exception) {
+                        promise->set_exception(exception);
+                    }
+                    else {
+                        promise->set_value(std::move(results));
+                    }
+                }};
+    }
+
+    template <typename SearchContainerT>
+    void SearchScheduler<SearchContainerT>::dispatch() {
+        std::vector<PendingQuery> batch;
+
+        while (true) {
+            std::unique_lock lock {_mutex};
+
+            _queue_not_empty.wait(lock, [this]() { return _stopping || !_queue.empty(); });
+
+            if (_queue.empty()) {
+                return;
+            }
+
+            // Wait for the batch to fill, but never keep its oldest query past the window
+            const clock::time_point deadline = _queue.front().submitted + _options.batch_window;
+
+            _queue_not_empty.wait_until(lock, deadline, [this]() {
+                return _stopping || _queue.size() >= _options.max_batch_size;
+            });
+
+            const std::size_t batch_size = std::min(_queue.size(), _options.max_batch_size);
+
+            batch.assign(std::make_move_iterator(_queue.begin()),
+                         std::make_move_iterator(_queue.begin() + batch_size));
+            _queue.erase(_queue.begin(), _queue.begin() + batch_size);
+            _stats.query_count += batch_size;
+            ++_stats.batch_count;
+            _stats.largest_batch = std::max(_stats.largest_batch, batch_size);
+            lock.unlock();
+            _queue_not_full.notify_all();
+
+            run_batch(batch);
+            batch.clear();
+        }
+    }
+
+    template <typename SearchContainerT>
+    void SearchScheduler<SearchContainerT>::run_batch(std::vector<PendingQuery>& batch) {
+        std::vector<StringT> queries;
+        std::vector<std::size_t> ks;
+
+        queries.reserve(batch.size());
+        ks.reserve(batch.size());
+
+        for (auto& pending_query: batch) {
+            queries.push_back(std::move(pending_query.query));
+            ks.push_back(pending_query.k);
+        }
+
+        std::vector<std::vector<SearchResult>> results;
+
+        try {
+            results = _container->search_batch(queries, ks, _options.lookup_thread_count);
+        }
+        catch (...) {
+            const std::exception_ptr exception = std::current_exception();
+
+            for (auto& pending_query: batch) {
+                pending_query.callback({}, exception);
+            }
+
+            return;
+        }
+
+        for (std::size_t index {0}; index < batch.size(); ++index) {
+            batch [index].callback(std::move(results [index]), nullptr);
+        }
+    }
+} // namespace efuzz
+
+#endif // EFUZZ_SEARCH_SCHEDULER_HPP
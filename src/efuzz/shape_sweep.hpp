@@ -0,0 +1,322 @@
+#ifndef EFUZZ_SHAPE_SWEEP_HPP
+#define EFUZZ_SHAPE_SWEEP_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <cereal/archives/binary.hpp>
+#include <rapidfuzz/fuzz.hpp>
+
+#include <efuzz/distillation.hpp>
+#include <efuzz/efuzz.hpp>
+#include <efuzz/encode.hpp>
+#include <efuzz/string_pool.hpp>
+#include <efuzz/train_encoder.hpp>
+
+namespace efuzz {
+    struct EncoderShape {
+        std::size_t encoding_result_size {};
+        std::vector<std::size_t> hidden_layer_sizes;
+    };
+
+    struct ShapeSweepOptions {
+        constexpr static std::size_t DEFAULT_TRAINING_ROUNDS {100};
+        constexpr static std::size_t DEFAULT_PAIRS_PER_ROUND {256};
+        constexpr static std::size_t DEFAULT_QUERY_COUNT {200};
+
+        // The training budget of every shape: training_rounds calls of train_random() with
+        // pairs_per_round pairs each and a fixed diff scale.
+        std::size_t training_rounds {DEFAULT_TRAINING_ROUNDS};
+        std::size_t pairs_per_round {DEFAULT_PAIRS_PER_ROUND};
+        float diff_scale {0.1F};
+        // Recall is measured on query_count dictionary entries with one random edit each.
+        std::size_t query_count {DEFAULT_QUERY_COUNT};
+        std::size_t candidate_count {SearchContainer<std::string>::DEFAULT_CANDIDATE_COUNT};
+        std::uint64_t seed {};
+    };
+
+    template <typename EncoderT>
+    struct ShapeSweepResult {
+        EncoderShape shape;
+        EncoderT encoder; // Trained
+        std::size_t parameter_count {};
+        std::chrono::nanoseconds encode_latency {}; // Mean per query
+        // Fraction of queries whose best search result scores as well as the best rapidfuzz
+        // match in the whole dictionary.
+        float recall {};
+        float training_cost {}; // Average cost on a fixed set of pairs after training
+        bool pareto_optimal {}; // No other shape is both faster and at least as accurate
+    };
+
+    template <template <typename, typename> class EncoderPolicy, StdString StringT>
+    using SweepEncoder = EncoderPolicy<StringT, std::integral_constant<int, -1>>;
+
+    // Every combination of an encoding size and a list of hidden layer sizes.
+    [[nodiscard]] inline std::vector<EncoderShape>
+        make_shape_grid(const std::vector<std::size_t>& encoding_result_sizes,
+                        const std::vector<std::vector<std::size_t>>& hidden_layer_sizes) {
+        std::vector<EncoderShape> shapes;
+
+        for (const std::size_t encoding_result_size: encoding_result_sizes) {
+            for (const auto& hidden_sizes: hidden_layer_sizes) {
+                shapes.push_back({.encoding_result_size = encoding_result_size,
+                                  .hidden_layer_sizes = hidden_sizes});
+            }
+        }
+
+        return shapes;
+    }
+
+    // Trains a copy of `prototype` for every shape with the same budget and measures its encode
+    // latency and search recall on `dictionary`. Uses the dynamic size encoder, so shapes with
+    // different encoding sizes share one type; the frontier is marked on the returned results.
+    template <template <typename, typename> class EncoderPolicy = Encoder, StdString StringT>
+    [[nodiscard]] std::vector<ShapeSweepResult<SweepEncoder<EncoderPolicy, StringT>>>
+        sweep_encoder_shapes(const std::vector<StringT>& dictionary,
+                             const std::vector<EncoderShape>& shapes,
+                             const ShapeSweepOptions& options = {},
+                             const SweepEncoder<EncoderPolicy, StringT>& prototype = {});
+
+    // Sets pareto_optimal on every result that no other result beats on both encode latency and
+    // recall.
+    template <typename EncoderT>
+    void mark_pareto_frontier(std::vector<ShapeSweepResult<EncoderT>>& results) {
+        for (auto& result: results) {
+            result.pareto_optimal =
+                std::none_of(results.begin(), results.end(), [&result](const auto& other) {
+                    return other.encode_latency <= result.encode_latency &&
+                           other.recall >= result.recall &&
+                           (other.encode_latency < result.encode_latency ||
+                            other.recall > result.recall);
+                });
+        }
+    }
+
+    // The index of the most accurate result that encodes within latency_budget (the faster one
+    // on ties), if any does. A zero budget accepts every result.
+    template <typename EncoderT>
+    [[nodiscard]] std::optional<std::size_t>
+        choose_shape(const std::vector<ShapeSweepResult<EncoderT>>& results,
+                     std::chrono::nanoseconds latency_budget = {}) {
+        std::optional<std::size_t> chosen;
+
+        for (std::size_t index {0}; index < results.size(); ++index) {
+            const auto& result = results [index];
+
+            if (latency_budget.count() > 0 && result.encode_latency > latency_budget) {
+                continue;
+            }
+
+            if (!chosen || result.recall > results [*chosen].recall ||
+                (result.recall == results [*chosen].recall &&
+                 result.encode_latency < results [*chosen].encode_latency)) {
+                chosen = index;
+            }
+        }
+
+        return chosen;
+    }
+
+    // One line per Pareto optimal result, fastest first:
+    // encoding size, hidden layer sizes, parameter count, latency in ns, recall, training cost.
+    template <typename EncoderT>
+    void write_pareto_frontier(std::ostream& stream,
+                               const std::vector<ShapeSweepResult<EncoderT>>& results) {
+        std::vector<const ShapeSweepResult<EncoderT>*> frontier;
+
+        for (const auto& result: results) {
+            if (result.pareto_optimal) {
+                frontier.push_back(&result);
+            }
+        }
+
+        std::sort(frontier.begin(), frontier.end(), [](const auto* left, const auto* right) {
+            return left->encode_latency < right->encode_latency;
+        });
+
+        stream << "encoding_size\thidden_layers\tparameters\tlatency_ns\trecall\tcost\n";
+
+        for (const auto* result: frontier) {
+            stream << result->shape.encoding_result_size << '\t';
+
+            for (std::size_t layer {0}; layer < result->shape.hidden_layer_sizes.size();
+                 ++layer) {
+                stream << (layer > 0 ? "," : "") << result->shape.hidden_layer_sizes [layer];
+            }
+
+            stream << '\t' << result->parameter_count << '\t' << result->encode_latency.count()
+                   << '\t' << result->recall << '\t' << result->training_cost << '\n';
+        }
+    }
+
+    template <typename EncoderT>
+    void save_encoder(const EncoderT& encoder, const std::filesystem::path& filepath) {
+        std::ofstream file {filepath, std::ios::binary};
+
+        cereal::BinaryOutputArchive oarchive {file};
+
+        oarchive(encoder);
+    }
+
+    template <typename EncoderT>
+    [[nodiscard]] EncoderT load_encoder(const std::filesystem::path& filepath) {
+        std::ifstream file {filepath, std::ios::binary};
+
+        if (!file) {
+            throw std::runtime_error("Could not open encoder file");
+        }
+
+        cereal::BinaryInputArchive iarchive {file};
+
+        EncoderT encoder;
+
+        iarchive(encoder);
+
+        return encoder;
+    }
+
+    template <template <typename, typename> class EncoderPolicy, StdString StringT>
+    std::vector<ShapeSweepResult<SweepEncoder<EncoderPolicy, StringT>>>
+        sweep_encoder_shapes(const std::vector<StringT>& dictionary,
+                             const std::vector<EncoderShape>& shapes,
+                             const ShapeSweepOptions& options,
+                             const SweepEncoder<EncoderPolicy, StringT>& prototype) {
+        using EncoderT = SweepEncoder<EncoderPolicy, StringT>;
+        using size_type = std::integral_constant<int, -1>;
+        using char_type = typename StringT::value_type;
+
+        if (dictionary.size() < 2) {
+            throw std::runtime_error("Dictionary too small");
+        }
+
+        std::mt19937_64 random_engine(options.seed);
+        std::uniform_int_distribution<std::size_t> entry(0, dictionary.size() - 1);
+
+        // Every shape is scored on the same pairs (of dictionary ids) and queries
+        std::vector<std::pair<std::size_t, std::size_t>> evaluation_pairs;
+
+        while (evaluation_pairs.size() < options.pairs_per_round) {
+            const std::size_t index_1 = entry(random_engine);
+            const std::size_t index_2 = entry(random_engine);
+
+            if (index_1 != index_2) {
+                evaluation_pairs.emplace_back(index_1, index_2);
+            }
+        }
+
+        std::vector<StringT> queries;
+        std::vector<double> best_scores;
+
+        for (std::size_t query_index {0}; query_index < options.query_count; ++query_index) {
+            StringT query = dictionary [entry(random_engine)];
+            const StringT& letter_source = dictionary [entry(random_engine)];
+            const char_type letter =
+                letter_source.empty()
+                    ? char_type {'a'}
+                    : letter_source [std::uniform_int_distribution<std::size_t>(
+                          0, letter_source.size() - 1)(random_engine)];
+            const std::size_t position =
+                std::uniform_int_distribution<std::size_t>(0, query.size())(random_engine);
+
+            // Substitution, insertion or deletion
+            switch (query.empty() ? 1 : std::uniform_int_distribution<int>(0, 2)(random_engine)) {
+                case 0:
+                    query [std::min(position, query.size() - 1)] = letter;
+                    break;
+                case 1:
+                    query.insert(query.begin() + static_cast<std::ptrdiff_t>(position), letter);
+                    break;
+                default:
+                    query.erase(std::min(position, query.size() - 1), 1);
+                    break;
+            }
+
+            const rapidfuzz::fuzz::CachedRatio<char_type> scorer(query);
+            double best_score {};
+
+            for (const auto& word: dictionary) {
+                best_score = std::max(best_score, scorer.similarity(word));
+            }
+
+            queries.push_back(std::move(query));
+            best_scores.push_back(best_score);
+        }
+
+        const auto dataset = std::make_shared<StringPool<StringT>>(dictionary);
+        const auto diff_scale = [&options](float, float, const auto& /*cost_log*/) {
+            return options.diff_scale;
+        };
+
+        std::vector<ShapeSweepResult<EncoderT>> results;
+
+        for (const auto& shape: shapes) {
+            if (shape.encoding_result_size == 0) {
+                throw std::runtime_error("Encoding result size must be positive");
+            }
+
+            ShapeSweepResult<EncoderT> result {.shape = shape, .encoder = prototype};
+
+            result.encoder.set_encoding_result_size(shape.encoding_result_size);
+
+            std::vector<std::size_t> layer_sizes {result.encoder.get_nn_input_size()};
+
+            layer_sizes.insert(layer_sizes.end(), shape.hidden_layer_sizes.begin(),
+                               shape.hidden_layer_sizes.end());
+            layer_sizes.push_back(result.encoder.get_nn_output_size());
+            result.encoder.set_encoding_nn_layer_sizes(layer_sizes);
+
+            for (std::size_t layer {1}; layer < layer_sizes.size(); ++layer) {
+                result.parameter_count += (layer_sizes [layer - 1] + 1) * layer_sizes [layer];
+            }
+
+            EncoderTrainer<StringT, size_type, EncoderPolicy> trainer(result.encoder, dataset);
+
+            for (std::size_t round {0}; round < options.training_rounds; ++round) {
+                trainer.apply_training_result(
+                    trainer.train_random(options.pairs_per_round, diff_scale));
+            }
+
+            result.encoder = trainer.get_encoder();
+            result.training_cost = trainer.average_cost(evaluation_pairs);
+            result.encode_latency = measure_encode_latency(result.encoder, queries);
+
+            SearchContainer<StringT, size_type, EncoderPolicy> container(result.encoder);
+            std::size_t hits {};
+
+            container.set_candidate_count(options.candidate_count);
+            container.insert(dictionary);
+
+            for (std::size_t query_index {0}; query_index < queries.size(); ++query_index) {
+                const std::vector<SearchResult> found = container.search(queries [query_index], 1);
+
+                if (!found.empty() && found.front().score >= best_scores [query_index]) {
+                    ++hits;
+                }
+            }
+
+            result.recall = queries.empty() ? 0.0F
+                                            : static_cast<float>(hits) /
+                                                  static_cast<float>(queries.size());
+            results.push_back(std::move(result));
+        }
+
+        mark_pareto_frontier(results);
+
+        return results;
+    }
+} // namespace efuzz
+
+#endif // EFUZZ_SHAPE_SWEEP_HPP
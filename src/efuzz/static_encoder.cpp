@@ -0,0 +1,21 @@
+#include <string>
+
+#include <efuzz/static_encoder.hpp>
+
+namespace efuzz {
+    void write_static_encoder(std::ostream& stream, const NeuralNetwork& network,
+                              std::string_view namespace_name, std::string_view string_type) {
+        const std::string guard = static_header_guard(namespace_name);
+
+        stream << "// Generated by efuzz::write_static_encoder. Do not edit.\n"
+               << "#ifndef " << guard << "\n#define " << guard << "\n\n"
+               << "#include <string>\n\n"
+               << "#include <efuzz/static_encoder.hpp>\n\n"
+               << "namespace " << namespace_name << " {\n";
+        write_static_neural_network_definitions(stream, network);
+        stream << "\n    using Encoder = efuzz::StaticEncoder<" << string_type
+               << ", std::remove_cvref_t<decltype(network)>>;\n\n"
+               << "    inline constexpr Encoder encoder {network};\n"
+               << "} // namespace " << namespace_name << "\n\n#endif // " << guard << '\n';
+    }
+} // namespace efuzz
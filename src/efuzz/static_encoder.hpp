@@ -0,0 +1,118 @@
+#ifndef EFUZZ_STATIC_ENCODER_HPP
+#define EFUZZ_STATIC_ENCODER_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <ostream>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
+#include <Eigen/Core>
+
+#include <efuzz/encode.hpp>
+#include <efuzz/neural_network/static_neural_network.hpp>
+
+namespace efuzz {
+    // Evaluates an Encoder exported with write_static_encoder. Encodings match Encoder::encode
+    // for the same network, but nothing is loaded or allocated.
+    template <StdString StringT_, typename StaticNeuralNetworkT>
+    class StaticEncoder {
+        public:
+
+        using StringT = StringT_;
+        using char_type = typename StringT::value_type;
+        using char_encoder_size = std::integral_constant<std::size_t, sizeof(char_type) * 8>;
+        constexpr static std::size_t encoding_result_size {StaticNeuralNetworkT::output_size};
+        using encoding_result_type =
+            Eigen::Vector<float, static_cast<int>(encoding_result_size)>;
+
+        static_assert(StaticNeuralNetworkT::input_size ==
+                          char_encoder_size::value + encoding_result_size,
+                      "Network input must be a letter plus the previous encoding");
+
+        constexpr explicit StaticEncoder(const StaticNeuralNetworkT& network) noexcept :
+            _network(network) {
+        }
+
+        [[nodiscard]] encoding_result_type encode(const StringT& word) const noexcept {
+            std::array<float, StaticNeuralNetworkT::input_size> input {};
+            encoding_result_type encoding_result = encoding_result_type::Zero();
+
+            for (const auto& letter: word) {
+                char_type mask = 1;
+
+                for (std::size_t bit {0}; bit < char_encoder_size::value; ++bit) {
+                    input [bit] = (letter & mask) ? 1.0F : 0.0F;
+                    mask <<= 1;
+                }
+
+                std::copy_n(encoding_result.data(), encoding_result_size,
+                            input.begin() + char_encoder_size::value);
+                _network.compute_into(input.data(), encoding_result.data());
+            }
+
+            return encoding_result;
+        }
+
+        [[nodiscard]] constexpr const StaticNeuralNetworkT& get_network() const noexcept {
+            return _network;
+        }
+
+        private:
+
+        StaticNeuralNetworkT _network;
+    };
+
+    // Writes a header like write_static_neural_network, plus `Encoder`, the StaticEncoder type
+    // for `string_type`, and a constexpr `encoder` instance evaluating the exported network.
+    void write_static_encoder(std::ostream& stream, const NeuralNetwork& network,
+                              std::string_view namespace_name, std::string_view string_type);
+
+    template <typename CharT>
+    [[nodiscard]] constexpr std::string_view string_type_name() {
+        if constexpr (std::is_same_v<CharT, char>) {
+            return "std::string";
+        }
+        else if constexpr (std::is_same_v<CharT, wchar_t>) {
+            return "std::wstring";
+        }
+        else if constexpr (std::is_same_v<CharT, char8_t>) {
+            return "std::u8string";
+        }
+        else if constexpr (std::is_same_v<CharT, char16_t>) {
+            return "std::u16string";
+        }
+        else {
+            static_assert(std::is_same_v<CharT, char32_t>, "Unsupported character type");
+
+            return "std::u32string";
+        }
+    }
+
+    template <StdString StringT, IntegralConstant encoding_result_size>
+    void write_static_encoder(std::ostream& stream,
+                              const Encoder<StringT, encoding_result_size>& encoder,
+                              std::string_view namespace_name) {
+        write_static_encoder(stream, encoder.get_word_vector_encoder_nn(), namespace_name,
+                             string_type_name<typename StringT::value_type>());
+    }
+
+    template <StdString StringT, IntegralConstant encoding_result_size>
+    void write_static_encoder(const std::filesystem::path& filepath,
+                              const Encoder<StringT, encoding_result_size>& encoder,
+                              std::string_view namespace_name) {
+        std::ofstream file {filepath};
+
+        write_static_encoder(file, encoder, namespace_name);
+
+        if (!file) {
+            throw std::runtime_error("Failed to write " + filepath.string());
+        }
+    }
+} // namespace efuzz
+
+#endif // EFUZZ_STATIC_ENCODER_HPP
@@ -0,0 +1,82 @@
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+
+#include <efuzz/step_size.hpp>
+
+namespace efuzz {
+    StepSizeControl::StepSizeControl() : StepSizeControl(StepSizeOptions {}) {
+    }
+
+    StepSizeControl::StepSizeControl(StepSizeOptions options) : _options(options) {
+        if (!(_options.min_scale > 0.0F) || _options.max_scale < _options.min_scale) {
+            throw std::runtime_error("Step size bounds must satisfy 0 < min_scale <= max_scale");
+        }
+
+        if (_options.step_factor <= 1.0F || _options.damping <= 0.0F ||
+            !(_options.target_success_rate > 0.0F && _options.target_success_rate < 1.0F) ||
+            !(_options.success_rate_smoothing > 0.0F && _options.success_rate_smoothing <= 1.0F)) {
+            throw std::runtime_error("Invalid step size adaptation parameters");
+        }
+
+        _options.annealing_period = std::max<std::size_t>(1, _options.annealing_period);
+        reset();
+    }
+
+    void StepSizeControl::record(bool improved) noexcept {
+        const float success = improved ? 1.0F : 0.0F;
+
+        ++_trial_count;
+        _success_rate += _options.success_rate_smoothing * (success - _success_rate);
+
+        switch (_options.rule) {
+            case StepSizeRule::fixed: break;
+            case StepSizeRule::one_fifth_success:
+                _scale *= improved ? _options.step_factor
+                                   : 1.0F / std::pow(_options.step_factor, 0.25F);
+                break;
+            case StepSizeRule::cumulative:
+                _scale *= std::exp((_success_rate - _options.target_success_rate) /
+                                   (_options.damping * (1.0F - _options.target_success_rate)));
+                break;
+            case StepSizeRule::cosine_annealing: {
+                const float progress =
+                    static_cast<float>(_trial_count % _options.annealing_period) /
+                    static_cast<float>(_options.annealing_period);
+                const float cosine = std::cos(std::numbers::pi_v<float> * progress);
+
+                _scale = _options.min_scale +
+                         ((_options.max_scale - _options.min_scale) * 0.5F * (1.0F + cosine));
+                break;
+            }
+        }
+
+        _scale = std::clamp(_scale, _options.min_scale, _options.max_scale);
+    }
+
+    void StepSizeControl::reset() noexcept {
+        _scale = _options.rule == StepSizeRule::cosine_annealing ? _options.max_scale
+                                                                 : _options.initial_scale;
+        _scale = std::clamp(_scale, _options.min_scale, _options.max_scale);
+        // Starting on target keeps the first cumulative updates small
+        _success_rate = _options.target_success_rate;
+        _trial_count = 0;
+    }
+
+    float StepSizeControl::scale() const noexcept {
+        return _scale;
+    }
+
+    float StepSizeControl::success_rate() const noexcept {
+        return _success_rate;
+    }
+
+    std::size_t StepSizeControl::trial_count() const noexcept {
+        return _trial_count;
+    }
+
+    const StepSizeOptions& StepSizeControl::get_options() const noexcept {
+        return _options;
+    }
+} // namespace efuzz
@@ -0,0 +1,80 @@
+#ifndef EFUZZ_STEP_SIZE_HPP
+#define EFUZZ_STEP_SIZE_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include <cereal/cereal.hpp>
+
+namespace efuzz {
+    enum class StepSizeRule : std::uint8_t {
+        fixed, // initial_scale throughout
+        // Grows after every improvement and shrinks after every failure, so the scale settles
+        // where one trial in five improves
+        one_fifth_success,
+        // Steers an exponentially smoothed success rate towards target_success_rate, like the
+        // step-size rule of the (1+1)-CMA-ES
+        cumulative,
+        // Sweeps from max_scale down to min_scale over annealing_period trials, then restarts
+        cosine_annealing,
+    };
+
+    struct StepSizeOptions {
+        constexpr static std::size_t DEFAULT_ANNEALING_PERIOD {1000};
+
+        StepSizeRule rule {StepSizeRule::fixed};
+        float initial_scale {1.0F};
+        // Every rule keeps the scale within these bounds
+        float min_scale {1e-4F};
+        float max_scale {1.0F};
+        // one_fifth_success: factor applied after an improvement; a failure divides by its
+        // fourth root
+        float step_factor {1.5F};
+        // cumulative: the success rate to hold, how fast the smoothed rate follows the trials
+        // and how strongly the scale reacts to a deviation (higher is slower)
+        float target_success_rate {0.2F};
+        float success_rate_smoothing {1.0F / 12.0F};
+        float damping {1.5F};
+        std::size_t annealing_period {DEFAULT_ANNEALING_PERIOD};
+
+        template <typename Archive>
+        void serialize(Archive& archive) {
+            archive(rule, initial_scale, min_scale, max_scale, step_factor, target_success_rate,
+                    success_rate_smoothing, damping, annealing_period);
+        }
+    };
+
+    // Scale of the trial diffs of a training loop, adapted from whether each trial improved the
+    // cost. The state is a few numbers, however long training runs.
+    class StepSizeControl {
+        public:
+
+        StepSizeControl();
+        explicit StepSizeControl(StepSizeOptions options);
+
+        template <typename Archive>
+        void serialize(Archive& archive) {
+            archive(_options, _scale, _success_rate, _trial_count);
+        }
+
+        // Outcome of a trial diff drawn at scale().
+        void record(bool improved) noexcept;
+        // Back to initial_scale, as after construction.
+        void reset() noexcept;
+
+        [[nodiscard]] float scale() const noexcept;
+        // Exponentially smoothed, with success_rate_smoothing as the weight of the latest trial.
+        [[nodiscard]] float success_rate() const noexcept;
+        [[nodiscard]] std::size_t trial_count() const noexcept;
+        [[nodiscard]] const StepSizeOptions& get_options() const noexcept;
+
+        private:
+
+        StepSizeOptions _options;
+        float _scale {1.0F};
+        float _success_rate {};
+        std::size_t _trial_count {};
+    };
+} // namespace efuzz
+
+#endif // EFUZZ_STEP_SIZE_HPP
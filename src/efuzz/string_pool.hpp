@@ -0,0 +1,276 @@
+#ifndef EFUZZ_STRING_POOL_HPP
+#define EFUZZ_STRING_POOL_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <cereal/cereal.hpp>
+#include <cereal/types/string.hpp>
+
+#include <efuzz/encode.hpp>
+
+namespace efuzz {
+    // Append-only string storage: the characters of every string back to back in one buffer,
+    // addressed by id through an offset table. Strings are handed out as views, which stay valid
+    // until the next add. With deduplication, adding a string equal to one already in the pool
+    // returns the existing id.
+    template <StdString StringT_>
+    class StringPool {
+        public:
+
+        using StringT = StringT_;
+        using char_type = typename StringT::value_type;
+        using string_view_type = std::basic_string_view<char_type>;
+        using this_type = StringPool<StringT>;
+
+        StringPool() = default;
+        explicit StringPool(bool deduplicate);
+        explicit StringPool(const std::vector<StringT>& strings, bool deduplicate = false);
+
+        // Same format as std::vector<StringT>, so a pool can load what a vector saved. Whether
+        // the pool deduplicates is not saved.
+        template <typename Archive>
+        void save(Archive& archive) const {
+            archive(cereal::make_size_tag(static_cast<cereal::size_type>(size())));
+
+            for (std::size_t id {0}; id < size(); ++id) {
+                archive(StringT((*this) [id]));
+            }
+        }
+
+        template <typename Archive>
+        void load(Archive& archive) {
+            cereal::size_type string_count {};
+
+            archive(cereal::make_size_tag(string_count));
+            clear();
+
+            StringT string;
+
+            for (cereal::size_type index {0}; index < string_count; ++index) {
+                archive(string);
+                add(string);
+            }
+        }
+
+        // The id of the added string, ids counting up from zero. `string` must not view this
+        // pool.
+        std::size_t add(string_view_type string);
+        // Grows the storage geometrically, so adding many batches stays linear overall.
+        this_type& add_all(const std::vector<StringT>& strings);
+        // Drops every string from id `size` on, so ids handed out before stay valid.
+        this_type& truncate(std::size_t size);
+        this_type& clear();
+        // Reserves exactly the given capacity, like std::vector::reserve.
+        this_type& reserve(std::size_t string_count, std::size_t character_count = 0);
+
+        [[nodiscard]] string_view_type operator[](std::size_t id) const;
+        [[nodiscard]] string_view_type at(std::size_t id) const;
+        // Views of the strings from first_id to the end, in id order.
+        [[nodiscard]] std::vector<string_view_type> views(std::size_t first_id = 0) const;
+        // A hash lookup when deduplicating, a scan otherwise.
+        [[nodiscard]] std::optional<std::size_t> find(string_view_type string) const;
+
+        [[nodiscard]] std::size_t size() const noexcept;
+        [[nodiscard]] bool empty() const noexcept;
+        [[nodiscard]] std::size_t character_count() const noexcept;
+        [[nodiscard]] bool is_deduplicated() const noexcept;
+
+        private:
+
+        // Reserves room for `count` elements, at least doubling the capacity when it grows.
+        template <typename T>
+        static void grow_to(std::vector<T>& elements, std::size_t count);
+
+        std::vector<char_type> _characters;
+        // String id begins at _offsets [id] and ends at _offsets [id + 1]
+        std::vector<std::size_t> _offsets {0};
+        bool _deduplicate {};
+        // Hash of the string to its id; only filled when deduplicating
+        std::unordered_multimap<std::size_t, std::size_t> _index;
+    };
+
+    template <StdString StringT_>
+    StringPool<StringT_>::StringPool(bool deduplicate) : _deduplicate(deduplicate) {
+    }
+
+    template <StdString StringT_>
+    StringPool<StringT_>::StringPool(const std::vector<StringT>& strings, bool deduplicate) :
+        _deduplicate(deduplicate) {
+        add_all(strings);
+    }
+
+    template <StdString StringT_>
+    std::size_t StringPool<StringT_>::add(string_view_type string) {
+        std::size_t hash {};
+
+        if (_deduplicate) {
+            hash = std::hash<string_view_type> {}(string);
+
+            const auto [begin, end] = _index.equal_range(hash);
+
+            for (auto entry = begin; entry != end; ++entry) {
+                if ((*this) [entry->second] == string) {
+                    return entry->second;
+                }
+            }
+        }
+
+        const std::size_t id = size();
+
+        _characters.insert(_characters.end(), string.begin(), string.end());
+        _offsets.push_back(_characters.size());
+
+        if (_deduplicate) {
+            _index.emplace(hash, id);
+        }
+
+        return id;
+    }
+
+    template <StdString StringT_>
+    auto StringPool<StringT_>::add_all(const std::vector<StringT>& strings) -> this_type& {
+        std::size_t added_characters {};
+
+        for (const auto& string: strings) {
+            added_characters += string.size();
+        }
+
+        grow_to(_offsets, _offsets.size() + strings.size());
+        grow_to(_characters, _characters.size() + added_characters);
+
+        for (const auto& string: strings) {
+            add(string);
+        }
+
+        return *this;
+    }
+
+    template <StdString StringT_>
+    auto StringPool<StringT_>::truncate(std::size_t size) -> this_type& {
+        if (size >= this->size()) {
+            return *this;
+        }
+
+        if (_deduplicate) {
+            for (auto entry = _index.begin(); entry != _index.end();) {
+                entry = entry->second >= size ? _index.erase(entry) : std::next(entry);
+            }
+        }
+
+        _characters.resize(_offsets [size]);
+        _offsets.resize(size + 1);
+
+        return *this;
+    }
+
+    template <StdString StringT_>
+    auto StringPool<StringT_>::clear() -> this_type& {
+        _characters.clear();
+        _offsets.assign(1, 0);
+        _index.clear();
+
+        return *this;
+    }
+
+    template <StdString StringT_>
+    auto StringPool<StringT_>::reserve(std::size_t string_count, std::size_t character_count)
+        -> this_type& {
+        _offsets.reserve(string_count + 1);
+        _characters.reserve(character_count);
+
+        return *this;
+    }
+
+    template <StdString StringT_>
+    template <typename T>
+    void StringPool<StringT_>::grow_to(std::vector<T>& elements, std::size_t count) {
+        if (count > elements.capacity()) {
+            elements.reserve(std::max(2 * elements.capacity(), count));
+        }
+    }
+
+    template <StdString StringT_>
+    auto StringPool<StringT_>::operator[](std::size_t id) const -> string_view_type {
+        assert(id < size());
+
+        return string_view_type(_characters.data() + _offsets [id],
+                                _offsets [id + 1] - _offsets [id]);
+    }
+
+    template <StdString StringT_>
+    auto StringPool<StringT_>::at(std::size_t id) const -> string_view_type {
+        if (id >= size()) {
+            throw std::out_of_range("String id out of range");
+        }
+
+        return (*this) [id];
+    }
+
+    template <StdString StringT_>
+    auto StringPool<StringT_>::views(std::size_t first_id) const
+        -> std::vector<string_view_type> {
+        std::vector<string_view_type> string_views;
+
+        string_views.reserve(size() - std::min(first_id, size()));
+
+        for (std::size_t id {first_id}; id < size(); ++id) {
+            string_views.push_back((*this) [id]);
+        }
+
+        return string_views;
+    }
+
+    template <StdString StringT_>
+    auto StringPool<StringT_>::find(string_view_type string) const -> std::optional<std::size_t> {
+        if (_deduplicate) {
+            const auto [begin, end] = _index.equal_range(std::hash<string_view_type> {}(string));
+
+            for (auto entry = begin; entry != end; ++entry) {
+                if ((*this) [entry->second] == string) {
+                    return entry->second;
+                }
+            }
+
+            return std::nullopt;
+        }
+
+        for (std::size_t id {0}; id < size(); ++id) {
+            if ((*this) [id] == string) {
+                return id;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    template <StdString StringT_>
+    std::size_t StringPool<StringT_>::size() const noexcept {
+        return _offsets.size() - 1;
+    }
+
+    template <StdString StringT_>
+    bool StringPool<StringT_>::empty() const noexcept {
+        return size() == 0;
+    }
+
+    template <StdString StringT_>
+    std::size_t StringPool<StringT_>::character_count() const noexcept {
+        return _characters.size();
+    }
+
+    template <StdString StringT_>
+    bool StringPool<StringT_>::is_deduplicated() const noexcept {
+        return _deduplicate;
+    }
+} // namespace efuzz
+
+#endif // EFUZZ_STRING_POOL_HPP
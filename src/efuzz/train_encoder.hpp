@@ -1,24 +1,74 @@
 #ifndef EFUZZ_TRAIN_ENCODER_HPP
 #define EFUZZ_TRAIN_ENCODER_HPP
 
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <memory>
 #include <optional>
 #include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
 
 #include <cereal/cereal.hpp>
 #include <cereal/types/memory.hpp>
 #include <cereal/types/optional.hpp>
 #include <cereal/types/vector.hpp>
+#include <Eigen/Core>
 #include <rapidfuzz/fuzz.hpp>
 
 #include <efuzz/encode.hpp>
 #include <efuzz/neural_network/neural_network.hpp>
-#include <vector>
+#include <efuzz/racing.hpp>
+#include <efuzz/step_size.hpp>
+#include <efuzz/string_pool.hpp>
 
 namespace efuzz {
+    template <typename TrainerT>
+    class TrainingCoordinator;
+
+    // EncoderTrainer::TrainingResult; outside the template so CEREAL_CLASS_VERSION can name it.
+    struct EncoderTrainingResult {
+        // cereal class version 1 added rejected_early and scored_pairs. Results saved before
+        // it carry no version at all and are not readable; loading one throws cereal::Exception.
+        constexpr static std::uint32_t SERIALIZATION_VERSION {1};
+
+        std::optional<NeuralNetwork::NeuralNetworkDiff> diff;
+        float original_cost {};
+        float modified_cost {};
+        // Racing stopped scoring the diff before the last pair; modified_cost then averages the
+        // scored_pairs that were scored.
+        bool rejected_early {};
+        std::size_t scored_pairs {};
+
+        template <typename Archive>
+        void serialize(Archive& archive, const std::uint32_t version) {
+            if (version != SERIALIZATION_VERSION) {
+                throw cereal::Exception("Unsupported training result archive version");
+            }
+
+            archive(diff, original_cost, modified_cost, rejected_early, scored_pairs);
+        }
+    };
+
+    // Written first by EncoderTrainer::serialize to carry its cereal class version, which
+    // CEREAL_CLASS_VERSION cannot give a class template.
+    struct EncoderTrainerArchiveVersion {
+        constexpr static std::uint32_t CURRENT {1};
+
+        std::uint32_t value {};
+
+        template <typename Archive>
+        void serialize(Archive& /*archive*/, const std::uint32_t version) {
+            value = version;
+        }
+    };
+
     template <StdString StringT_,
-              IntegralConstant encoding_result_size_ = std::integral_constant<int, -1>>
+              IntegralConstant encoding_result_size_ = std::integral_constant<int, -1>,
+              template <typename, typename> class EncoderPolicy_ = Encoder>
     class EncoderTrainer {
         public:
 
@@ -33,13 +83,32 @@ namespace efuzz {
             }
         };
 
-        using this_type = EncoderTrainer<StringT_, encoding_result_size_>;
+        using this_type = EncoderTrainer<StringT_, encoding_result_size_, EncoderPolicy_>;
         using StringT = StringT_;
-        using DatasetT = std::shared_ptr<std::vector<StringT>>;
-        using EncoderT = Encoder<StringT, encoding_result_size_>;
+        // Shared, so trainers of several encoders can train on one copy of the strings
+        using DatasetT = std::shared_ptr<StringPool<StringT>>;
+        using EncoderT = EncoderPolicy_<StringT, encoding_result_size_>;
+        using char_type = typename StringT::value_type;
+        using string_view_type = typename StringPool<StringT>::string_view_type;
+        // Ids of two dataset entries
+        using IdPair = std::pair<std::size_t, std::size_t>;
+        // Overrides the step size control for the train call it is passed to.
         using DiffScalarFunction =
             std::function<float(float training_iterations, float encoder_nn_edits,
-                                std::vector<CostLogDatapoint> cost_log)>;
+                                const std::vector<CostLogDatapoint>& cost_log)>;
+        // What the normalized embedding distance of a pair is trained towards. Unset, that is
+        // rapidfuzz::fuzz::ratio / 100; see DistillationTarget for matching another encoder.
+        // average_cost() assumes it is symmetric.
+        using TargetFunction =
+            std::function<float(string_view_type string_1, string_view_type string_2)>;
+        // Draws the pair_count dataset pairs of a train_random call or a distributed training
+        // round, e.g. HardPairSampler::as_pair_sampler(). Unset, pairs are uniform.
+        using PairSampler =
+            std::function<std::vector<IdPair>(const this_type& trainer, std::size_t pair_count)>;
+
+        // Side of the square blocks of pairs average_cost() evaluates at a time; a block of
+        // distances and one of targets stay in L2 cache.
+        constexpr static std::size_t ALL_PAIRS_TILE_SIZE {128};
 
         EncoderTrainer() = default;
         EncoderTrainer(const EncoderTrainer&) = default;
@@ -49,35 +118,67 @@ namespace efuzz {
 
         explicit EncoderTrainer(EncoderT encoder);
         explicit EncoderTrainer(EncoderT encoder, DatasetT dataset);
+        explicit EncoderTrainer(EncoderT encoder, const std::vector<StringT>& dataset);
 
+        // cereal class version 1 added the pruning flag. Archives written before it carry no
+        // version at all and are not readable; loading one throws cereal::Exception.
         template <typename Archive>
         void serialize(Archive& archive) {
-            archive(_encoder, _dataset, _training_iterations, _cost_log, _encoder_nn_edits);
+            EncoderTrainerArchiveVersion version;
+
+            archive(version);
+
+            if (version.value != EncoderTrainerArchiveVersion::CURRENT) {
+                throw cereal::Exception("Unsupported EncoderTrainer archive version");
+            }
+
+            archive(_encoder, _dataset, _training_iterations, _cost_log, _encoder_nn_edits,
+                    _preserve_sparsity);
         }
 
         void set_dataset(DatasetT dataset);
+        void set_dataset(const std::vector<StringT>& dataset);
         void add_to_dataset(const StringT& string, bool reset_training_iterations = false);
         void add_to_dataset(const std::vector<StringT>& strings,
                             bool reset_training_iterations = false);
         EncoderT get_encoder() const;
+        // An empty pool, not shared with the trainer, if no dataset is set.
         DatasetT get_dataset() const;
         [[nodiscard]] std::size_t get_training_iterations() const;
         [[nodiscard]] std::size_t get_encoder_nn_edits_count() const;
         [[nodiscard]] std::vector<CostLogDatapoint> get_cost_log() const;
         this_type& clear_cost_log();
-
-        [[nodiscard]] float cost(const StringT& string_1, const StringT& string_2);
-
-        struct TrainingResult {
-            std::optional<NeuralNetwork::NeuralNetworkDiff> diff;
-            float original_cost {};
-            float modified_cost {};
-
-            template <typename Archive>
-            void serialize(Archive& archive) {
-                archive(diff, original_cost, modified_cost);
-            }
-        };
+        // Not serialized; set it again after loading a trainer.
+        this_type& set_target_function(TargetFunction target_function);
+        [[nodiscard]] bool has_target_function() const;
+        // Used by train_random and TrainingCoordinator::train; the train overloads given their
+        // pairs and train_all, which trains on every pair, do not sample. Not serialized; set it
+        // again after loading a trainer.
+        this_type& set_pair_sampler(PairSampler pair_sampler);
+        [[nodiscard]] bool has_pair_sampler() const;
+        // Scales the trial diffs of every train call that gets no DiffScalarFunction, adapting
+        // the scale to whether the trials improve the cost. Unset, diffs are not scaled. Not
+        // serialized; set it again after loading a trainer.
+        this_type& set_step_size_control(StepSizeOptions options);
+        [[nodiscard]] const StepSizeControl& get_step_size_control() const;
+        // Lets the train functions on pair lists stop scoring a trial diff once it is bound to
+        // lose (see RacingRule), in random pair order. Unset, every pair is scored. Not
+        // serialized; set it again after loading a trainer.
+        this_type& set_racing(RacingOptions options);
+        [[nodiscard]] const CandidateRace& get_racing() const;
+
+        // What cost() compares the normalized embedding distance of a pair with: the target
+        // function, or else rapidfuzz::fuzz::ratio / 100.
+        [[nodiscard]] float target(string_view_type string_1, string_view_type string_2) const;
+        [[nodiscard]] float cost(string_view_type string_1, string_view_type string_2);
+        [[nodiscard]] float
+            average_cost(const std::vector<std::pair<StringT, StringT>>& string_pairs);
+        [[nodiscard]] float average_cost(const std::vector<IdPair>& id_pairs);
+        // Average cost over every pair of distinct dataset entries. Both orders of a pair cost the
+        // same, so each pair is evaluated once; a target function must be symmetric too.
+        [[nodiscard]] float average_cost();
+
+        using TrainingResult = EncoderTrainingResult;
 
         TrainingResult
             train(const StringT& string_1, const StringT& string_2,
@@ -85,6 +186,10 @@ namespace efuzz {
         TrainingResult
             train(const std::vector<std::pair<StringT, StringT>>& string_pairs,
                   const std::optional<DiffScalarFunction>& diff_scalar_function = std::nullopt);
+        // Like the string pair overload, for pairs of dataset entries.
+        TrainingResult
+            train(const std::vector<IdPair>& id_pairs,
+                  const std::optional<DiffScalarFunction>& diff_scalar_function = std::nullopt);
         TrainingResult train_random(
             std::size_t iterations,
             const std::optional<DiffScalarFunction>& diff_scalar_function = std::nullopt);
@@ -94,217 +199,438 @@ namespace efuzz {
         this_type& modify_encoder(const NeuralNetwork::NeuralNetworkDiff& diff);
         bool apply_training_result(const TrainingResult& training_result);
 
+        // Prunes the encoder network (see NeuralNetwork::prune_neurons / prune_weights). Once
+        // weights have been pruned, later training diffs leave the pruned weights at zero so
+        // fine-tuning keeps the network sparse.
+        this_type& prune_encoder(float weight_fraction, float neuron_fraction = 0.0F);
+
+        // Deterministic counterpart of the diffs drawn by the train functions, so a diff can be
+        // shared between processes as just (seed, scale).
+        [[nodiscard]] NeuralNetwork::NeuralNetworkDiff make_diff(std::uint64_t seed,
+                                                                 float scale = 1.0F) const;
+        // The function's value if one is given, else the step size control's current scale.
+        [[nodiscard]] float
+            diff_scale(const std::optional<DiffScalarFunction>& diff_scalar_function) const;
+
         private:
 
+        template <typename TrainerT>
+        friend class TrainingCoordinator;
+
+        NeuralNetwork::NeuralNetworkDiff
+            make_diff(const NeuralNetwork& encoder_nn,
+                      const std::optional<DiffScalarFunction>& diff_scalar_function) const;
+        // Costs a random diff with `evaluate`, the average cost of the pair_count pairs being
+        // trained on, before and after applying it; the encoder is left unmodified.
+        template <typename EvaluateT>
+        TrainingResult try_diff(const EvaluateT& evaluate, std::size_t pair_count,
+                                const std::optional<DiffScalarFunction>& diff_scalar_function);
+        // try_diff over pair_count pairs, costed one at a time by pair_cost(index), racing the
+        // diff against the original network when racing is set
+        template <typename PairCostT>
+        TrainingResult race_diff(std::size_t pair_count, const PairCostT& pair_cost,
+                                 const std::optional<DiffScalarFunction>& diff_scalar_function);
+        // The dataset; throws unless it holds at least two entries
+        const StringPool<StringT>& training_dataset() const;
+
         EncoderT _encoder;
         std::optional<DatasetT> _dataset;
         std::size_t _training_iterations {};
         std::size_t _encoder_nn_edits {};
         std::vector<CostLogDatapoint> _cost_log;
+        bool _preserve_sparsity {};
+        TargetFunction _target_function;
+        PairSampler _pair_sampler;
+        StepSizeControl _step_size_control;
+        CandidateRace _racing;
+        // Original network's cost of every pair of a race; scratch space, not serialized
+        std::vector<float> _original_pair_costs;
+        // Encoder parameters from before a trial diff; scratch space, not serialized
+        NeuralNetwork::ParameterBuffer _parameter_snapshot;
     };
 
-    template <StdString StringT_, IntegralConstant encoding_result_size_>
-    EncoderTrainer<StringT_, encoding_result_size_>::EncoderTrainer(EncoderT encoder) :
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    EncoderTrainer<StringT_, encoding_result_size_, EncoderPolicy_>::EncoderTrainer(
+        EncoderT encoder) :
         _encoder(encoder) {
     }
 
-    template <StdString StringT_, IntegralConstant encoding_result_size_>
-    EncoderTrainer<StringT_, encoding_result_size_>::EncoderTrainer(EncoderT encoder,
-                                                                    DatasetT dataset) :
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    EncoderTrainer<StringT_, encoding_result_size_, EncoderPolicy_>::EncoderTrainer(
+        EncoderT encoder, DatasetT dataset) :
         _encoder(encoder),
         _dataset(dataset) {
     }
 
-    template <StdString StringT_, IntegralConstant encoding_result_size_>
-    void EncoderTrainer<StringT_, encoding_result_size_>::set_dataset(DatasetT dataset) {
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    EncoderTrainer<StringT_, encoding_result_size_, EncoderPolicy_>::EncoderTrainer(
+        EncoderT encoder, const std::vector<StringT>& dataset) :
+        _encoder(encoder),
+        _dataset(std::make_shared<StringPool<StringT>>(dataset)) {
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    void EncoderTrainer<StringT_, encoding_result_size_, EncoderPolicy_>::set_dataset(
+        DatasetT dataset) {
         _dataset = dataset;
         _training_iterations = 0;
     }
 
-    template <StdString StringT_, IntegralConstant encoding_result_size_>
-    void EncoderTrainer<StringT_, encoding_result_size_>::add_to_dataset(
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    void EncoderTrainer<StringT_, encoding_result_size_, EncoderPolicy_>::set_dataset(
+        const std::vector<StringT>& dataset) {
+        set_dataset(std::make_shared<StringPool<StringT>>(dataset));
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    void EncoderTrainer<StringT_, encoding_result_size_, EncoderPolicy_>::add_to_dataset(
         const StringT& string, bool reset_training_iterations) {
         if (!_dataset) {
-            _dataset = std::make_shared<std::vector<StringT>>();
+            _dataset = std::make_shared<StringPool<StringT>>();
         }
-        _dataset->push_back(string);
+
+        _dataset.value()->add(string);
 
         if (reset_training_iterations) {
             _training_iterations = 0;
         }
     }
 
-    template <StdString StringT_, IntegralConstant encoding_result_size_>
-    void EncoderTrainer<StringT_, encoding_result_size_>::add_to_dataset(
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    void EncoderTrainer<StringT_, encoding_result_size_, EncoderPolicy_>::add_to_dataset(
         const std::vector<StringT>& strings, bool reset_training_iterations) {
         if (!_dataset) {
-            _dataset = std::make_shared<std::vector<StringT>>();
+            _dataset = std::make_shared<StringPool<StringT>>();
         }
 
-        _dataset->insert(_dataset->end(), strings.begin(), strings.end());
+        _dataset.value()->add_all(strings);
 
         if (reset_training_iterations) {
             _training_iterations = 0;
         }
     }
 
-    template <StdString StringT_, IntegralConstant encoding_result_size_>
-    Encoder<StringT_, encoding_result_size_>
-        EncoderTrainer<StringT_, encoding_result_size_>::get_encoder() const {
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    auto EncoderTrainer<StringT_, encoding_result_size_, EncoderPolicy_>::get_encoder() const
+        -> EncoderT {
         return _encoder;
     }
 
-    template <StdString StringT_, IntegralConstant encoding_result_size_>
-    typename EncoderTrainer<StringT_, encoding_result_size_>::DatasetT
-        EncoderTrainer<StringT_, encoding_result_size_>::get_dataset() const {
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    typename EncoderTrainer<StringT_, encoding_result_size_, EncoderPolicy_>::DatasetT
+        EncoderTrainer<StringT_, encoding_result_size_, EncoderPolicy_>::get_dataset() const {
         if (!_dataset) {
-            _dataset = std::make_shared<std::vector<StringT>>();
+            return std::make_shared<StringPool<StringT>>();
         }
 
-        return _dataset;
+        return _dataset.value();
     }
 
-    template <StdString StringT_, IntegralConstant encoding_result_size_>
-    std::size_t EncoderTrainer<StringT_, encoding_result_size_>::get_training_iterations() const {
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    std::size_t
+        EncoderTrainer<StringT_, encoding_result_size_,
+                       EncoderPolicy_>::get_training_iterations() const {
         return _training_iterations;
     }
 
-    template <StdString StringT_, IntegralConstant encoding_result_size_>
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
     std::size_t
-        EncoderTrainer<StringT_, encoding_result_size_>::get_encoder_nn_edits_count() const {
+        EncoderTrainer<StringT_, encoding_result_size_,
+                       EncoderPolicy_>::get_encoder_nn_edits_count() const {
         return _encoder_nn_edits;
     }
 
-    template <StdString StringT_, IntegralConstant encoding_result_size_>
-    std::vector<typename EncoderTrainer<StringT_, encoding_result_size_>::CostLogDatapoint>
-        EncoderTrainer<StringT_, encoding_result_size_>::get_cost_log() const {
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    auto EncoderTrainer<StringT_, encoding_result_size_, EncoderPolicy_>::get_cost_log() const
+        -> std::vector<CostLogDatapoint> {
         return _cost_log;
     }
 
-    template <StdString StringT_, IntegralConstant encoding_result_size_>
-    auto EncoderTrainer<StringT_, encoding_result_size_>::clear_cost_log() -> this_type& {
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    auto EncoderTrainer<StringT_, encoding_result_size_, EncoderPolicy_>::clear_cost_log()
+        -> this_type& {
         _cost_log.clear();
 
         return *this;
     }
 
-    template <StdString StringT_, IntegralConstant encoding_result_size_>
-    float EncoderTrainer<StringT_, encoding_result_size_>::cost(const StringT& string_1,
-                                                                const StringT& string_2) {
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    auto EncoderTrainer<StringT_, encoding_result_size_, EncoderPolicy_>::set_target_function(
+        TargetFunction target_function) -> this_type& {
+        _target_function = std::move(target_function);
+
+        return *this;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    bool
+        EncoderTrainer<StringT_, encoding_result_size_,
+                       EncoderPolicy_>::has_target_function() const {
+        return static_cast<bool>(_target_function);
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    auto EncoderTrainer<StringT_, encoding_result_size_, EncoderPolicy_>::set_pair_sampler(
+        PairSampler pair_sampler) -> this_type& {
+        _pair_sampler = std::move(pair_sampler);
+
+        return *this;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    bool EncoderTrainer<StringT_, encoding_result_size_, EncoderPolicy_>::has_pair_sampler()
+        const {
+        return static_cast<bool>(_pair_sampler);
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    auto EncoderTrainer<StringT_, encoding_result_size_, EncoderPolicy_>::set_step_size_control(
+        StepSizeOptions options) -> this_type& {
+        _step_size_control = StepSizeControl(options);
+
+        return *this;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    auto
+        EncoderTrainer<StringT_, encoding_result_size_,
+                       EncoderPolicy_>::get_step_size_control() const -> const StepSizeControl& {
+        return _step_size_control;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    auto EncoderTrainer<StringT_, encoding_result_size_, EncoderPolicy_>::set_racing(
+        RacingOptions options) -> this_type& {
+        _racing = CandidateRace(options);
+
+        return *this;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    auto EncoderTrainer<StringT_, encoding_result_size_, EncoderPolicy_>::get_racing() const
+        -> const CandidateRace& {
+        return _racing;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    float EncoderTrainer<StringT_, encoding_result_size_, EncoderPolicy_>::cost(
+        string_view_type string_1, string_view_type string_2) {
         const auto encoded_1 = _encoder.encode(string_1);
         const auto encoded_2 = _encoder.encode(string_2);
         const float max_normalized_difference = _encoder.output_norm_max();
         const float encoded_normalized_difference =
             (encoded_1 - encoded_2).norm() / max_normalized_difference;
 
+        return std::abs(encoded_normalized_difference - target(string_1, string_2));
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    float EncoderTrainer<StringT_, encoding_result_size_, EncoderPolicy_>::target(
+        string_view_type string_1, string_view_type string_2) const {
+        if (_target_function) {
+            return _target_function(string_1, string_2);
+        }
+
         constexpr float max_rapidfuzz_difference = 100.0F;
-        const float rapidfuzz_difference =
-            rapidfuzz::fuzz::ratio(string_1, string_2) / max_rapidfuzz_difference;
 
-        return std::abs(encoded_normalized_difference - rapidfuzz_difference);
+        return static_cast<float>(rapidfuzz::fuzz::ratio(string_1, string_2)) /
+               max_rapidfuzz_difference;
     }
 
-    template <StdString StringT_, IntegralConstant encoding_result_size_>
-    typename EncoderTrainer<StringT_, encoding_result_size_>::TrainingResult
-        EncoderTrainer<StringT_, encoding_result_size_>::train(
-            const StringT& string_1, const StringT& string_2,
-            const std::optional<DiffScalarFunction>& diff_scalar_function) { // Non-wrapped
-        const NeuralNetwork original_encoder_nn = _encoder.get_word_vector_encoder_nn();
-        const float original_cost = cost(string_1, string_2);
-
-        const NeuralNetwork::NeuralNetworkDiff random_diff = original_encoder_nn.random_diff();
-        const NeuralNetwork::NeuralNetworkDiff diff =
-            diff_scalar_function.has_value()
-                ? random_diff * diff_scalar_function.value()(_training_iterations,
-                                                             _encoder_nn_edits, _cost_log)
-                : random_diff;
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    float EncoderTrainer<StringT_, encoding_result_size_, EncoderPolicy_>::average_cost(
+        const std::vector<std::pair<StringT, StringT>>& string_pairs) {
+        float total_cost {};
 
-        modify_encoder(diff);
+        for (const auto& [string_1, string_2]: string_pairs) {
+            total_cost += cost(string_1, string_2);
+        }
 
-        const float modified_cost = cost(string_1, string_2);
+        return total_cost / string_pairs.size();
+    }
 
-        _encoder.set_word_vector_encoder_nn(original_encoder_nn);
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    float EncoderTrainer<StringT_, encoding_result_size_, EncoderPolicy_>::average_cost(
+        const std::vector<IdPair>& id_pairs) {
+        const StringPool<StringT>& dataset = training_dataset();
+        float total_cost {};
 
-        if (modified_cost < original_cost) {
-            return TrainingResult {
-                .diff = diff, .original_cost = original_cost, .modified_cost = modified_cost};
+        for (const auto& [id_1, id_2]: id_pairs) {
+            total_cost += cost(dataset.at(id_1), dataset.at(id_2));
         }
 
-        return TrainingResult {.original_cost = original_cost, .modified_cost = modified_cost};
+        return total_cost / id_pairs.size();
     }
 
-    template <StdString StringT_, IntegralConstant encoding_result_size_>
-    typename EncoderTrainer<StringT_, encoding_result_size_>::TrainingResult
-        EncoderTrainer<StringT_, encoding_result_size_>::train(
-            const std::vector<std::pair<StringT, StringT>>& string_pairs,
-            const std::optional<DiffScalarFunction>& diff_scalar_function) { // Non-wrapped
-        if (string_pairs.empty()) {
-            throw std::runtime_error("Empty string pairs provided");
-        }
-        _training_iterations++;
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    float EncoderTrainer<StringT_, encoding_result_size_, EncoderPolicy_>::average_cost() {
+        const StringPool<StringT>& dataset = training_dataset();
+        const std::size_t dataset_size = dataset.size();
+        // All embeddings at once, one column per entry
+        const Eigen::MatrixXf encodings = _encoder.encode_batch(dataset.views());
+        const Eigen::VectorXf squared_norms = encodings.colwise().squaredNorm().transpose();
+        const float max_normalized_difference = _encoder.output_norm_max();
+        constexpr float max_rapidfuzz_difference = 100.0F;
+        const auto size = static_cast<Eigen::Index>(dataset_size);
+        const auto tile = static_cast<Eigen::Index>(ALL_PAIRS_TILE_SIZE);
 
-        const NeuralNetwork original_encoder_nn = _encoder.get_word_vector_encoder_nn();
+        std::vector<rapidfuzz::fuzz::CachedRatio<char_type>> scorers;
+        Eigen::MatrixXf distances;
+        Eigen::MatrixXf targets;
+        double total_cost {};
 
-        float average_cost_of_unmodified_encoder {};
+        // Only the tiles on and above the diagonal, and within the diagonal tiles only the pairs
+        // with row < column
+        for (Eigen::Index row_begin {0}; row_begin < size; row_begin += tile) {
+            const Eigen::Index rows = std::min(tile, size - row_begin);
 
-        for (const auto& [string_1, string_2]: string_pairs) {
-            const float cost =
-                EncoderTrainer<StringT_, encoding_result_size_>::cost(string_1, string_2);
+            scorers.clear();
 
-            average_cost_of_unmodified_encoder += cost;
-        }
+            if (!_target_function) {
+                for (Eigen::Index row {0}; row < rows; ++row) {
+                    scorers.emplace_back(dataset [row_begin + row]);
+                }
+            }
 
-        average_cost_of_unmodified_encoder /= string_pairs.size();
+            for (Eigen::Index column_begin {row_begin}; column_begin < size;
+                 column_begin += tile) {
+                const Eigen::Index columns = std::min(tile, size - column_begin);
+
+                // |a - b|^2 = |a|^2 + |b|^2 - 2 a.b, with every a.b of the tile from one product
+                distances.noalias() = encodings.middleCols(row_begin, rows).transpose() *
+                                      encodings.middleCols(column_begin, columns);
+                distances = ((distances * -2.0F).colwise() +
+                             squared_norms.segment(row_begin, rows))
+                                .rowwise() +
+                            squared_norms.segment(column_begin, columns).transpose();
+                // Rounding can take the difference of nearly equal encodings below zero
+                distances = distances.cwiseMax(0.0F).cwiseSqrt() / max_normalized_difference;
+
+                targets.resize(rows, columns);
+
+                for (Eigen::Index column {0}; column < columns; ++column) {
+                    const string_view_type string_2 = dataset [column_begin + column];
+
+                    for (Eigen::Index row {0}; row < rows; ++row) {
+                        if (row_begin + row >= column_begin + column) {
+                            // Costs nothing, so the pair drops out of the sum below
+                            targets(row, column) = distances(row, column);
+                        }
+                        else if (_target_function) {
+                            targets(row, column) =
+                                _target_function(dataset [row_begin + row], string_2);
+                        }
+                        else {
+                            targets(row, column) =
+                                static_cast<float>(scorers [row].similarity(string_2)) /
+                                max_rapidfuzz_difference;
+                        }
+                    }
+                }
 
-        const NeuralNetwork::NeuralNetworkDiff random_diff = original_encoder_nn.random_diff();
-        const NeuralNetwork::NeuralNetworkDiff diff =
-            diff_scalar_function.has_value()
-                ? random_diff * diff_scalar_function.value()(_training_iterations,
-                                                             _encoder_nn_edits, _cost_log)
-                : random_diff;
+                total_cost += (distances - targets).cwiseAbs().sum();
+            }
+        }
 
-        modify_encoder(diff);
+        const std::size_t comparisons = dataset_size * (dataset_size - 1) / 2;
 
-        float average_cost_of_modified_encoder {};
+        return static_cast<float>(total_cost / static_cast<double>(comparisons));
+    }
 
-        for (const auto& [string_1, string_2]: string_pairs) {
-            const float cost =
-                EncoderTrainer<StringT_, encoding_result_size_>::cost(string_1, string_2);
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    typename EncoderTrainer<StringT_, encoding_result_size_, EncoderPolicy_>::TrainingResult
+        EncoderTrainer<StringT_, encoding_result_size_, EncoderPolicy_>::train(
+            const StringT& string_1, const StringT& string_2,
+            const std::optional<DiffScalarFunction>& diff_scalar_function) { // Non-wrapped
+        return try_diff([this, &string_1, &string_2]() { return cost(string_1, string_2); }, 1,
+                        diff_scalar_function);
+    }
 
-            average_cost_of_modified_encoder += cost;
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    typename EncoderTrainer<StringT_, encoding_result_size_, EncoderPolicy_>::TrainingResult
+        EncoderTrainer<StringT_, encoding_result_size_, EncoderPolicy_>::train(
+            const std::vector<std::pair<StringT, StringT>>& string_pairs,
+            const std::optional<DiffScalarFunction>& diff_scalar_function) { // Non-wrapped
+        if (string_pairs.empty()) {
+            throw std::runtime_error("Empty string pairs provided");
         }
+        _training_iterations++;
 
-        _encoder.set_word_vector_encoder_nn(original_encoder_nn);
-
-        average_cost_of_modified_encoder /= string_pairs.size();
+        return race_diff(
+            string_pairs.size(),
+            [this, &string_pairs](std::size_t index) {
+                return cost(string_pairs [index].first, string_pairs [index].second);
+            },
+            diff_scalar_function);
+    }
 
-        if (average_cost_of_modified_encoder < average_cost_of_unmodified_encoder) {
-            return TrainingResult {.diff = diff,
-                                   .original_cost = average_cost_of_unmodified_encoder,
-                                   .modified_cost = average_cost_of_modified_encoder};
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    typename EncoderTrainer<StringT_, encoding_result_size_, EncoderPolicy_>::TrainingResult
+        EncoderTrainer<StringT_, encoding_result_size_, EncoderPolicy_>::train(
+            const std::vector<IdPair>& id_pairs,
+            const std::optional<DiffScalarFunction>& diff_scalar_function) { // Non-wrapped
+        if (id_pairs.empty()) {
+            throw std::runtime_error("Empty id pairs provided");
         }
+        _training_iterations++;
+
+        const StringPool<StringT>& dataset = training_dataset();
 
-        return TrainingResult {.original_cost = average_cost_of_unmodified_encoder,
-                               .modified_cost = average_cost_of_modified_encoder};
+        return race_diff(
+            id_pairs.size(),
+            [this, &id_pairs, &dataset](std::size_t index) {
+                const auto& [id_1, id_2] = id_pairs [index];
+
+                return cost(dataset.at(id_1), dataset.at(id_2));
+            },
+            diff_scalar_function);
     }
 
-    template <StdString StringT_, IntegralConstant encoding_result_size_>
-    typename EncoderTrainer<StringT_, encoding_result_size_>::TrainingResult
-        EncoderTrainer<StringT_, encoding_result_size_>::train_random(
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    typename EncoderTrainer<StringT_, encoding_result_size_, EncoderPolicy_>::TrainingResult
+        EncoderTrainer<StringT_, encoding_result_size_, EncoderPolicy_>::train_random(
             std::size_t iterations,
             const std::optional<DiffScalarFunction>& diff_scalar_function) { // Non-wrapped
+        const std::size_t dataset_size = training_dataset().size();
 
-        if (!_dataset) {
-            throw std::runtime_error("No dataset provided");
+        if (_pair_sampler) {
+            return train(_pair_sampler(*this, iterations), diff_scalar_function);
         }
 
-        const std::size_t dataset_size = _dataset.value()->size();
+        // Ids only; the strings are read from the pool when the pairs are costed
+        std::vector<IdPair> id_pairs;
 
-        if (dataset_size < 2) {
-            throw std::runtime_error("Dataset too small");
-        }
-
-        std::vector<std::pair<StringT, StringT>> string_pairs;
+        id_pairs.reserve(iterations);
 
         std::random_device random_device;
         std::mt19937 random_engine(random_device());
@@ -318,25 +644,18 @@ namespace efuzz {
                 continue;
             }
 
-            string_pairs.emplace_back((*_dataset.value()) [index_1], (*_dataset.value()) [index_2]);
+            id_pairs.emplace_back(index_1, index_2);
         }
 
-        return train(string_pairs, diff_scalar_function);
+        return train(id_pairs, diff_scalar_function);
     }
 
-    template <StdString StringT_, IntegralConstant encoding_result_size_>
-    typename EncoderTrainer<StringT_, encoding_result_size_>::TrainingResult
-        EncoderTrainer<StringT_, encoding_result_size_>::train_all(
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    typename EncoderTrainer<StringT_, encoding_result_size_, EncoderPolicy_>::TrainingResult
+        EncoderTrainer<StringT_, encoding_result_size_, EncoderPolicy_>::train_all(
             const std::optional<DiffScalarFunction>& diff_scalar_function) { // Non-wrapped
-        if (!_dataset) {
-            throw std::runtime_error("No dataset provided");
-        }
-
-        std::size_t dataset_size = _dataset.value()->size();
-
-        if (dataset_size < 2) {
-            throw std::runtime_error("Dataset too small");
-        }
+        const std::size_t dataset_size = training_dataset().size();
 
         if (_encoder.get_word_vector_encoder_nn().layer_sizes.empty()) {
             throw std::runtime_error(
@@ -346,78 +665,219 @@ namespace efuzz {
 
         _training_iterations++;
 
-        // Dont create string pairs, that takes too much memory
+        return try_diff([this]() { return average_cost(); },
+                        dataset_size * (dataset_size - 1) / 2, diff_scalar_function);
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    auto EncoderTrainer<StringT_, encoding_result_size_, EncoderPolicy_>::modify_encoder(
+        const NeuralNetwork::NeuralNetworkDiff& diff) -> this_type& {
+        _encoder.modify_word_vector_encoder_nn(diff);
+        _encoder_nn_edits++;
 
-        const NeuralNetwork original_encoder_nn = _encoder.get_word_vector_encoder_nn();
+        return *this;
+    }
 
-        float average_cost_of_unmodified_encoder {};
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    auto EncoderTrainer<StringT_, encoding_result_size_, EncoderPolicy_>::prune_encoder(
+        float weight_fraction, float neuron_fraction) -> this_type& {
+        NeuralNetwork encoder_nn = _encoder.get_word_vector_encoder_nn();
 
-        for (std::size_t indexer_1 = 0; indexer_1 < dataset_size; ++indexer_1) {
-            for (std::size_t indexer_2 = 0; indexer_2 < dataset_size; ++indexer_2) {
-                if (indexer_1 == indexer_2) {
-                    continue;
-                }
+        if (encoder_nn.layer_sizes.empty()) {
+            throw std::runtime_error("No neural network to prune");
+        }
 
-                const float cost = EncoderTrainer<StringT_, encoding_result_size_>::cost(
-                    (*_dataset.value()) [indexer_1], (*_dataset.value()) [indexer_2]);
+        if (neuron_fraction > 0.0F) {
+            encoder_nn.prune_neurons(neuron_fraction);
+        }
 
-                average_cost_of_unmodified_encoder += cost;
-            }
+        if (weight_fraction > 0.0F) {
+            encoder_nn.prune_weights(weight_fraction);
+            _preserve_sparsity = true;
+        }
+
+        _encoder.set_word_vector_encoder_nn(encoder_nn);
+        _encoder_nn_edits++;
+
+        return *this;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    NeuralNetwork::NeuralNetworkDiff
+        EncoderTrainer<StringT_, encoding_result_size_, EncoderPolicy_>::make_diff(
+            const NeuralNetwork& encoder_nn,
+            const std::optional<DiffScalarFunction>& diff_scalar_function) const {
+        NeuralNetwork::NeuralNetworkDiff diff = encoder_nn.random_diff();
+
+        if (_preserve_sparsity) {
+            diff.mask_pruned_weights(encoder_nn);
         }
 
-        const std::size_t comparisons = dataset_size * (dataset_size - 1);
+        const float scale = diff_scale(diff_scalar_function);
 
-        average_cost_of_unmodified_encoder /= comparisons;
+        if (scale != 1.0F) {
+            diff *= scale;
+        }
+
+        return diff;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    NeuralNetwork::NeuralNetworkDiff
+        EncoderTrainer<StringT_, encoding_result_size_, EncoderPolicy_>::make_diff(
+            std::uint64_t seed, float scale) const {
+        const NeuralNetwork& encoder_nn = _encoder.get_word_vector_encoder_nn();
+        NeuralNetwork::NeuralNetworkDiff diff = encoder_nn.random_diff(seed);
+
+        if (_preserve_sparsity) {
+            diff.mask_pruned_weights(encoder_nn);
+        }
+
+        if (scale != 1.0F) {
+            diff *= scale;
+        }
+
+        return diff;
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    float EncoderTrainer<StringT_, encoding_result_size_, EncoderPolicy_>::diff_scale(
+        const std::optional<DiffScalarFunction>& diff_scalar_function) const {
+        if (!diff_scalar_function.has_value()) {
+            return _step_size_control.scale();
+        }
+
+        return diff_scalar_function.value()(_training_iterations, _encoder_nn_edits, _cost_log);
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    template <typename EvaluateT>
+    typename EncoderTrainer<StringT_, encoding_result_size_, EncoderPolicy_>::TrainingResult
+        EncoderTrainer<StringT_, encoding_result_size_, EncoderPolicy_>::try_diff(
+            const EvaluateT& evaluate, std::size_t pair_count,
+            const std::optional<DiffScalarFunction>& diff_scalar_function) {
+        const NeuralNetwork& original_encoder_nn = _encoder.get_word_vector_encoder_nn();
+        const float original_cost = evaluate();
 
-        const NeuralNetwork::NeuralNetworkDiff random_diff = original_encoder_nn.random_diff();
         const NeuralNetwork::NeuralNetworkDiff diff =
-            diff_scalar_function.has_value()
-                ? random_diff * diff_scalar_function.value()(_training_iterations,
-                                                             _encoder_nn_edits, _cost_log)
-                : random_diff;
+            make_diff(original_encoder_nn, diff_scalar_function);
 
+        // Modified in place and restored from a snapshot rather than copying the network
+        original_encoder_nn.copy_parameters_to(_parameter_snapshot);
         modify_encoder(diff);
 
-        float average_cost_of_modified_encoder {};
+        const float modified_cost = evaluate();
 
-        for (std::size_t indexer_1 = 0; indexer_1 < dataset_size; ++indexer_1) {
-            for (std::size_t indexer_2 = 0; indexer_2 < dataset_size; ++indexer_2) {
-                if (indexer_1 == indexer_2) {
-                    continue;
-                }
+        _encoder.restore_word_vector_encoder_nn_parameters(_parameter_snapshot);
+
+        if (!diff_scalar_function.has_value()) {
+            _step_size_control.record(modified_cost < original_cost);
+        }
+
+        if (modified_cost < original_cost) {
+            return TrainingResult {.diff = diff,
+                                   .original_cost = original_cost,
+                                   .modified_cost = modified_cost,
+                                   .scored_pairs = pair_count};
+        }
 
-                const float cost = EncoderTrainer<StringT_, encoding_result_size_>::cost(
-                    (*_dataset.value()) [indexer_1], (*_dataset.value()) [indexer_2]);
+        return TrainingResult {.original_cost = original_cost,
+                               .modified_cost = modified_cost,
+                               .scored_pairs = pair_count};
+    }
+
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    template <typename PairCostT>
+    typename EncoderTrainer<StringT_, encoding_result_size_, EncoderPolicy_>::TrainingResult
+        EncoderTrainer<StringT_, encoding_result_size_, EncoderPolicy_>::race_diff(
+            std::size_t pair_count, const PairCostT& pair_cost,
+            const std::optional<DiffScalarFunction>& diff_scalar_function) {
+        if (_racing.get_options().rule == RacingRule::off) {
+            return try_diff(
+                [&pair_count, &pair_cost]() {
+                    float total_cost {};
+
+                    for (std::size_t index {0}; index < pair_count; ++index) {
+                        total_cost += pair_cost(index);
+                    }
+
+                    return total_cost / pair_count;
+                },
+                pair_count, diff_scalar_function);
+        }
 
-                average_cost_of_modified_encoder += cost;
+        const NeuralNetwork& original_encoder_nn = _encoder.get_word_vector_encoder_nn();
+        float total_cost {};
+
+        _original_pair_costs.resize(pair_count);
+
+        for (std::size_t index {0}; index < pair_count; ++index) {
+            _original_pair_costs [index] = pair_cost(index);
+            total_cost += _original_pair_costs [index];
+        }
+
+        const float original_cost = total_cost / pair_count;
+        const NeuralNetwork::NeuralNetworkDiff diff =
+            make_diff(original_encoder_nn, diff_scalar_function);
+
+        original_encoder_nn.copy_parameters_to(_parameter_snapshot);
+        modify_encoder(diff);
+        _racing.start(pair_count, original_cost);
+
+        for (const std::size_t index: _racing.order()) {
+            _racing.record(_original_pair_costs [index], pair_cost(index));
+
+            if (_racing.lost()) {
+                break;
             }
         }
 
-        _encoder.set_word_vector_encoder_nn(original_encoder_nn);
+        _encoder.restore_word_vector_encoder_nn_parameters(_parameter_snapshot);
 
-        average_cost_of_modified_encoder /= comparisons;
+        const float modified_cost = _racing.modified_average_cost();
+        const bool improved = !_racing.lost() && modified_cost < original_cost;
 
-        if (average_cost_of_modified_encoder < average_cost_of_unmodified_encoder) {
-            return TrainingResult {.diff = diff,
-                                   .original_cost = average_cost_of_unmodified_encoder,
-                                   .modified_cost = average_cost_of_modified_encoder};
+        if (!diff_scalar_function.has_value()) {
+            _step_size_control.record(improved);
         }
 
-        return TrainingResult {.original_cost = average_cost_of_unmodified_encoder,
-                               .modified_cost = average_cost_of_modified_encoder};
+        TrainingResult result {.original_cost = original_cost,
+                               .modified_cost = modified_cost,
+                               .rejected_early = _racing.scored_count() < pair_count,
+                               .scored_pairs = _racing.scored_count()};
+
+        if (improved) {
+            result.diff = diff;
+        }
+
+        return result;
     }
 
-    template <StdString StringT_, IntegralConstant encoding_result_size_>
-    auto EncoderTrainer<StringT_, encoding_result_size_>::modify_encoder(
-        const NeuralNetwork::NeuralNetworkDiff& diff) -> this_type& {
-        _encoder.modify_word_vector_encoder_nn(diff);
-        _encoder_nn_edits++;
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    auto EncoderTrainer<StringT_, encoding_result_size_, EncoderPolicy_>::training_dataset() const
+        -> const StringPool<StringT>& {
+        if (!_dataset || !_dataset.value()) {
+            throw std::runtime_error("No dataset provided");
+        }
 
-        return *this;
+        if (_dataset.value()->size() < 2) {
+            throw std::runtime_error("Dataset too small");
+        }
+
+        return *_dataset.value();
     }
 
-    template <StdString StringT_, IntegralConstant encoding_result_size_>
-    bool EncoderTrainer<StringT_, encoding_result_size_>::apply_training_result(
+    template <StdString StringT_, IntegralConstant encoding_result_size_,
+              template <typename, typename> class EncoderPolicy_>
+    bool EncoderTrainer<StringT_, encoding_result_size_, EncoderPolicy_>::apply_training_result(
         const TrainingResult& training_result) {
         if (training_result.diff && training_result.modified_cost < training_result.original_cost) {
             _encoder.modify_word_vector_encoder_nn(training_result.diff.value());
@@ -429,4 +889,9 @@ namespace efuzz {
     }
 } // namespace efuzz
 
+CEREAL_CLASS_VERSION(efuzz::EncoderTrainingResult,
+                     efuzz::EncoderTrainingResult::SERIALIZATION_VERSION)
+CEREAL_CLASS_VERSION(efuzz::EncoderTrainerArchiveVersion,
+                     efuzz::EncoderTrainerArchiveVersion::CURRENT)
+
 #endif // EFUZZ_TRAIN_ENCODER_HPP
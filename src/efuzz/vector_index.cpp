@@ -0,0 +1,73 @@
+#include <algorithm>
+#include <numeric>
+
+#include <Eigen/Core>
+
+#include <efuzz/vector_index.hpp>
+
+namespace efuzz {
+    void VectorIndex::add_batch(const float* embeddings, std::size_t count) {
+        for (std::size_t index {0}; index < count; ++index) {
+            add(embeddings + (index * get_dimension()));
+        }
+    }
+
+    bool VectorIndex::truncate(std::size_t size) {
+        return size >= this->size();
+    }
+
+    FlatVectorIndex::FlatVectorIndex(EmbeddingStore embedding_store) :
+        _embedding_store(std::move(embedding_store)) {
+    }
+
+    void FlatVectorIndex::add(const float* embedding) {
+        _embedding_store.append(embedding);
+    }
+
+    bool FlatVectorIndex::truncate(std::size_t size) {
+        _embedding_store.truncate(size);
+
+        return true;
+    }
+
+    std::vector<std::size_t> FlatVectorIndex::nearest(const float* query,
+                                                      std::size_t count) const {
+        Eigen::VectorXf distances(static_cast<Eigen::Index>(size()));
+
+        _embedding_store.distances(query, distances.data());
+
+        std::vector<std::size_t> ids(size());
+        std::iota(ids.begin(), ids.end(), 0);
+
+        count = std::min(count, ids.size());
+
+        std::partial_sort(ids.begin(), ids.begin() + static_cast<std::ptrdiff_t>(count), ids.end(),
+                          [&distances](std::size_t lhs, std::size_t rhs) {
+                              return distances(static_cast<Eigen::Index>(lhs)) <
+                                     distances(static_cast<Eigen::Index>(rhs));
+                          });
+        ids.resize(count);
+
+        return ids;
+    }
+
+    std::size_t FlatVectorIndex::size() const noexcept {
+        return _embedding_store.size();
+    }
+
+    std::size_t FlatVectorIndex::get_dimension() const noexcept {
+        return _embedding_store.get_dimension();
+    }
+
+    VectorIndexType FlatVectorIndex::get_type() const noexcept {
+        return VectorIndexType::flat;
+    }
+
+    std::unique_ptr<VectorIndex> FlatVectorIndex::clone() const {
+        return std::make_unique<FlatVectorIndex>(*this);
+    }
+
+    const EmbeddingStore& FlatVectorIndex::get_embedding_store() const noexcept {
+        return _embedding_store;
+    }
+} // namespace efuzz
@@ -0,0 +1,73 @@
+#ifndef EFUZZ_VECTOR_INDEX_HPP
+#define EFUZZ_VECTOR_INDEX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <efuzz/embedding_store.hpp>
+
+namespace efuzz {
+    enum class VectorIndexType : std::uint8_t {
+        flat,
+        hnsw,
+        annoy,
+    };
+
+    // Nearest neighbour search over embeddings identified by insertion order.
+    class VectorIndex {
+        public:
+
+        VectorIndex() = default;
+        VectorIndex(const VectorIndex&) = default;
+        VectorIndex(VectorIndex&&) = default;
+        VectorIndex& operator=(const VectorIndex&) = default;
+        VectorIndex& operator=(VectorIndex&&) = default;
+        virtual ~VectorIndex() = default;
+
+        virtual void add(const float* embedding) = 0;
+        // Adds `count` embeddings stored one after another; backends may build in parallel.
+        virtual void add_batch(const float* embeddings, std::size_t count);
+        // Drops the embeddings from id `size` on if the backend can do so without a rebuild, and
+        // returns whether it did. Graph backends cannot unlink nodes, so by default only a
+        // truncation that drops nothing succeeds.
+        virtual bool truncate(std::size_t size);
+
+        // Ids of up to `count` embeddings closest to `query`, nearest first. Must be safe to call
+        // from several threads at once.
+        [[nodiscard]] virtual std::vector<std::size_t> nearest(const float* query,
+                                                               std::size_t count) const = 0;
+
+        [[nodiscard]] virtual std::size_t size() const noexcept = 0;
+        [[nodiscard]] virtual std::size_t get_dimension() const noexcept = 0;
+        [[nodiscard]] virtual VectorIndexType get_type() const noexcept = 0;
+        [[nodiscard]] virtual std::unique_ptr<VectorIndex> clone() const = 0;
+    };
+
+    // Exact search by scanning every embedding of an EmbeddingStore.
+    class FlatVectorIndex : public VectorIndex {
+        public:
+
+        explicit FlatVectorIndex(EmbeddingStore embedding_store);
+
+        void add(const float* embedding) override;
+        bool truncate(std::size_t size) override;
+
+        [[nodiscard]] std::vector<std::size_t> nearest(const float* query,
+                                                       std::size_t count) const override;
+
+        [[nodiscard]] std::size_t size() const noexcept override;
+        [[nodiscard]] std::size_t get_dimension() const noexcept override;
+        [[nodiscard]] VectorIndexType get_type() const noexcept override;
+        [[nodiscard]] std::unique_ptr<VectorIndex> clone() const override;
+
+        [[nodiscard]] const EmbeddingStore& get_embedding_store() const noexcept;
+
+        private:
+
+        EmbeddingStore _embedding_store;
+    };
+} // namespace efuzz
+
+#endif // EFUZZ_VECTOR_INDEX_HPP
@@ -0,0 +1,83 @@
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <efuzz/distillation.hpp>
+#include <efuzz/encode.hpp>
+#include <efuzz/train_encoder.hpp>
+
+#include "test_words.hpp"
+
+int main() {
+    using SizeT = std::integral_constant<int, 16>;
+    using EncoderT = efuzz::Encoder<std::string, SizeT>;
+    using TrainerT = efuzz::EncoderTrainer<std::string, SizeT>;
+
+    std::mt19937 random_engine(29);
+    // Spans several tiles, with a partial last one and a few duplicates
+    std::vector<std::string> dictionary = efuzz_test::random_words(
+        random_engine, 2 * TrainerT::ALL_PAIRS_TILE_SIZE + 37, 'a', 'h', 0, 14);
+
+    for (std::size_t word {7}; word < dictionary.size(); word += 50) {
+        dictionary [word] = dictionary.front();
+    }
+
+    EncoderT encoder;
+
+    encoder.set_encoding_nn_layer_sizes(
+        {encoder.get_nn_input_size(), 32, encoder.get_nn_output_size()});
+
+    TrainerT trainer(encoder, dictionary);
+    std::vector<TrainerT::IdPair> ordered_pairs;
+
+    for (std::size_t index_1 {0}; index_1 < dictionary.size(); ++index_1) {
+        for (std::size_t index_2 {0}; index_2 < dictionary.size(); ++index_2) {
+            if (index_1 != index_2) {
+                ordered_pairs.emplace_back(index_1, index_2);
+            }
+        }
+    }
+
+    using clock = std::chrono::steady_clock;
+
+    const auto pairwise_start = clock::now();
+    const float pairwise_cost = trainer.average_cost(ordered_pairs);
+    const auto tiled_start = clock::now();
+    const float tiled_cost = trainer.average_cost();
+    const auto tiled_end = clock::now();
+
+    std::cout << "Pair by pair: " << pairwise_cost << " in "
+              << std::chrono::duration<double, std::milli>(tiled_start - pairwise_start).count()
+              << " ms, tiled upper triangle: " << tiled_cost << " in "
+              << std::chrono::duration<double, std::milli>(tiled_end - tiled_start).count()
+              << " ms\n";
+
+    if (std::abs(pairwise_cost - tiled_cost) > 1e-3F * pairwise_cost) {
+        std::cout << "Tiled all-pairs cost differs from the pairwise cost\n";
+
+        return 1;
+    }
+
+    EncoderT teacher;
+
+    teacher.set_encoding_nn_layer_sizes(
+        {teacher.get_nn_input_size(), 24, teacher.get_nn_output_size()});
+    trainer.set_target_function(efuzz::DistillationTarget(teacher, dictionary));
+
+    const float distillation_pairwise_cost = trainer.average_cost(ordered_pairs);
+    const float distillation_tiled_cost = trainer.average_cost();
+
+    if (std::abs(distillation_pairwise_cost - distillation_tiled_cost) >
+        1e-3F * distillation_pairwise_cost) {
+        std::cout << "Tiled all-pairs cost with a target function differs: "
+                  << distillation_pairwise_cost << " vs " << distillation_tiled_cost << '\n';
+
+        return 1;
+    }
+}
@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <cereal/archives/binary.hpp>
+#include <rapidfuzz/distance/Indel.hpp>
+#include <rapidfuzz/distance/Levenshtein.hpp>
+
+#include <efuzz/bk_tree.hpp>
+
+#include "test_words.hpp"
+
+int main() {
+    std::mt19937 random_engine(23);
+    std::vector<std::string> dictionary =
+        efuzz_test::random_words(random_engine, 3000, 'a', 'l', 2, 12);
+
+    // Dictionary entries with one letter replaced or appended
+    std::vector<std::string> queries;
+    std::uniform_int_distribution<std::size_t> entry(0, dictionary.size() - 1);
+
+    while (queries.size() < 200) {
+        std::string query = dictionary [entry(random_engine)];
+
+        if (queries.size() % 2 == 0) {
+            query [query.size() / 2] = efuzz_test::random_letter(random_engine, 'a', 'l');
+        }
+        else {
+            query += efuzz_test::random_letter(random_engine, 'a', 'l');
+        }
+
+        queries.push_back(std::move(query));
+    }
+
+    for (const efuzz::BkTreeMetric metric:
+         {efuzz::BkTreeMetric::levenshtein, efuzz::BkTreeMetric::indel}) {
+        efuzz::BkTree<std::string> tree(metric);
+        efuzz::BkTree<std::string> parallel_tree(metric);
+
+        tree.set_index_build_options({.thread_count = 1});
+        tree.insert(std::vector<std::string>(dictionary.begin(), dictionary.begin() + 1000));
+        tree.insert(std::vector<std::string>(dictionary.begin() + 1000, dictionary.end() - 30));
+        parallel_tree.set_index_build_options({.thread_count = 4, .chunk_size = 64});
+        parallel_tree.insert(std::vector<std::string>(dictionary.begin(), dictionary.end() - 30));
+
+        // Too few to rebuild the tree, so searches must find them in the overflow area
+        for (auto entry = dictionary.end() - 30; entry != dictionary.end(); ++entry) {
+            tree.insert(*entry);
+            parallel_tree.insert(*entry);
+        }
+
+        if (tree.size() != dictionary.size() || tree.get_depth() != parallel_tree.get_depth()) {
+            std::cout << "Trees built in one and two inserts differ\n";
+
+            return 1;
+        }
+
+        if (tree.get_overflow_size() != 30) {
+            std::cout << "Single inserts rebuilt the tree\n";
+
+            return 1;
+        }
+
+        std::size_t visited_within_one {};
+
+        for (std::size_t max_distance {0}; max_distance <= 3; ++max_distance) {
+            for (const std::string& query: queries) {
+                std::vector<std::size_t> expected;
+
+                for (std::size_t id {0}; id < dictionary.size(); ++id) {
+                    const std::size_t distance =
+                        metric == efuzz::BkTreeMetric::levenshtein
+                            ? rapidfuzz::levenshtein_distance(query, dictionary [id])
+                            : rapidfuzz::indel_distance(query, dictionary [id]);
+
+                    if (distance <= max_distance) {
+                        expected.push_back(id);
+                    }
+                }
+
+                efuzz::BkTreeSearchStats stats;
+                const auto matches = tree.find_within(query, max_distance, &stats);
+                const auto parallel_matches = parallel_tree.find_within(query, max_distance);
+                std::vector<std::size_t> found;
+
+                for (const auto& match: matches) {
+                    found.push_back(match.id);
+                }
+
+                std::sort(found.begin(), found.end());
+
+                if (found != expected || parallel_matches.size() != matches.size()) {
+                    std::cout << "Query " << query << " within " << max_distance << " found "
+                              << found.size() << " entries instead of " << expected.size()
+                              << '\n';
+
+                    return 1;
+                }
+
+                if (max_distance == 1) {
+                    visited_within_one += stats.visited_count;
+                }
+            }
+        }
+
+        const double visited_share = static_cast<double>(visited_within_one) /
+                                     static_cast<double>(queries.size() * dictionary.size());
+
+        std::cout << (metric == efuzz::BkTreeMetric::levenshtein ? "Levenshtein" : "Indel")
+                  << " tree of depth " << tree.get_depth() << " visits "
+                  << 100.0 * visited_share << "% of the entries within one edit\n";
+
+        if (visited_share > 0.5) {
+            std::cout << "Searches within one edit do not prune most of the dictionary\n";
+
+            return 1;
+        }
+
+        std::stringstream stream;
+
+        {
+            cereal::BinaryOutputArchive archive {stream};
+
+            archive(tree);
+        }
+
+        efuzz::BkTree<std::string> loaded_tree;
+
+        {
+            cereal::BinaryInputArchive archive {stream};
+
+            archive(loaded_tree);
+        }
+
+        const auto loaded_results = loaded_tree.search(queries.front(), 5, 2);
+        const auto results = tree.search(queries.front(), 5, 2);
+
+        if (loaded_tree.get_metric() != metric || loaded_tree.size() != tree.size() ||
+            loaded_results.size() != results.size() ||
+            (!results.empty() && loaded_results.front().id != results.front().id)) {
+            std::cout << "Loaded tree differs from the saved one\n";
+
+            return 1;
+        }
+    }
+}
@@ -0,0 +1,246 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <rapidfuzz/distance/Levenshtein.hpp>
+
+#include <efuzz/deletion_index.hpp>
+#include <efuzz/efuzz.hpp>
+#include <efuzz/encode.hpp>
+#include <efuzz/search_router.hpp>
+
+#include "test_words.hpp"
+
+int main() {
+    std::mt19937 random_engine(17);
+    // Real words, whose neighbourhoods within a few edits are far denser than random strings'
+    const std::vector<std::string> dictionary = efuzz_test::english_words();
+
+    // Queries up to two random edits away from an entry, or unrelated
+    std::vector<std::string> queries;
+    std::uniform_int_distribution<std::size_t> entry(0, dictionary.size() - 1);
+    std::uniform_int_distribution<int> edit(0, 2);
+
+    while (queries.size() < 300) {
+        std::string query = dictionary [entry(random_engine)];
+
+        for (int edits = edit(random_engine); edits > 0; --edits) {
+            std::uniform_int_distribution<std::size_t> position(0, query.size());
+            const std::size_t at = position(random_engine);
+
+            if (query.empty() || at == query.size() || edits == 2) {
+                query.insert(at, 1, efuzz_test::random_letter(random_engine, 'a', 'z'));
+            }
+            else if (edits == 1) {
+                query [at] = efuzz_test::random_letter(random_engine, 'a', 'z');
+            }
+        }
+
+        queries.push_back(std::move(query));
+    }
+
+    queries.emplace_back("zzzz");
+
+    efuzz::DeletionIndex<std::string> index;
+
+    // Split so the second insert merges into existing keys, and the last entries are inserted
+    // one by one into small runs
+    index.insert(std::vector<std::string>(dictionary.begin(), dictionary.begin() + 350));
+    index.insert(std::vector<std::string>(dictionary.begin() + 350, dictionary.end() - 20));
+
+    for (auto entry = dictionary.end() - 20; entry != dictionary.end(); ++entry) {
+        index.insert(*entry);
+    }
+
+    for (std::size_t max_edit_distance {0}; max_edit_distance <= 2; ++max_edit_distance) {
+        for (const std::string& query: queries) {
+            std::vector<std::size_t> expected;
+
+            for (std::size_t id {0}; id < dictionary.size(); ++id) {
+                if (rapidfuzz::levenshtein_distance(query, dictionary [id]) <=
+                    max_edit_distance) {
+                    expected.push_back(id);
+                }
+            }
+
+            std::vector<std::size_t> found;
+
+            for (const auto& result: index.search(query, dictionary.size(), max_edit_distance)) {
+                found.push_back(result.id);
+            }
+
+            std::sort(found.begin(), found.end());
+
+            if (found != expected) {
+                std::cout << "Query " << query << " at distance " << max_edit_distance
+                          << " found " << found.size() << " entries instead of "
+                          << expected.size() << '\n';
+
+                return 1;
+            }
+        }
+    }
+
+    const auto exact = index.search(dictionary [42], 3);
+
+    if (exact.empty() || index.get(exact.front().id) != dictionary [42] ||
+        exact.front().score != 100.0) {
+        std::cout << "Exact lookup failed\n";
+
+        return 1;
+    }
+
+    // Truncating back drops the later entries and their keys, as a failed router insert does
+    efuzz::DeletionIndex<std::string> truncated_index = index;
+
+    truncated_index.truncate(500);
+
+    const auto dropped = truncated_index.search(dictionary [750], dictionary.size(), 0);
+    const auto kept = truncated_index.search(dictionary [42], dictionary.size(), 0);
+
+    if (truncated_index.size() != 500 ||
+        std::any_of(dropped.begin(), dropped.end(),
+                    [](const auto& result) { return result.id >= 500; }) ||
+        std::none_of(kept.begin(), kept.end(),
+                     [](const auto& result) { return result.id == 42; })) {
+        std::cout << "Truncation kept entries past its size\n";
+
+        return 1;
+    }
+
+    bool threw {};
+
+    try {
+        static_cast<void>(index.search("abc", 1, 3));
+    }
+    catch (const std::runtime_error&) {
+        threw = true;
+    }
+
+    if (!threw) {
+        std::cout << "A search beyond the index's edit distance was accepted\n";
+
+        return 1;
+    }
+
+    // Inserted one by one, each key is copied by merges about log2 of the key count times; a
+    // single run rewritten on every insert would copy quadratically many
+    efuzz::DeletionIndex<std::string> incremental_index;
+
+    for (const std::string& word: dictionary) {
+        incremental_index.insert(word);
+    }
+
+    const auto key_count = static_cast<double>(incremental_index.get_key_count());
+
+    std::cout << dictionary.size() << " single inserts merged "
+              << incremental_index.get_merged_key_count() << " keys into "
+              << incremental_index.get_run_count() << " runs of " << key_count << " keys\n";
+
+    if (static_cast<double>(incremental_index.get_run_count()) > std::log2(key_count) + 1 ||
+        static_cast<double>(incremental_index.get_merged_key_count()) >
+            key_count * std::log2(key_count)) {
+        std::cout << "Single inserts did more than logarithmic work per key\n";
+
+        return 1;
+    }
+
+    efuzz::DeletionIndex<std::string> unbounded_index({.prefix_length = 0});
+
+    unbounded_index.insert(dictionary);
+
+    std::cout << index.get_key_count() << " deletion keys with a prefix of 7, "
+              << unbounded_index.get_key_count() << " without\n";
+
+    using SizeT = std::integral_constant<int, 10>;
+    using ContainerT = efuzz::SearchContainer<std::string, SizeT>;
+
+    efuzz::Encoder<std::string, SizeT> encoder;
+
+    encoder.set_encoding_nn_layer_sizes(
+        {encoder.get_nn_input_size(), 16, encoder.get_nn_output_size()});
+
+    ContainerT container(encoder);
+
+    container.insert(std::vector<std::string>(dictionary.begin(), dictionary.begin() + 500));
+
+    efuzz::SearchRouter<ContainerT> router(container, {}, {.max_deletion_query_length = 12});
+
+    router.insert(std::vector<std::string>(dictionary.begin() + 500, dictionary.end()));
+
+    if (router.size() != dictionary.size() ||
+        router.get_container().size() != dictionary.size() ||
+        router.get(750) != dictionary [750]) {
+        std::cout << "Router engines hold different entries\n";
+
+        return 1;
+    }
+
+    if (router.route("short", 2) != efuzz::SearchRoute::deletion_index ||
+        router.route("a much longer query", 2) != efuzz::SearchRoute::container ||
+        router.route("short", 3) != efuzz::SearchRoute::container) {
+        std::cout << "Unexpected routes\n";
+
+        return 1;
+    }
+
+    constexpr std::size_t k {5};
+    const auto batch_results = router.search_batch(queries, k, 2);
+
+    for (std::size_t query {0}; query < queries.size(); ++query) {
+        const auto results = router.search(queries [query], k);
+
+        if (results.size() != k || batch_results [query].size() != k ||
+            results.front().id != batch_results [query].front().id) {
+            std::cout << "Routed search of " << queries [query] << " returned " << results.size()
+                      << " results, " << batch_results [query].size() << " in a batch\n";
+
+            return 1;
+        }
+    }
+
+    using clock = std::chrono::steady_clock;
+
+    const auto index_start = clock::now();
+    std::vector<std::vector<efuzz::SearchResult>> index_results;
+
+    for (const std::string& query: queries) {
+        index_results.push_back(index.search(query, k));
+    }
+
+    const auto container_start = clock::now();
+    std::vector<std::vector<efuzz::SearchResult>> container_results;
+
+    for (const std::string& query: queries) {
+        container_results.push_back(router.get_container().search(query, k));
+    }
+
+    const auto end = clock::now();
+    // Share of the entries within two edits that the embedding search also returns
+    std::size_t matches {};
+    std::size_t container_matches {};
+
+    for (std::size_t query {0}; query < queries.size(); ++query) {
+        for (const auto& match: index_results [query]) {
+            ++matches;
+            container_matches += static_cast<std::size_t>(std::any_of(
+                container_results [query].begin(), container_results [query].end(),
+                [&match](const auto& result) { return result.id == match.id; }));
+        }
+    }
+
+    const auto microseconds = [](auto duration) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    };
+
+    std::cout << queries.size() << " queries: deletion index "
+              << microseconds(container_start - index_start) << " us, container "
+              << microseconds(end - container_start) << " us finding " << container_matches
+              << " of the " << matches << " entries within two edits\n";
+}
@@ -0,0 +1,96 @@
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <efuzz/distillation.hpp>
+#include <efuzz/encode.hpp>
+#include <efuzz/train_encoder.hpp>
+
+#include "test_words.hpp"
+
+int main() {
+    using TeacherT = efuzz::Encoder<std::string, std::integral_constant<int, 16>>;
+    using StudentT = efuzz::Encoder<std::string, std::integral_constant<int, 6>>;
+    using TrainerT = efuzz::EncoderTrainer<std::string, std::integral_constant<int, 6>>;
+
+    std::mt19937 random_engine(5);
+    std::vector<std::string> dataset =
+        efuzz_test::random_words(random_engine, 30, 'a', 'h', 2, 8);
+
+    TeacherT teacher;
+
+    teacher.set_encoding_nn_layer_sizes(
+        {teacher.get_nn_input_size(), 64, 48, teacher.get_nn_output_size()});
+
+    const efuzz::DistillationTarget<TeacherT> target(teacher, dataset);
+    const float expected_distance =
+        (teacher.encode(dataset [0]) - teacher.encode("unseen")).norm() / teacher.output_norm_max();
+
+    if (target(dataset [3], dataset [3]) != 0.0F ||
+        std::abs(target(dataset [0], "unseen") - expected_distance) > 1e-5F) {
+        std::cout << "Distillation target does not follow the teacher's distances\n";
+
+        return 1;
+    }
+
+    StudentT student;
+
+    student.set_encoding_nn_layer_sizes(
+        {student.get_nn_input_size(), 12, student.get_nn_output_size()});
+
+    TrainerT trainer(student, dataset);
+
+    trainer.set_target_function(target);
+
+    const float initial_cost = trainer.average_cost();
+
+    for (std::size_t iteration {0}; iteration < 100; ++iteration) {
+        trainer.apply_training_result(trainer.train_all([](float, float, const auto&) {
+            return 0.1F;
+        }));
+    }
+
+    const float distilled_cost = trainer.average_cost();
+
+    std::cout << "Distillation cost " << initial_cost << " -> " << distilled_cost << '\n';
+
+    if (!(distilled_cost < initial_cost)) {
+        std::cout << "Student did not move towards the teacher\n";
+
+        return 1;
+    }
+
+    const std::vector<std::string> sample(dataset.begin(), dataset.begin() + 20);
+    const auto shapes = efuzz::measure_student_shapes(student, {{4}, {32}, {96, 96}}, sample);
+
+    for (const auto& shape: shapes) {
+        std::cout << shape.parameter_count << " parameters: " << shape.encode_latency.count()
+                  << " ns per word\n";
+
+        if (shape.encode_latency.count() <= 0 ||
+            shape.layer_sizes.front() != student.get_nn_input_size()) {
+            std::cout << "Student shape was not measured\n";
+
+            return 1;
+        }
+    }
+
+    using std::chrono::nanoseconds;
+
+    const std::vector<efuzz::StudentShape> candidates {
+        {.layer_sizes = {1}, .parameter_count = 10, .encode_latency = nanoseconds(100)},
+        {.layer_sizes = {2}, .parameter_count = 50, .encode_latency = nanoseconds(400)},
+        {.layer_sizes = {3}, .parameter_count = 90, .encode_latency = nanoseconds(900)}};
+
+    if (efuzz::choose_student_shape(candidates, nanoseconds(500))->parameter_count != 50 ||
+        efuzz::choose_student_shape(candidates, nanoseconds(50)).has_value()) {
+        std::cout << "Wrong student shape chosen for the latency budget\n";
+
+        return 1;
+    }
+}
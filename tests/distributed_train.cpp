@@ -0,0 +1,117 @@
+#include <cstddef>
+#include <future>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <efuzz/distributed_train.hpp>
+#include <efuzz/encode.hpp>
+#include <efuzz/hard_pair_sampler.hpp>
+#include <efuzz/train_encoder.hpp>
+
+int main() {
+    using EncoderT = efuzz::Encoder<std::string, std::integral_constant<int, 10>>;
+    using TrainerT = efuzz::EncoderTrainer<std::string, std::integral_constant<int, 10>>;
+
+    EncoderT encoder;
+
+    const std::size_t input_size = encoder.get_nn_input_size();
+    const std::size_t output_size = encoder.get_nn_output_size();
+
+    encoder.set_encoding_nn_layer_sizes({input_size, 16, 12, output_size});
+
+    TrainerT encoder_trainer(encoder);
+
+    encoder_trainer.set_dataset(std::vector<std::string> {
+        "airplane", "airport", "apple", "maple", "people", "purple", "table", "cable"});
+
+    efuzz::TrainingCoordinator<TrainerT> coordinator(
+        encoder_trainer, efuzz::DistributedTrainingOptions {.worker_count = 3,
+                                                            .candidates_per_worker = 2});
+
+    const auto diff_scalar_function = [](float, float,
+                                         const std::vector<TrainerT::CostLogDatapoint>&) {
+        return 0.1F;
+    };
+
+    float last_cost {};
+    std::size_t accepted {};
+
+    for (std::size_t iteration {0}; iteration < 30; ++iteration) {
+        const auto result = coordinator.train(diff_scalar_function);
+
+        if (result.candidates != 6) {
+            std::cout << "Expected 6 candidates, got " << result.candidates << '\n';
+
+            return 1;
+        }
+
+        if (iteration > 0 && result.original_cost > last_cost) {
+            std::cout << "Cost went up without an accepted update\n";
+
+            return 1;
+        }
+
+        last_cost = result.accepted ? result.modified_cost : result.original_cost;
+        accepted += static_cast<std::size_t>(result.accepted);
+
+        std::cout << "Iteration " << iteration << ": " << result.original_cost << " -> "
+                  << result.modified_cost << (result.accepted ? " (accepted)" : "") << '\n';
+    }
+
+    // The coordinator's own network has to match what the workers converged to
+    TrainerT final_trainer = coordinator.get_trainer();
+    const float final_cost = final_trainer.average_cost();
+
+    std::cout << "Accepted updates: " << accepted << '\n';
+    std::cout << "Final cost: " << final_cost << " (workers: " << last_cost << ")\n";
+
+    if (final_cost != last_cost) {
+        return 1;
+    }
+
+    // Pairs drawn by a sampler on the coordinator reach every worker as they are
+    efuzz::HardPairSampler<TrainerT> sampler({.pool_size = 8, .anchor_count = 4, .seed = 3});
+
+    encoder_trainer.set_pair_sampler(sampler.as_pair_sampler());
+
+    efuzz::TrainingCoordinator<TrainerT> sampled_coordinator(
+        encoder_trainer, efuzz::DistributedTrainingOptions {.worker_count = 2,
+                                                            .candidates_per_worker = 2,
+                                                            .batch_pairs = 6});
+
+    for (std::size_t iteration {0}; iteration < 10; ++iteration) {
+        static_cast<void>(sampled_coordinator.train(diff_scalar_function));
+    }
+
+    if (sampler.get_refresh_count() == 0) {
+        std::cout << "The coordinator did not draw its pairs from the sampler\n";
+
+        return 1;
+    }
+
+    // Forking while another thread runs would leave the workers with its locks held
+    std::promise<void> release;
+    std::thread other_thread([future = release.get_future()]() mutable { future.wait(); });
+    bool refused {false};
+
+    try {
+        const efuzz::TrainingCoordinator<TrainerT> threaded_coordinator(
+            encoder_trainer, efuzz::DistributedTrainingOptions {.worker_count = 1});
+    }
+    catch (const std::logic_error&) {
+        refused = true;
+    }
+
+    release.set_value();
+    other_thread.join();
+
+    if (!refused) {
+        std::cout << "Workers were forked from a multithreaded process\n";
+
+        return 1;
+    }
+}
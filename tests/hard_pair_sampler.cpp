@@ -0,0 +1,154 @@
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <efuzz/encode.hpp>
+#include <efuzz/hard_pair_sampler.hpp>
+#include <efuzz/train_encoder.hpp>
+
+#include "test_words.hpp"
+
+int main() {
+    using SizeT = std::integral_constant<int, 8>;
+    using TrainerT = efuzz::EncoderTrainer<std::string, SizeT>;
+
+    std::mt19937 random_engine(41);
+    std::vector<std::string> dictionary;
+
+    // Families of near duplicates, which random pairs almost never bring together
+    while (dictionary.size() < 600) {
+        const std::string word = efuzz_test::random_word(random_engine, 'a', 'f', 3, 10);
+
+        for (std::size_t variant {0}; variant < 3; ++variant) {
+            std::string near_duplicate = word;
+
+            near_duplicate [variant % near_duplicate.size()] = static_cast<char>('g' + variant);
+            dictionary.push_back(std::move(near_duplicate));
+        }
+    }
+
+    efuzz::Encoder<std::string, SizeT> encoder;
+
+    encoder.set_encoding_nn_layer_sizes(
+        {encoder.get_nn_input_size(), 24, encoder.get_nn_output_size()});
+
+    TrainerT trainer(encoder, dictionary);
+    efuzz::HardPairSampler<TrainerT> sampler(
+        {.pool_size = 256, .refresh_interval = 20, .anchor_count = 128, .seed = 5});
+
+    const std::vector<TrainerT::IdPair> batch = sampler.sample(trainer, 64);
+    const auto& hard_pairs = sampler.get_hard_pairs();
+
+    if (batch.size() != 64 || hard_pairs.size() != 256 || sampler.get_refresh_count() != 1) {
+        std::cout << "Unexpected batch of " << batch.size() << " with " << hard_pairs.size()
+                  << " hard pairs\n";
+
+        return 1;
+    }
+
+    std::size_t hard_in_batch {};
+
+    for (const auto& pair: batch) {
+        if (pair.first == pair.second || pair.first >= dictionary.size() ||
+            pair.second >= dictionary.size()) {
+            std::cout << "Invalid pair " << pair.first << ", " << pair.second << '\n';
+
+            return 1;
+        }
+
+        hard_in_batch += static_cast<std::size_t>(
+            std::find(hard_pairs.begin(), hard_pairs.end(), pair) != hard_pairs.end());
+    }
+
+    if (hard_in_batch < 32) {
+        std::cout << "Only " << hard_in_batch << " of the batch are hard pairs\n";
+
+        return 1;
+    }
+
+    std::vector<TrainerT::IdPair> random_pairs;
+    std::uniform_int_distribution<std::size_t> entry(0, dictionary.size() - 1);
+
+    while (random_pairs.size() < hard_pairs.size()) {
+        const std::size_t id_1 = entry(random_engine);
+        const std::size_t id_2 = entry(random_engine);
+
+        if (id_1 != id_2) {
+            random_pairs.emplace_back(id_1, id_2);
+        }
+    }
+
+    const float hard_cost = trainer.average_cost(hard_pairs);
+    const float random_cost = trainer.average_cost(random_pairs);
+
+    std::cout << "Average cost of hard pairs " << hard_cost << ", of random pairs "
+              << random_cost << '\n';
+
+    if (!(hard_cost > random_cost)) {
+        std::cout << "Hard pairs are not harder than random ones\n";
+
+        return 1;
+    }
+
+    // Same number of pair evaluations with and without the hard pairs
+    TrainerT uniform_trainer(encoder, dictionary);
+    TrainerT mined_trainer(encoder, dictionary);
+
+    mined_trainer.set_pair_sampler(sampler.as_pair_sampler());
+    // Uniform pairs like train_random's, but seeded, so the comparison below is repeatable
+    uniform_trainer.set_pair_sampler(
+        [&entry, uniform_engine = std::mt19937(43)](const TrainerT& /*trainer*/,
+                                                    std::size_t pair_count) mutable {
+            std::vector<TrainerT::IdPair> pairs;
+
+            while (pairs.size() < pair_count) {
+                const std::size_t id_1 = entry(uniform_engine);
+                const std::size_t id_2 = entry(uniform_engine);
+
+                if (id_1 != id_2) {
+                    pairs.emplace_back(id_1, id_2);
+                }
+            }
+
+            return pairs;
+        });
+
+    const float initial_cost = uniform_trainer.average_cost();
+    constexpr std::size_t rounds {200};
+    constexpr std::size_t pairs_per_round {64};
+
+    for (std::size_t round {0}; round < rounds; ++round) {
+        uniform_trainer.apply_training_result(uniform_trainer.train_random(pairs_per_round));
+        mined_trainer.apply_training_result(mined_trainer.train_random(pairs_per_round));
+    }
+
+    std::vector<TrainerT::IdPair> family_pairs;
+
+    for (std::size_t family {0}; family + 2 < dictionary.size(); family += 3) {
+        family_pairs.emplace_back(family, family + 1);
+        family_pairs.emplace_back(family, family + 2);
+        family_pairs.emplace_back(family + 1, family + 2);
+    }
+
+    std::cout << "All-pairs cost " << initial_cost << " -> " << uniform_trainer.average_cost()
+              << " with uniform batches, " << mined_trainer.average_cost()
+              << " with hard pairs mixed in (" << sampler.get_refresh_count()
+              << " refreshes)\n";
+
+    const float uniform_family_cost = uniform_trainer.average_cost(family_pairs);
+    const float mined_family_cost = mined_trainer.average_cost(family_pairs);
+
+    std::cout << "Near duplicate cost " << uniform_family_cost << " with uniform batches, "
+              << mined_family_cost << " with hard pairs mixed in\n";
+
+    // What mining is for: pairs uniform batches rarely contain
+    if (!(mined_family_cost < 0.9F * uniform_family_cost)) {
+        std::cout << "Hard pairs did not improve the near duplicates\n";
+
+        return 1;
+    }
+}
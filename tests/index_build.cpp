@@ -0,0 +1,240 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <efuzz/efuzz.hpp>
+#include <efuzz/index_build.hpp>
+
+#include "test_words.hpp"
+
+int main() {
+    using EncoderT = efuzz::Encoder<std::string, std::integral_constant<int, 10>>;
+    using ContainerT = efuzz::SearchContainer<std::string, std::integral_constant<int, 10>>;
+
+    EncoderT encoder;
+
+    encoder.set_encoding_nn_layer_sizes(
+        {encoder.get_nn_input_size(), 32, 24, encoder.get_nn_output_size()});
+
+    std::mt19937 random_engine(3);
+    const std::vector<std::string> dictionary =
+        efuzz_test::random_words(random_engine, 5000, 'a', 'z', 3, 12);
+    std::stringstream lines;
+
+    for (const std::string& word: dictionary) {
+        lines << word << '\n';
+    }
+
+    const auto time_build = [](ContainerT& container, const auto& insert) {
+        const auto start = std::chrono::steady_clock::now();
+
+        insert(container);
+
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+            .count();
+    };
+
+    ContainerT serial_container(encoder);
+
+    efuzz::IndexBuildOptions serial_options;
+
+    serial_options.thread_count = 1;
+    serial_container.set_index_build_options(serial_options);
+
+    const double serial_time = time_build(
+        serial_container, [&dictionary](ContainerT& container) { container.insert(dictionary); });
+
+    std::mutex progress_mutex;
+    std::vector<efuzz::IndexBuildProgress> progress;
+    ContainerT parallel_container(encoder);
+
+    parallel_container.set_vector_index(efuzz::VectorIndexType::hnsw);
+    parallel_container.set_index_build_options(
+        {.thread_count = 4,
+         .chunk_size = 256,
+         .progress = [&progress, &progress_mutex](const efuzz::IndexBuildProgress& update) {
+             const std::lock_guard lock {progress_mutex};
+
+             progress.push_back(update);
+         }});
+
+    const double parallel_time = time_build(
+        parallel_container, [&lines](ContainerT& container) { container.insert_lines(lines); });
+
+    std::cout << "Flat index on 1 thread: " << serial_time << " ms, HNSW index on 4 threads: "
+              << parallel_time << " ms, " << progress.size() << " progress reports\n";
+
+    if (parallel_container.size() != dictionary.size() ||
+        parallel_container.get(4321) != dictionary [4321]) {
+        std::cout << "Lines were not inserted in order\n";
+
+        return 1;
+    }
+
+    for (const std::size_t id: {0, 1, 255, 256, 4999}) {
+        if (parallel_container.search(dictionary [id], 1).front().id != id ||
+            serial_container.search(dictionary [id], 1).front().id != id) {
+            std::cout << "Exact lookup of " << dictionary [id] << " failed\n";
+
+            return 1;
+        }
+    }
+
+    std::size_t encode_completed {};
+    std::size_t index_completed {};
+
+    for (const auto& update: progress) {
+        auto& completed = update.stage == efuzz::IndexBuildProgress::Stage::encode
+                              ? encode_completed
+                              : index_completed;
+
+        // insert_lines learns the total as it reads, so only the last total is the line count
+        if (update.total > dictionary.size() || update.completed > update.total ||
+            update.completed <= completed) {
+            std::cout << "Progress went backwards or had the wrong total\n";
+
+            return 1;
+        }
+
+        completed = update.completed;
+    }
+
+    if (encode_completed != dictionary.size() || index_completed != dictionary.size()) {
+        std::cout << "Progress did not reach the end of both stages\n";
+
+        return 1;
+    }
+
+    // Indexing fails after the first chunk is in the vector index; the insert must leave no
+    // entry behind in it. The flat index drops the chunk without encoding anything again.
+    ContainerT failing_container(encoder);
+    bool fail_indexing {true};
+    bool encoded_after_failure {};
+
+    failing_container.insert(
+        std::vector<std::string>(dictionary.begin(), dictionary.begin() + 100));
+    failing_container.set_index_build_options(
+        {.thread_count = 1,
+         .chunk_size = 10,
+         .progress = [&fail_indexing,
+                      &encoded_after_failure](const efuzz::IndexBuildProgress& update) {
+             if (update.stage == efuzz::IndexBuildProgress::Stage::encode && !fail_indexing) {
+                 encoded_after_failure = true;
+             }
+
+             if (update.stage == efuzz::IndexBuildProgress::Stage::index && fail_indexing) {
+                 fail_indexing = false;
+
+                 throw std::runtime_error("indexing failed");
+             }
+         }});
+
+    bool threw {};
+
+    try {
+        failing_container.insert(
+            std::vector<std::string>(dictionary.begin() + 100, dictionary.begin() + 200));
+    }
+    catch (const std::runtime_error&) {
+        threw = true;
+    }
+
+    const auto failed_results = failing_container.search(dictionary [150], 100);
+
+    if (!threw || failing_container.size() != 100 || failed_results.size() != 100 ||
+        std::any_of(failed_results.begin(), failed_results.end(),
+                    [](const auto& result) { return result.id >= 100; })) {
+        std::cout << "A failed insert left entries in the vector index\n";
+
+        return 1;
+    }
+
+    if (encoded_after_failure || failing_container.needs_vector_index_rebuild()) {
+        std::cout << "Rolling back the flat index rebuilt it\n";
+
+        return 1;
+    }
+
+    // HNSW cannot drop nodes, so the rollback rebuilds it. When that rebuild fails as well, the
+    // insert still throws its own exception and the next insert rebuilds the index.
+    ContainerT graph_container(encoder);
+    std::size_t index_failures {};
+    bool fail_graph_indexing {};
+
+    graph_container.set_vector_index(efuzz::VectorIndexType::hnsw);
+    graph_container.insert(std::vector<std::string>(dictionary.begin(), dictionary.begin() + 100));
+    graph_container.set_index_build_options(
+        {.thread_count = 1,
+         .chunk_size = 10,
+         .progress = [&index_failures,
+                      &fail_graph_indexing](const efuzz::IndexBuildProgress& update) {
+             if (update.stage == efuzz::IndexBuildProgress::Stage::index && fail_graph_indexing) {
+                 throw std::runtime_error(index_failures++ == 0 ? "indexing failed"
+                                                                : "rebuild failed");
+             }
+         }});
+    fail_graph_indexing = true;
+
+    std::string graph_error;
+
+    try {
+        graph_container.insert(
+            std::vector<std::string>(dictionary.begin() + 100, dictionary.begin() + 200));
+    }
+    catch (const std::runtime_error& error) {
+        graph_error = error.what();
+    }
+
+    if (graph_error != "indexing failed" || index_failures != 2 ||
+        !graph_container.needs_vector_index_rebuild() || graph_container.size() != 100) {
+        std::cout << "A failed rollback replaced the insert's exception: " << graph_error << '\n';
+
+        return 1;
+    }
+
+    fail_graph_indexing = false;
+    graph_container.insert(dictionary [200]);
+
+    const auto rebuilt_results = graph_container.search(dictionary [50], 1);
+
+    if (graph_container.needs_vector_index_rebuild() || rebuilt_results.empty() ||
+        graph_container.get(rebuilt_results.front().id) != dictionary [50]) {
+        std::cout << "The next insert did not rebuild the vector index\n";
+
+        return 1;
+    }
+
+    threw = false;
+
+    efuzz::IndexBuildOptions failing_options;
+
+    failing_options.thread_count = 3;
+    failing_options.chunk_size = 7;
+
+    try {
+        efuzz::for_each_chunk(100, failing_options,
+                              efuzz::IndexBuildProgress::Stage::encode,
+                              [](std::size_t begin, std::size_t /*end*/) {
+                                  if (begin == 49) {
+                                      throw std::runtime_error("chunk failed");
+                                  }
+                              });
+    }
+    catch (const std::runtime_error&) {
+        threw = true;
+    }
+
+    if (!threw) {
+        std::cout << "Chunk exception was not propagated\n";
+
+        return 1;
+    }
+}
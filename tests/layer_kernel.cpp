@@ -0,0 +1,82 @@
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include <efuzz/neural_network/layer_kernel.hpp>
+#include <efuzz/neural_network/neural_network.hpp>
+
+namespace {
+    Eigen::VectorXf reference_compute(const efuzz::NeuralNetwork& network, Eigen::VectorXf input) {
+        for (std::size_t index {0}; index < network.weights.size(); ++index) {
+            input = network.weights [index] * input + network.biases [index];
+            input = input.unaryExpr(
+                [](float value) { return efuzz::NeuralNetwork::sigmoid_abs(value); });
+        }
+
+        return input;
+    }
+} // namespace
+
+int main() {
+    std::cout << "Layer kernel: " << efuzz::layer_kernel_name() << '\n';
+
+    // Widths chosen to hit full blocks, partial tails, and the 11-layer taper from train_encoder
+    const std::vector<std::vector<std::size_t>> shapes = {
+        {1, 1},
+        {7, 3, 9},
+        {18, 16, 17, 33, 10},
+        {18, 16, 14, 12, 11, 9, 7, 5, 3, 1, 10},
+    };
+
+    std::vector<efuzz::LayerKernel> kernels = {efuzz::layer_kernel_portable};
+
+#if EFUZZ_LAYER_KERNEL_X86
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        kernels.push_back(efuzz::layer_kernel_avx2);
+    }
+
+    if (__builtin_cpu_supports("avx512f")) {
+        kernels.push_back(efuzz::layer_kernel_avx512);
+    }
+#endif
+
+    float max_error {};
+
+    for (const auto& layer_sizes: shapes) {
+        const efuzz::NeuralNetwork network(layer_sizes);
+
+        for (std::size_t trial {0}; trial < 16; ++trial) {
+            const Eigen::VectorXf input = Eigen::VectorXf::Random(layer_sizes.front());
+            const Eigen::VectorXf expected = reference_compute(network, input);
+            const Eigen::VectorXf fused = network.compute(input);
+
+            if (fused.size() != expected.size()) {
+                std::cout << "Size mismatch: " << fused.size() << " != " << expected.size()
+                          << '\n';
+
+                return 1;
+            }
+
+            max_error = std::max(max_error, (fused - expected).cwiseAbs().maxCoeff());
+
+            for (const efuzz::LayerKernel kernel: kernels) {
+                Eigen::VectorXf hidden(layer_sizes [1]);
+                kernel(network.weights [0].data(), network.biases [0].data(), input.data(),
+                       hidden.data(), layer_sizes [1], layer_sizes [0]);
+
+                const Eigen::VectorXf expected_hidden =
+                    (network.weights [0] * input + network.biases [0]).unaryExpr(
+                        [](float value) { return efuzz::NeuralNetwork::sigmoid_abs(value); });
+
+                max_error = std::max(max_error, (hidden - expected_hidden).cwiseAbs().maxCoeff());
+            }
+        }
+    }
+
+    std::cout << "Max absolute error: " << max_error << '\n';
+
+    return max_error < 1e-5F ? 0 : 1;
+}
@@ -0,0 +1,158 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <efuzz/efuzz.hpp>
+#include <efuzz/encode.hpp>
+#include <efuzz/ngram_encode.hpp>
+#include <efuzz/train_encoder.hpp>
+
+#include "test_words.hpp"
+
+int main() {
+    using SizeT = std::integral_constant<int, 12>;
+    using NGramEncoderT = efuzz::NGramEncoder<std::string, SizeT>;
+
+    std::mt19937 random_engine(17);
+    std::vector<std::string> dictionary =
+        efuzz_test::random_words(random_engine, 1500, 'a', 'z', 0, 60);
+
+    NGramEncoderT encoder(512);
+
+    encoder.set_encoding_nn_layer_sizes(
+        {encoder.get_nn_input_size(), 48, encoder.get_nn_output_size()});
+
+    std::vector<std::uint32_t> buckets;
+
+    encoder.hash_ngrams("abc", buckets);
+
+    // 3 letters, 4 bigrams and 3 trigrams once the boundaries are added
+    if (buckets.size() != 10) {
+        std::cout << "Unexpected n-gram count " << buckets.size() << '\n';
+
+        return 1;
+    }
+
+    // A byte above 0x7F hashes by its unsigned value, the same on every platform; the letter
+    // is the first n-gram, its bucket computed by hand with FNV-1a
+    buckets.clear();
+    encoder.hash_ngrams("\xE9", buckets);
+
+    if (buckets.size() != 4 || buckets.front() != 402) {
+        std::cout << "Non-ASCII letter hashed to an unexpected bucket\n";
+
+        return 1;
+    }
+
+    // Reference: the dense bucket counts, scaled like encode() scales them, through the network
+    for (std::size_t word {0}; word < 50; ++word) {
+        buckets.clear();
+        encoder.hash_ngrams(dictionary [word], buckets);
+
+        Eigen::VectorXf counts = Eigen::VectorXf::Zero(
+            static_cast<Eigen::Index>(encoder.get_feature_count()));
+
+        for (const std::uint32_t bucket: buckets) {
+            counts [bucket] += 1.0F;
+        }
+
+        counts /= std::sqrt(static_cast<float>(std::max<std::size_t>(1, buckets.size())));
+
+        if ((encoder.get_word_vector_encoder_nn().compute(counts) -
+             encoder.encode(dictionary [word]))
+                .norm() > 1e-4F) {
+            std::cout << "N-gram encoding of " << dictionary [word]
+                      << " differs from the dense computation\n";
+
+            return 1;
+        }
+    }
+
+    const Eigen::MatrixXf batch_encodings = encoder.encode_batch(dictionary);
+
+    for (std::size_t word {0}; word < dictionary.size(); ++word) {
+        const auto column = static_cast<Eigen::Index>(word);
+
+        if ((batch_encodings.col(column) - encoder.encode(dictionary [word])).norm() > 1e-4F) {
+            std::cout << "Batched n-gram encoding of " << dictionary [word] << " differs\n";
+
+            return 1;
+        }
+    }
+
+    // Same interface as Encoder, so the trainer and the container take it as their policy
+    efuzz::EncoderTrainer<std::string, SizeT, efuzz::NGramEncoder> trainer(
+        encoder, std::vector<std::string>(dictionary.begin(), dictionary.begin() + 40));
+    const float initial_cost = trainer.average_cost();
+
+    for (std::size_t iteration {0}; iteration < 30; ++iteration) {
+        trainer.apply_training_result(trainer.train_random(200, [](float, float, const auto&) {
+            return 0.05F;
+        }));
+    }
+
+    const float trained_cost = trainer.average_cost();
+
+    std::cout << "N-gram encoder cost " << initial_cost << " -> " << trained_cost << '\n';
+
+    if (trained_cost > initial_cost) {
+        std::cout << "Training made the n-gram encoder worse\n";
+
+        return 1;
+    }
+
+    efuzz::SearchContainer<std::string, SizeT, efuzz::NGramEncoder> container(
+        trainer.get_encoder());
+
+    container.insert(dictionary);
+    container.set_vector_index(efuzz::VectorIndexType::hnsw);
+
+    for (const std::size_t id: {0, 1, 700, 1499}) {
+        const auto results = container.search(dictionary [id], 1);
+
+        if (results.empty() || dictionary [results.front().id] != dictionary [id]) {
+            std::cout << "Exact lookup of " << dictionary [id] << " failed\n";
+
+            return 1;
+        }
+    }
+
+    efuzz::Encoder<std::string, SizeT> recurrent_encoder;
+
+    recurrent_encoder.set_encoding_nn_layer_sizes(
+        {recurrent_encoder.get_nn_input_size(), 48, recurrent_encoder.get_nn_output_size()});
+
+    // Best of a few runs; printed only, as wall-clock times are too noisy to assert on
+    const auto time_encoding = [&dictionary](const auto& any_encoder) {
+        double best = std::numeric_limits<double>::max();
+
+        for (std::size_t run {0}; run < 5; ++run) {
+            const auto start = std::chrono::steady_clock::now();
+            volatile float sum {};
+
+            for (const auto& word: dictionary) {
+                sum = sum + any_encoder.encode(word).sum();
+            }
+
+            best = std::min(best, std::chrono::duration<double, std::micro>(
+                                      std::chrono::steady_clock::now() - start)
+                                      .count());
+        }
+
+        return best;
+    };
+
+    const double recurrent_time = time_encoding(recurrent_encoder);
+    const double ngram_time = time_encoding(encoder);
+
+    std::cout << "Encoding " << dictionary.size() << " words: recurrent " << recurrent_time
+              << " us, n-gram " << ngram_time << " us\n";
+}
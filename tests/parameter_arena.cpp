@@ -0,0 +1,173 @@
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <vector>
+
+#include <cereal/archives/binary.hpp>
+#include <cereal/archives/json.hpp>
+#include <Eigen/Core>
+
+#include <efuzz/neural_network/neural_network.hpp>
+
+int main() {
+    using efuzz::NeuralNetwork;
+
+    const std::vector<std::size_t> layer_sizes {37, 19, 7, 3};
+    NeuralNetwork network(layer_sizes);
+    const NeuralNetwork copy = network;
+    const NeuralNetwork::NeuralNetworkDiff diff = network.random_diff(7) * 0.25F;
+
+    network.modify(diff);
+
+    for (std::size_t layer {0}; layer < network.weights.size(); ++layer) {
+        if (copy.weights [layer].data() == network.weights [layer].data() ||
+            !copy.weights [layer].isApprox(network.weights [layer] - diff.weight_diffs [layer]) ||
+            !copy.biases [layer].isApprox(network.biases [layer] - diff.bias_diffs [layer])) {
+            std::cout << "Copy shares or mismatches the parameters of layer " << layer << '\n';
+
+            return 1;
+        }
+    }
+
+    NeuralNetwork::ParameterBuffer snapshot;
+
+    network.copy_parameters_to(snapshot);
+    network.modify(network.random_diff(8));
+    network.copy_parameters_from(snapshot);
+    network.modify(diff.inverted());
+
+    const Eigen::VectorXf input = Eigen::VectorXf::Random(37);
+
+    if (!network.compute(input).isApprox(copy.compute(input))) {
+        std::cout << "Restoring a snapshot did not undo the trial diff\n";
+
+        return 1;
+    }
+
+    // The seeded diff draws its values in the same order as when every layer was its own matrix
+    std::mt19937_64 random_engine(7);
+    std::uniform_real_distribution<float> distribution(-1.0F, 1.0F);
+    const NeuralNetwork::NeuralNetworkDiff seeded = network.random_diff(7);
+
+    for (std::size_t layer {0}; layer < seeded.weight_diffs.size(); ++layer) {
+        for (Eigen::Index index {0}; index < seeded.weight_diffs [layer].size(); ++index) {
+            if (seeded.weight_diffs [layer](index) != distribution(random_engine)) {
+                std::cout << "Seeded diff weights changed\n";
+
+                return 1;
+            }
+        }
+
+        for (Eigen::Index index {0}; index < seeded.bias_diffs [layer].size(); ++index) {
+            if (seeded.bias_diffs [layer](index) != distribution(random_engine)) {
+                std::cout << "Seeded diff biases changed\n";
+
+                return 1;
+            }
+        }
+    }
+
+    // Serialized exactly as separate matrices were
+    std::stringstream arena_stream;
+    std::stringstream matrix_stream;
+
+    {
+        cereal::BinaryOutputArchive arena_archive {arena_stream};
+        cereal::BinaryOutputArchive matrix_archive {matrix_stream};
+        const auto& most_recent_diff = network.most_recent_diff;
+
+        arena_archive(network);
+        matrix_archive(network.iterations, network.layer_sizes,
+                       std::vector<Eigen::MatrixXf>(network.weights.begin(), network.weights.end()),
+                       std::vector<Eigen::VectorXf>(network.biases.begin(), network.biases.end()),
+                       std::vector<Eigen::MatrixXf>(most_recent_diff.weight_diffs.begin(),
+                                                    most_recent_diff.weight_diffs.end()),
+                       std::vector<Eigen::VectorXf>(most_recent_diff.bias_diffs.begin(),
+                                                    most_recent_diff.bias_diffs.end()),
+                       most_recent_diff.layer_sizes, network.most_recent_cost,
+                       network.diff_improvement_streak);
+    }
+
+    if (arena_stream.str() != matrix_stream.str()) {
+        std::cout << "Serialization format changed\n";
+
+        return 1;
+    }
+
+    NeuralNetwork loaded;
+
+    {
+        cereal::BinaryInputArchive archive {matrix_stream};
+
+        archive(loaded);
+    }
+
+    if (loaded.layer_sizes != layer_sizes ||
+        !loaded.compute(input).isApprox(network.compute(input))) {
+        std::cout << "Loaded network differs\n";
+
+        return 1;
+    }
+
+    // Text archives get the parameter views as element lists and load them back into the arena
+    std::stringstream json_stream;
+
+    {
+        cereal::JSONOutputArchive archive {json_stream};
+
+        archive(network);
+    }
+
+    NeuralNetwork json_loaded;
+
+    {
+        cereal::JSONInputArchive archive {json_stream};
+
+        archive(json_loaded);
+    }
+
+    if (json_loaded.layer_sizes != layer_sizes ||
+        !json_loaded.compute(input).isApprox(network.compute(input)) ||
+        json_loaded.most_recent_diff.layer_sizes != network.most_recent_diff.layer_sizes) {
+        std::cout << "Network did not survive a JSON archive\n";
+
+        return 1;
+    }
+
+    // A training step's trial and revert, by copying the network versus through a snapshot
+    using clock = std::chrono::steady_clock;
+    constexpr std::size_t trials {2000};
+    NeuralNetwork large({256, 256, 128, 64});
+    const NeuralNetwork::NeuralNetworkDiff large_diff = large.random_diff(3);
+
+    const auto copy_start = clock::now();
+
+    for (std::size_t trial {0}; trial < trials; ++trial) {
+        const NeuralNetwork original = large;
+
+        large.modify(large_diff);
+        large = original;
+    }
+
+    const auto snapshot_start = clock::now();
+
+    for (std::size_t trial {0}; trial < trials; ++trial) {
+        large.copy_parameters_to(snapshot);
+        large.modify(large_diff);
+        large.copy_parameters_from(snapshot);
+    }
+
+    const auto snapshot_end = clock::now();
+
+    std::cout << "Trial and revert by copy: "
+              << std::chrono::duration<double, std::micro>(snapshot_start - copy_start).count() /
+                     trials
+              << " us, by snapshot: "
+              << std::chrono::duration<double, std::micro>(snapshot_end - snapshot_start)
+                         .count() /
+                     trials
+              << " us\n";
+}
@@ -0,0 +1,87 @@
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <efuzz/posting_kernel.hpp>
+
+int main() {
+    std::cout << "Posting kernels: " << efuzz::posting_kernels().name << '\n';
+
+    std::vector<efuzz::PostingKernels> kernels = {
+        {efuzz::posting_decode_portable, efuzz::posting_filter_portable, "portable"}};
+
+#if EFUZZ_POSTING_KERNEL_X86
+    if (__builtin_cpu_supports("avx2")) {
+        kernels.push_back({efuzz::posting_decode_avx2, efuzz::posting_filter_avx2, "avx2"});
+    }
+
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx2")) {
+        kernels.push_back({efuzz::posting_decode_avx2, efuzz::posting_filter_avx512, "avx512"});
+    }
+#endif
+
+    std::mt19937 random_engine(31);
+    std::uniform_int_distribution<int> byte_count(1, 4);
+    std::uniform_int_distribution<std::uint32_t> any_value;
+
+    // Counts that end on whole groups, partial groups and SIMD tails
+    for (const std::size_t count: {0, 1, 3, 4, 5, 15, 16, 17, 64, 301}) {
+        std::vector<std::uint32_t> values;
+        efuzz::StreamVByte stream;
+
+        for (std::size_t index {0}; index < count; ++index) {
+            // Values of every byte length, so every control pattern shows up
+            const int bytes = byte_count(random_engine);
+            const std::uint32_t value =
+                bytes == 4 ? any_value(random_engine)
+                           : any_value(random_engine) & ((1U << (8 * bytes)) - 1U);
+
+            values.push_back(value);
+            efuzz::stream_vbyte_append(stream, index, value);
+        }
+
+        std::vector<std::uint32_t> sums(values.size());
+        std::uint32_t sum {};
+
+        for (std::size_t index {0}; index < values.size(); ++index) {
+            sum += values [index];
+            sums [index] = sum;
+        }
+
+        // Positions in a small range so the window keeps some and drops some
+        std::vector<std::uint32_t> positions;
+        std::vector<std::uint32_t> expected_matches;
+        std::uniform_int_distribution<std::uint32_t> position(0, 12);
+
+        for (std::size_t index {0}; index < count; ++index) {
+            positions.push_back(position(random_engine));
+
+            if (positions.back() >= 4 && positions.back() <= 7) {
+                expected_matches.push_back(sums [index]);
+            }
+        }
+
+        for (const efuzz::PostingKernels& kernel: kernels) {
+            std::vector<std::uint32_t> decoded(count);
+            std::vector<std::uint32_t> decoded_sums(count);
+            std::vector<std::uint32_t> matched(count + 16);
+
+            kernel.decode(stream.control.data(), stream.data.data(), stream.data.size(), count,
+                          false, decoded.data());
+            kernel.decode(stream.control.data(), stream.data.data(), stream.data.size(), count,
+                          true, decoded_sums.data());
+
+            matched.resize(kernel.filter(sums.data(), positions.data(), count, 4, 7,
+                                         matched.data()));
+
+            if (decoded != values || decoded_sums != sums || matched != expected_matches) {
+                std::cout << "The " << kernel.name << " kernels are wrong on " << count
+                          << " values\n";
+
+                return 1;
+            }
+        }
+    }
+}
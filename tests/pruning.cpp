@@ -0,0 +1,177 @@
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <cereal/archives/binary.hpp>
+
+#include <efuzz/encode.hpp>
+#include <efuzz/neural_network/neural_network.hpp>
+#include <efuzz/neural_network/sparse_neural_network.hpp>
+#include <efuzz/train_encoder.hpp>
+
+int main() {
+    using EncoderT = efuzz::Encoder<std::string, std::integral_constant<int, 10>>;
+
+    EncoderT encoder;
+
+    const std::size_t input_size = encoder.get_nn_input_size();
+    const std::size_t output_size = encoder.get_nn_output_size();
+
+    encoder.set_encoding_nn_layer_sizes({input_size, 32, 24, 16, output_size});
+
+    efuzz::EncoderTrainer<std::string, std::integral_constant<int, 10>> encoder_trainer(encoder);
+
+    encoder_trainer.set_dataset(
+        std::vector<std::string> {"airplane", "airport", "apple", "maple", "people", "purple"});
+
+    encoder_trainer.prune_encoder(0.7F, 0.25F);
+
+    EncoderT pruned_encoder = encoder_trainer.get_encoder();
+    const efuzz::NeuralNetwork pruned_nn = pruned_encoder.get_word_vector_encoder_nn();
+
+    std::cout << "Layer sizes after pruning:";
+
+    for (const auto& layer_size: pruned_nn.layer_sizes) {
+        std::cout << ' ' << layer_size;
+    }
+
+    std::cout << "\nWeight density: " << pruned_nn.weight_density() << '\n';
+
+    if (pruned_nn.layer_sizes != std::vector<std::size_t> {input_size, 24, 18, 12, output_size}) {
+        std::cout << "Unexpected layer sizes after neuron pruning\n";
+
+        return 1;
+    }
+
+    if (pruned_nn.weight_density() > 0.31F) {
+        std::cout << "Weight pruning left too many weights\n";
+
+        return 1;
+    }
+
+    const efuzz::SparseNeuralNetwork sparse_nn(pruned_nn);
+    const Eigen::VectorXf input = Eigen::VectorXf::Random(input_size);
+    const float sparse_error = (sparse_nn.compute(input) - pruned_nn.compute(input)).norm();
+
+    std::cout << "Sparse/dense difference: " << sparse_error << '\n';
+
+    if (sparse_error > 1e-5F) {
+        return 1;
+    }
+
+    const auto encoded = pruned_encoder.encode("airplane");
+
+    if (!pruned_encoder.uses_sparse_inference()) {
+        std::cout << "Encoder did not switch to sparse inference\n";
+
+        return 1;
+    }
+
+    // The const single-word and batch paths run the sparse network from the start, without a
+    // non-const encode first, and agree with encode_letter
+    EncoderT sparse_encoder;
+
+    sparse_encoder.set_word_vector_encoder_nn(pruned_nn);
+
+    const EncoderT& const_encoder = sparse_encoder;
+
+    if (!const_encoder.uses_sparse_inference()) {
+        std::cout << "Encoder did not set up sparse inference with the network\n";
+
+        return 1;
+    }
+
+    const std::vector<std::string> words {"airplane", "maple", "", "purple"};
+    const Eigen::MatrixXf batch_encoded = const_encoder.encode_batch(words);
+
+    for (std::size_t index {0}; index < words.size(); ++index) {
+        sparse_encoder.reset_encoding_result();
+
+        for (const char letter: words [index]) {
+            sparse_encoder.encode_letter(letter);
+        }
+
+        const EncoderT::encoding_result_type letter_encoded = sparse_encoder.get_encoding_result();
+        const float const_error = (const_encoder.encode(words [index]) - letter_encoded).norm();
+        const float batch_error =
+            (batch_encoded.col(static_cast<Eigen::Index>(index)) - letter_encoded).norm();
+
+        if (const_error > 1e-5F || batch_error > 1e-5F) {
+            std::cout << "Const encodings of \"" << words [index]
+                      << "\" differ from encode_letter: " << const_error << ", " << batch_error
+                      << '\n';
+
+            return 1;
+        }
+    }
+
+    // Saved and loaded first, so the trainer must keep knowing that it pruned
+    std::stringstream stream;
+
+    {
+        cereal::BinaryOutputArchive archive {stream};
+
+        archive(encoder_trainer);
+    }
+
+    efuzz::EncoderTrainer<std::string, std::integral_constant<int, 10>> loaded_trainer;
+
+    {
+        cereal::BinaryInputArchive archive {stream};
+
+        archive(loaded_trainer);
+    }
+
+    // Before versioning, EncoderTrainer::serialize wrote
+    // archive(_encoder, _dataset, _training_iterations, _cost_log, _encoder_nn_edits), the
+    // dataset then being a shared vector. Such an archive is refused, not misread.
+    using TrainerT = efuzz::EncoderTrainer<std::string, std::integral_constant<int, 10>>;
+
+    std::stringstream legacy_stream;
+
+    {
+        cereal::BinaryOutputArchive archive {legacy_stream};
+
+        archive(encoder,
+                std::optional<std::shared_ptr<std::vector<std::string>>> {
+                    std::make_shared<std::vector<std::string>>(
+                        std::vector<std::string> {"apple", "maple"})},
+                std::size_t {3}, std::vector<TrainerT::CostLogDatapoint> {}, std::size_t {2});
+    }
+
+    bool legacy_refused {false};
+
+    try {
+        TrainerT legacy_trainer;
+        cereal::BinaryInputArchive archive {legacy_stream};
+
+        archive(legacy_trainer);
+    }
+    catch (const cereal::Exception&) {
+        legacy_refused = true;
+    }
+
+    if (!legacy_refused) {
+        std::cout << "Unversioned trainer archive was not refused\n";
+
+        return 1;
+    }
+
+    // Fine-tuning must not regrow pruned weights
+    for (std::size_t iteration {0}; iteration < 20; ++iteration) {
+        loaded_trainer.apply_training_result(loaded_trainer.train_random(8));
+    }
+
+    const float tuned_density =
+        loaded_trainer.get_encoder().get_word_vector_encoder_nn().weight_density();
+
+    std::cout << "Weight density after fine-tuning: " << tuned_density << '\n';
+    std::cout << "Encoded: " << encoded.transpose() << '\n';
+
+    return tuned_density <= pruned_nn.weight_density() ? 0 : 1;
+}
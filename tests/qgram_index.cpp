@@ -0,0 +1,212 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <cereal/archives/binary.hpp>
+#include <rapidfuzz/distance/Levenshtein.hpp>
+
+#include <efuzz/efuzz.hpp>
+#include <efuzz/encode.hpp>
+#include <efuzz/qgram_index.hpp>
+#include <efuzz/search_router.hpp>
+
+int main() {
+    const std::array<std::string, 8> streets {"Maple",  "Oak",   "Station", "Church",
+                                              "Meadow", "Mill",  "Victoria", "Highfield"};
+    const std::array<std::string, 4> suffixes {"Street", "Road", "Avenue", "Lane"};
+    const std::array<std::string, 6> cities {"Springfield", "Riverton", "Lakewood",
+                                             "Fairview",    "Milton",   "Greenville"};
+    std::mt19937 random_engine(29);
+    std::uniform_int_distribution<int> number(1, 400);
+    std::uniform_int_distribution<int> letter('a', 'z');
+    std::vector<std::string> addresses;
+
+    // Similar addresses, so that many entries share most of their q-grams
+    while (addresses.size() < 3000) {
+        addresses.push_back(std::to_string(number(random_engine)) + ' ' +
+                            streets [random_engine() % streets.size()] + ' ' +
+                            suffixes [random_engine() % suffixes.size()] + ", " +
+                            cities [random_engine() % cities.size()]);
+    }
+
+    // Addresses with up to four random edits
+    std::vector<std::string> queries;
+    std::uniform_int_distribution<std::size_t> entry(0, addresses.size() - 1);
+    std::uniform_int_distribution<int> edit(0, 4);
+
+    while (queries.size() < 150) {
+        std::string query = addresses [entry(random_engine)];
+
+        for (int edits = edit(random_engine); edits > 0; --edits) {
+            std::uniform_int_distribution<std::size_t> position(0, query.size() - 1);
+            const std::size_t at = position(random_engine);
+
+            if (edits % 3 == 0) {
+                query.erase(at, 1);
+            }
+            else if (edits % 3 == 1) {
+                query [at] = static_cast<char>(letter(random_engine));
+            }
+            else {
+                query.insert(at, 1, static_cast<char>(letter(random_engine)));
+            }
+        }
+
+        queries.push_back(std::move(query));
+    }
+
+    efuzz::QGramIndex<std::string> index;
+
+    // Split so the second insert appends to existing posting lists
+    index.insert(std::vector<std::string>(addresses.begin(), addresses.begin() + 1200));
+    index.insert(std::vector<std::string>(addresses.begin() + 1200, addresses.end()));
+
+    std::size_t candidates_within_two {};
+
+    for (std::size_t max_edit_distance {0}; max_edit_distance <= 4; ++max_edit_distance) {
+        for (const std::string& query: queries) {
+            std::vector<std::size_t> expected;
+
+            for (std::size_t id {0}; id < addresses.size(); ++id) {
+                if (rapidfuzz::levenshtein_distance(query, addresses [id]) <= max_edit_distance) {
+                    expected.push_back(id);
+                }
+            }
+
+            efuzz::QGramSearchStats stats;
+            std::vector<std::size_t> found;
+
+            for (const auto& result:
+                 index.search(query, addresses.size(), max_edit_distance, &stats)) {
+                found.push_back(result.id);
+            }
+
+            std::sort(found.begin(), found.end());
+
+            if (found != expected) {
+                std::cout << "Query " << query << " at distance " << max_edit_distance
+                          << " found " << found.size() << " entries instead of "
+                          << expected.size() << '\n';
+
+                return 1;
+            }
+
+            if (max_edit_distance == 2) {
+                candidates_within_two += stats.candidate_count;
+            }
+        }
+    }
+
+    const double candidate_share = static_cast<double>(candidates_within_two) /
+                                   static_cast<double>(queries.size() * addresses.size());
+    std::size_t address_bytes {};
+
+    for (const std::string& address: addresses) {
+        address_bytes += address.size();
+    }
+
+    std::cout << "Count filtering verifies " << 100.0 * candidate_share
+              << "% of the entries within two edits; posting lists take "
+              << index.get_posting_bytes() << " bytes for " << address_bytes
+              << " bytes of addresses\n";
+
+    if (candidate_share > 0.1) {
+        std::cout << "Count filtering within two edits lets most of the dictionary through\n";
+
+        return 1;
+    }
+
+    const auto exact = index.search(addresses [42], 3);
+
+    if (exact.empty() || index.get(exact.front().id) != addresses [42] ||
+        exact.front().score != 100.0) {
+        std::cout << "Exact lookup failed\n";
+
+        return 1;
+    }
+
+    std::stringstream stream;
+
+    {
+        cereal::BinaryOutputArchive archive {stream};
+
+        archive(index);
+    }
+
+    efuzz::QGramIndex<std::string> loaded_index;
+
+    {
+        cereal::BinaryInputArchive archive {stream};
+
+        archive(loaded_index);
+    }
+
+    const auto loaded_results = loaded_index.search(queries.front(), 5);
+    const auto results = index.search(queries.front(), 5);
+
+    if (loaded_index.size() != index.size() || loaded_results.size() != results.size() ||
+        (!results.empty() && loaded_results.front().id != results.front().id)) {
+        std::cout << "Loaded index differs from the saved one\n";
+
+        return 1;
+    }
+
+    using SizeT = std::integral_constant<int, 10>;
+    using ContainerT = efuzz::SearchContainer<std::string, SizeT>;
+
+    efuzz::Encoder<std::string, SizeT> encoder;
+
+    encoder.set_encoding_nn_layer_sizes(
+        {encoder.get_nn_input_size(), 16, encoder.get_nn_output_size()});
+
+    ContainerT container(encoder);
+
+    container.insert(std::vector<std::string>(addresses.begin(), addresses.begin() + 1000));
+
+    efuzz::SearchRouter<ContainerT> router(container);
+
+    router.insert(std::vector<std::string>(addresses.begin() + 1000, addresses.end()));
+
+    if (router.get_qgram_index().size() != addresses.size() ||
+        router.route(addresses [7], 3) != efuzz::SearchRoute::qgram_index) {
+        std::cout << "Long queries are not routed to the q-gram index\n";
+
+        return 1;
+    }
+
+    constexpr std::size_t k {5};
+    const auto batch_results = router.search_batch(queries, k, 2);
+
+    for (std::size_t query {0}; query < queries.size(); ++query) {
+        const auto routed_results = router.search(queries [query], k);
+        const auto index_results = index.search(queries [query], k);
+        const bool qgram_route =
+            router.route(queries [query], 3) == efuzz::SearchRoute::qgram_index;
+
+        if (routed_results.size() != k || batch_results [query].size() != k ||
+            (qgram_route && !index_results.empty() &&
+             (routed_results.front().id != index_results.front().id ||
+              batch_results [query].front().id != index_results.front().id))) {
+            std::cout << "Routed search of " << queries [query]
+                      << " differs from the q-gram index\n";
+
+            return 1;
+        }
+    }
+
+    efuzz::SearchRouter<ContainerT> container_router(container, {},
+                                                     {.min_qgram_query_length = 0});
+
+    if (container_router.get_qgram_index().size() != 0 ||
+        container_router.route(addresses [7], 3) != efuzz::SearchRoute::container) {
+        std::cout << "A disabled q-gram index was built or routed to\n";
+
+        return 1;
+    }
+}
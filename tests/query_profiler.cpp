@@ -0,0 +1,84 @@
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <efuzz/efuzz.hpp>
+#include <efuzz/query_profiler.hpp>
+
+int main() {
+    using namespace std::chrono_literals;
+
+    efuzz::LatencyHistogram histogram;
+
+    for (std::int64_t microseconds {1}; microseconds <= 1000; ++microseconds) {
+        histogram.record(std::chrono::microseconds(microseconds));
+    }
+
+    const efuzz::LatencySummary summary = histogram.summary();
+
+    std::cout << "p50 " << summary.p50.count() << " ns, p90 " << summary.p90.count()
+              << " ns, p99 " << summary.p99.count() << " ns, max " << summary.max.count()
+              << " ns\n";
+
+    // Buckets are at most 1/16 wide relative to their values
+    const auto near = [](std::chrono::nanoseconds actual, std::chrono::nanoseconds expected) {
+        return actual >= expected && actual <= expected + (expected / 16);
+    };
+
+    if (summary.count != 1000 || !near(summary.p50, 500us) || !near(summary.p90, 900us) ||
+        !near(summary.p99, 990us) || summary.max != 1000us || summary.mean != 500500ns) {
+        std::cout << "Histogram quantiles are off\n";
+
+        return 1;
+    }
+
+    using EncoderT = efuzz::Encoder<std::string, std::integral_constant<int, 10>>;
+
+    EncoderT encoder;
+
+    encoder.set_encoding_nn_layer_sizes(
+        {encoder.get_nn_input_size(), 16, 12, encoder.get_nn_output_size()});
+
+    efuzz::SearchContainer<std::string, std::integral_constant<int, 10>> container(encoder);
+
+    container.insert({"airplane", "airport", "apple", "maple", "people", "purple", "table"});
+    container.enable_query_cache(16);
+    container.enable_query_profiling(4);
+
+    for (std::size_t iteration {0}; iteration < 40; ++iteration) {
+        static_cast<void>(container.search(iteration % 2 == 0 ? "aple" : "tabel", 3));
+    }
+
+    const efuzz::QueryLatencySnapshot latency = container.get_query_latency().value();
+    const auto traces = container.get_query_traces();
+
+    for (std::size_t stage {0}; stage < efuzz::QUERY_STAGE_COUNT; ++stage) {
+        const auto& stage_summary = latency.stages [stage];
+
+        std::cout << efuzz::query_stage_name(static_cast<efuzz::QueryStage>(stage)) << ": "
+                  << stage_summary.count << " samples, p99 " << stage_summary.p99.count()
+                  << " ns\n";
+    }
+
+#if EFUZZ_QUERY_PROFILING
+    const auto& rerank = latency.stages [static_cast<std::size_t>(efuzz::QueryStage::rerank)];
+
+    // Only the first search of each query misses the cache
+    if (latency.total.count != 40 || rerank.count != 2 || traces.size() != 10 ||
+        traces.front().cache_hit || !traces.back().cache_hit ||
+        traces.front().candidate_count != container.size()) {
+        std::cout << "Search path was not profiled as expected\n";
+
+        return 1;
+    }
+#else
+    if (latency.total.count != 0 || !traces.empty()) {
+        std::cout << "Profiling was compiled out but still recorded\n";
+
+        return 1;
+    }
+#endif
+}
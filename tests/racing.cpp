@@ -0,0 +1,188 @@
+#include <cstddef>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <cereal/archives/binary.hpp>
+
+#include <efuzz/encode.hpp>
+#include <efuzz/racing.hpp>
+#include <efuzz/train_encoder.hpp>
+
+#include "test_words.hpp"
+
+int main() {
+    using efuzz::CandidateRace;
+    using efuzz::RacingRule;
+
+    constexpr std::size_t pair_count {1000};
+
+    // Far worse on every pair: Hoeffding gives up long before the last pair
+    CandidateRace hoeffding({.rule = RacingRule::hoeffding});
+
+    hoeffding.start(pair_count, 0.2F);
+
+    while (!hoeffding.lost() && hoeffding.scored_count() < pair_count) {
+        hoeffding.record(0.2F, 0.9F);
+    }
+
+    if (!hoeffding.lost() || hoeffding.scored_count() >= pair_count / 4) {
+        std::cout << "Hoeffding racing scored " << hoeffding.scored_count() << " pairs\n";
+
+        return 1;
+    }
+
+    // Slightly worse on every pair, which only the variance-aware bound sees early
+    CandidateRace interval({.rule = RacingRule::confidence_interval});
+    CandidateRace slow_hoeffding({.rule = RacingRule::hoeffding});
+
+    interval.start(pair_count, 0.3F);
+    slow_hoeffding.start(pair_count, 0.3F);
+
+    std::mt19937 random_engine(3);
+    std::uniform_real_distribution<float> noise(-0.1F, 0.1F);
+
+    while (!interval.lost() && interval.scored_count() < pair_count) {
+        interval.record(0.3F, 0.32F + noise(random_engine));
+    }
+
+    while (!slow_hoeffding.lost() && slow_hoeffding.scored_count() < pair_count) {
+        slow_hoeffding.record(0.3F, 0.32F + noise(random_engine));
+    }
+
+    if (interval.scored_count() >= slow_hoeffding.scored_count() ||
+        interval.scored_count() >= pair_count / 4) {
+        std::cout << "Confidence interval racing scored " << interval.scored_count()
+                  << " pairs, Hoeffding " << slow_hoeffding.scored_count() << '\n';
+
+        return 1;
+    }
+
+    // A better candidate is never rejected, however noisy its costs
+    CandidateRace better({.rule = RacingRule::confidence_interval});
+
+    better.start(pair_count, 0.5F);
+
+    for (const std::size_t index: better.order()) {
+        const float original_pair_cost = 0.4F + (static_cast<float>(index % 3) * 0.1F);
+
+        better.record(original_pair_cost, original_pair_cost - 0.02F + noise(random_engine));
+
+        if (better.lost()) {
+            std::cout << "Better candidate rejected after " << better.scored_count()
+                      << " pairs\n";
+
+            return 1;
+        }
+    }
+
+    using SizeT = std::integral_constant<int, 8>;
+    using TrainerT = efuzz::EncoderTrainer<std::string, SizeT>;
+
+    const std::vector<std::string> dictionary =
+        efuzz_test::random_words(random_engine, 300, 'a', 'h', 3, 10);
+
+    efuzz::Encoder<std::string, SizeT> encoder;
+
+    encoder.set_encoding_nn_layer_sizes(
+        {encoder.get_nn_input_size(), 24, encoder.get_nn_output_size()});
+
+    TrainerT full_trainer(encoder, dictionary);
+    TrainerT racing_trainer(encoder, dictionary);
+    std::vector<TrainerT::IdPair> pairs;
+    std::uniform_int_distribution<std::size_t> entry(0, dictionary.size() - 1);
+
+    while (pairs.size() < 512) {
+        const std::size_t id_1 = entry(random_engine);
+        const std::size_t id_2 = entry(random_engine);
+
+        if (id_1 != id_2) {
+            pairs.emplace_back(id_1, id_2);
+        }
+    }
+
+    racing_trainer.set_racing({.rule = RacingRule::confidence_interval, .seed = 7});
+
+    const float initial_cost = full_trainer.average_cost(pairs);
+
+    constexpr std::size_t rounds {150};
+    std::size_t full_scored {};
+    std::size_t racing_scored {};
+    std::size_t rejected_early {};
+
+    for (std::size_t round {0}; round < rounds; ++round) {
+        const TrainerT::TrainingResult full_result = full_trainer.train(pairs);
+        const TrainerT::TrainingResult racing_result = racing_trainer.train(pairs);
+
+        if (full_result.rejected_early || full_result.scored_pairs != pairs.size()) {
+            std::cout << "Training without racing stopped early\n";
+
+            return 1;
+        }
+
+        if (racing_result.diff && racing_result.scored_pairs != pairs.size()) {
+            std::cout << "A diff was accepted without scoring every pair\n";
+
+            return 1;
+        }
+
+        full_scored += full_result.scored_pairs;
+        racing_scored += racing_result.scored_pairs;
+        rejected_early += static_cast<std::size_t>(racing_result.rejected_early);
+        full_trainer.apply_training_result(full_result);
+        racing_trainer.apply_training_result(racing_result);
+    }
+
+    const float full_cost = full_trainer.average_cost(pairs);
+    const float racing_cost = racing_trainer.average_cost(pairs);
+
+    std::cout << "Cost " << initial_cost << " -> " << full_cost << " scoring every pair, "
+              << racing_cost << " racing; candidates scored on "
+              << racing_scored << " instead of " << full_scored << " pairs, " << rejected_early
+              << " of " << rounds << " rejected early\n";
+
+    if (rejected_early == 0 || racing_scored >= full_scored) {
+        std::cout << "Racing never stopped a candidate early\n";
+
+        return 1;
+    }
+
+    // A bound that rejects improving candidates too often gives up most of the improvement
+    if (racing_cost - full_cost > 0.1F * (initial_cost - full_cost)) {
+        std::cout << "Racing lost more than a tenth of the cost improvement\n";
+
+        return 1;
+    }
+
+    // Before versioning, TrainingResult::serialize wrote archive(diff, original_cost,
+    // modified_cost). Such a result is refused, not misread.
+    std::stringstream legacy_stream;
+
+    {
+        cereal::BinaryOutputArchive archive {legacy_stream};
+
+        archive(std::optional<efuzz::NeuralNetwork::NeuralNetworkDiff> {}, 0.5F, 0.25F);
+    }
+
+    bool legacy_refused {false};
+
+    try {
+        TrainerT::TrainingResult legacy_result;
+        cereal::BinaryInputArchive archive {legacy_stream};
+
+        archive(legacy_result);
+    }
+    catch (const cereal::Exception&) {
+        legacy_refused = true;
+    }
+
+    if (!legacy_refused) {
+        std::cout << "Unversioned training result was not refused\n";
+
+        return 1;
+    }
+}
@@ -0,0 +1,246 @@
+#include <cstddef>
+#include <iostream>
+#include <ranges>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <cereal/archives/json.hpp>
+
+#include <efuzz/efuzz.hpp>
+#include <efuzz/encode.hpp>
+
+int main() {
+    using EncoderT = efuzz::Encoder<std::string, std::integral_constant<int, 10>>;
+
+    EncoderT encoder;
+
+    encoder.set_encoding_nn_layer_sizes(
+        {encoder.get_nn_input_size(), 16, 12, encoder.get_nn_output_size()});
+
+    const std::vector<std::string> dictionary = {
+        "airplane", "airport", "apple",  "maple",  "people", "purple",  "table",
+        "cable",    "fable",   "stable", "staple", "simple", "example", "sample"};
+
+    efuzz::SearchContainer<std::string, std::integral_constant<int, 10>> container(encoder);
+
+    container.insert(dictionary);
+    container.set_query_normalizer([](const std::string& query) {
+        const auto first = query.find_first_not_of(' ');
+        const auto last = query.find_last_not_of(' ');
+
+        return first == std::string::npos ? std::string {} : query.substr(first, last - first + 1);
+    });
+    container.enable_query_cache(8, 2);
+
+    for (std::size_t id {0}; id < dictionary.size(); ++id) {
+        const auto results = container.search(dictionary [id], 3);
+
+        if (results.empty() || results.front().id != id || results.front().score != 100.0) {
+            std::cout << "Exact lookup of " << dictionary [id] << " failed\n";
+
+            return 1;
+        }
+    }
+
+    const auto first = container.search("  staple ", 3);
+    const auto second = container.search("staple", 2);
+
+    std::cout << "Results for staple:";
+
+    for (const auto& result: first) {
+        std::cout << ' ' << container.get(result.id) << " (" << result.score << ")";
+    }
+
+    std::cout << '\n';
+
+    if (second.size() != 2 || second.front().id != first.front().id) {
+        std::cout << "Cached results differ from computed results\n";
+
+        return 1;
+    }
+
+    std::vector<std::thread> threads;
+
+    for (std::size_t thread {0}; thread < 4; ++thread) {
+        threads.emplace_back([&container, &dictionary, thread]() {
+            for (std::size_t iteration {0}; iteration < 200; ++iteration) {
+                static_cast<void>(
+                    container.search(dictionary [(thread + iteration) % dictionary.size()], 3));
+            }
+        });
+    }
+
+    for (auto& thread: threads) {
+        thread.join();
+    }
+
+    static_cast<void>(container.search("staple", 2));
+
+    const auto before_insert = container.get_query_cache_stats().value();
+
+    container.insert("stapler");
+
+    const auto after_insert = container.search("staple", 2);
+    const auto stats = container.get_query_cache_stats().value();
+
+    std::cout << "Cache hits: " << stats.hits << ", misses: " << stats.misses
+              << ", evictions: " << stats.evictions << ", invalidations: " << stats.invalidations
+              << ", size: " << stats.size << '/' << stats.capacity << '\n';
+
+    if (before_insert.hits == 0 || stats.evictions == 0 ||
+        stats.invalidations <= before_insert.invalidations) {
+        std::cout << "Unexpected cache statistics\n";
+
+        return 1;
+    }
+
+    if (after_insert.size() != 2) {
+        return 1;
+    }
+
+    // Compressed candidate storage must still find exact matches among a larger dictionary
+    std::vector<std::string> large_dictionary;
+    const std::vector<std::string> syllables = {"ka", "ro", "mi", "te", "su", "an", "li", "po"};
+
+    for (const auto& first_syllable: syllables) {
+        for (const auto& second_syllable: syllables) {
+            for (const auto& third_syllable: syllables) {
+                large_dictionary.push_back(first_syllable + second_syllable + third_syllable);
+            }
+        }
+    }
+
+    efuzz::SearchContainer<std::string, std::integral_constant<int, 10>> large_container(encoder);
+
+    large_container.insert(large_dictionary);
+
+    for (const auto storage: {efuzz::EmbeddingStorage::float32, efuzz::EmbeddingStorage::float16,
+                              efuzz::EmbeddingStorage::product_quantized}) {
+        large_container.set_embedding_storage(storage);
+
+        std::size_t found {};
+
+        for (std::size_t id {0}; id < large_dictionary.size(); ++id) {
+            const auto results = large_container.search(large_dictionary [id], 1);
+
+            found += static_cast<std::size_t>(!results.empty() && results.front().id == id);
+        }
+
+        const float recall = static_cast<float>(found) / large_dictionary.size();
+
+        std::cout << "Storage " << static_cast<int>(storage) << ": "
+                  << large_container.get_embedding_store().bytes_per_embedding()
+                  << " bytes per entry, exact match recall " << recall << '\n';
+
+        // The encoder is untrained, so many embeddings sit closer together than float16 resolves
+        if (recall < 0.85F) {
+            return 1;
+        }
+    }
+
+    // Only the flat index compresses its embeddings; other backends refuse compressed storage
+    bool threw {};
+
+    try {
+        large_container.set_vector_index(efuzz::VectorIndexType::hnsw);
+    }
+    catch (const std::invalid_argument&) {
+        threw = true;
+    }
+
+    large_container.set_embedding_storage(efuzz::EmbeddingStorage::float32);
+    large_container.set_vector_index(efuzz::VectorIndexType::hnsw);
+
+    try {
+        large_container.set_embedding_storage(efuzz::EmbeddingStorage::float16);
+        threw = false;
+    }
+    catch (const std::invalid_argument&) {
+    }
+
+    if (!threw || large_container.get_vector_index_type() != efuzz::VectorIndexType::hnsw) {
+        std::cout << "Compressed storage was accepted with the HNSW index\n";
+
+        return 1;
+    }
+
+    large_container.set_vector_index(efuzz::VectorIndexType::flat);
+
+    // Text archives have no binary data; float16 embeddings go through them as bit patterns
+    efuzz::EmbeddingStore half_store(3, efuzz::EmbeddingStorage::float16);
+    const std::vector<float> half_embedding {0.5F, -1.25F, 3.0F};
+
+    half_store.append(half_embedding.data());
+
+    std::stringstream json;
+
+    {
+        cereal::JSONOutputArchive archive {json};
+
+        archive(half_store);
+    }
+
+    efuzz::EmbeddingStore loaded_half_store;
+
+    {
+        cereal::JSONInputArchive archive {json};
+
+        archive(loaded_half_store);
+    }
+
+    if (loaded_half_store.size() != 1 || loaded_half_store.get(0) != half_store.get(0)) {
+        std::cout << "float16 embeddings did not survive a JSON archive\n";
+
+        return 1;
+    }
+
+    // A lazy search reading one result should only have scored its first candidates
+
+    auto lazy_search = large_container.search_lazily(large_dictionary [100]);
+    const auto first_result = lazy_search.next();
+
+    if (!first_result.has_value() || first_result->id != 100 ||
+        lazy_search.get_candidate_count() != large_container.DEFAULT_LAZY_CANDIDATE_COUNT) {
+        std::cout << "Lazy search did not stop early\n";
+
+        return 1;
+    }
+
+    std::size_t lazy_count {1};
+    double previous_score {first_result->score};
+
+    for (const auto& result: lazy_search | std::views::take(40)) {
+        lazy_count++;
+        previous_score = result.score;
+    }
+
+    const auto eager_results = large_container.search(large_dictionary [100], 41);
+
+    std::cout << "Lazy search widened to " << lazy_search.get_candidate_count()
+              << " candidates for " << lazy_count << " results\n";
+
+    if (lazy_count != 41 || lazy_search.get_candidate_count() < 64 ||
+        previous_score < eager_results.back().score) {
+        std::cout << "Lazy search results do not match the eager search\n";
+
+        return 1;
+    }
+
+    std::size_t total_count {};
+
+    for ([[maybe_unused]] const auto& result: large_container.search_lazily("kamite")) {
+        total_count++;
+    }
+
+    if (total_count != large_container.size()) {
+        std::cout << "Lazy search did not reach every entry\n";
+
+        return 1;
+    }
+
+    return 0;
+}
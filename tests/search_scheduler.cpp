@@ -0,0 +1,176 @@
+#include <chrono>
+#include <cstddef>
+#include <future>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <efuzz/efuzz.hpp>
+#include <efuzz/search_scheduler.hpp>
+
+#include "test_words.hpp"
+
+int main() {
+    using EncoderT = efuzz::Encoder<std::string, std::integral_constant<int, 10>>;
+    using ContainerT = efuzz::SearchContainer<std::string, std::integral_constant<int, 10>>;
+
+    EncoderT encoder;
+
+    encoder.set_encoding_nn_layer_sizes(
+        {encoder.get_nn_input_size(), 32, 24, encoder.get_nn_output_size()});
+
+    std::mt19937 random_engine(11);
+    std::vector<std::string> dictionary =
+        efuzz_test::random_words(random_engine, 2000, 'a', 'z', 0, 14);
+
+    const Eigen::MatrixXf batch_encodings = encoder.encode_batch(dictionary);
+
+    for (std::size_t word {0}; word < dictionary.size(); ++word) {
+        const auto encoding = encoder.encode(dictionary [word]);
+
+        if (!batch_encodings.col(static_cast<Eigen::Index>(word)).isApprox(encoding, 1e-4F) &&
+            (batch_encodings.col(static_cast<Eigen::Index>(word)) - encoding).norm() > 1e-5F) {
+            std::cout << "Batched encoding of " << dictionary [word] << " differs\n";
+
+            return 1;
+        }
+    }
+
+    ContainerT container(encoder);
+
+    container.insert(dictionary);
+
+    const std::vector<std::string> queries(dictionary.begin(), dictionary.begin() + 100);
+    std::vector<std::vector<efuzz::SearchResult>> expected;
+
+    for (const auto& query: queries) {
+        expected.push_back(container.search(query, 3));
+    }
+
+    container.enable_query_cache(256);
+
+    // The second batch is answered from the query cache
+    for (std::size_t pass {0}; pass < 2; ++pass) {
+        const auto results = container.search_batch(queries, 3, 4);
+
+        for (std::size_t query {0}; query < queries.size(); ++query) {
+            // Batched encodings may differ in the last bits, so only the best match must agree
+            if (results [query].size() != expected [query].size() ||
+                results [query].front().score != expected [query].front().score ||
+                dictionary [results [query].front().id] != queries [query]) {
+                std::cout << "Batched search of " << queries [query] << " differs on pass "
+                          << pass << '\n';
+
+                return 1;
+            }
+        }
+    }
+
+    if (container.get_query_cache_stats()->hits != queries.size()) {
+        std::cout << "Batched search did not use the query cache\n";
+
+        return 1;
+    }
+
+    // One result count per query, each answered as search() would answer it alone
+    std::vector<std::size_t> ks;
+
+    for (std::size_t query {0}; query < queries.size(); ++query) {
+        ks.push_back(query % 10 == 0 ? 200 : 1 + query % 4);
+    }
+
+    const auto mixed_results = container.search_batch(queries, ks, 4);
+
+    for (std::size_t query {0}; query < queries.size(); ++query) {
+        const auto single_results = container.search(queries [query], ks [query]);
+
+        if (mixed_results [query].size() != single_results.size() ||
+            mixed_results [query].front().id != single_results.front().id) {
+            std::cout << "Batched search of " << queries [query] << " for " << ks [query]
+                      << " results differs from a single search\n";
+
+            return 1;
+        }
+    }
+
+    efuzz::SearchSchedulerOptions options;
+
+    options.max_batch_size = 32;
+    options.batch_window = std::chrono::milliseconds(2);
+    options.queue_capacity = 64;
+
+    efuzz::SearchSchedulerStats stats;
+    std::size_t mismatches {};
+
+    {
+        efuzz::SearchScheduler<ContainerT> scheduler(container, options);
+        std::vector<std::vector<std::future<std::vector<efuzz::SearchResult>>>> futures(8);
+        std::vector<std::thread> clients;
+
+        for (std::size_t client {0}; client < futures.size(); ++client) {
+            clients.emplace_back([&scheduler, &dictionary, &futures, client]() {
+                for (std::size_t query {client}; query < 800; query += 8) {
+                    futures [client].push_back(scheduler.submit(dictionary [query], 1 + query % 4));
+                }
+            });
+        }
+
+        for (auto& client: clients) {
+            client.join();
+        }
+
+        for (std::size_t client {0}; client < futures.size(); ++client) {
+            for (std::size_t index {0}; index < futures [client].size(); ++index) {
+                const std::size_t query = client + index * 8;
+                const auto results = futures [client][index].get();
+
+                if (results.size() != 1 + query % 4 ||
+                    dictionary [results.front().id] != dictionary [query]) {
+                    ++mismatches;
+                }
+            }
+        }
+
+        std::promise<std::size_t> callback_count;
+
+        scheduler.submit(dictionary [7], 2,
+                         [&callback_count](std::vector<efuzz::SearchResult> results,
+                                           const std::exception_ptr& exception) {
+                             callback_count.set_value(exception ? 0 : results.size());
+                         });
+
+        if (callback_count.get_future().get() != 2) {
+            ++mismatches;
+        }
+
+        stats = scheduler.get_stats();
+    }
+
+    std::cout << stats.query_count << " queries in " << stats.batch_count
+              << " batches, largest " << stats.largest_batch << '\n';
+
+    if (mismatches != 0 || stats.query_count != 801 || stats.batch_count >= stats.query_count ||
+        stats.largest_batch > options.max_batch_size) {
+        std::cout << mismatches << " scheduled searches were wrong or nothing was batched\n";
+
+        return 1;
+    }
+
+    // Errors reach the futures of every query in the failed batch
+    const ContainerT untrained_container;
+    efuzz::SearchScheduler<ContainerT> failing_scheduler(untrained_container);
+    auto failing_future = failing_scheduler.submit("query", 1);
+
+    try {
+        failing_future.get();
+        std::cout << "Search without an encoder did not fail\n";
+
+        return 1;
+    }
+    catch (const std::runtime_error&) {
+    }
+}
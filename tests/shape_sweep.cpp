@@ -0,0 +1,99 @@
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <efuzz/ngram_encode.hpp>
+#include <efuzz/shape_sweep.hpp>
+
+#include "test_words.hpp"
+
+int main() {
+    std::mt19937 random_engine(11);
+    std::vector<std::string> dictionary =
+        efuzz_test::random_words(random_engine, 300, 'a', 'z', 4, 10);
+
+    efuzz::ShapeSweepOptions options;
+
+    options.training_rounds = 5;
+    options.pairs_per_round = 32;
+    options.query_count = 50;
+    options.seed = 5;
+
+    auto results = efuzz::sweep_encoder_shapes(
+        dictionary, efuzz::make_shape_grid({4, 12}, {{}, {24}, {48, 24}}), options);
+
+    if (results.size() != 6 || results [5].shape.encoding_result_size != 12 ||
+        results [5].encoder.get_nn_output_size() != 12) {
+        std::cout << "Sweep did not cover the grid\n";
+
+        return 1;
+    }
+
+    std::stringstream frontier;
+
+    efuzz::write_pareto_frontier(frontier, results);
+    std::cout << frontier.str();
+
+    for (const auto& result: results) {
+        bool dominated {};
+
+        for (const auto& other: results) {
+            dominated = dominated || (other.encode_latency <= result.encode_latency &&
+                                      other.recall >= result.recall &&
+                                      (other.encode_latency < result.encode_latency ||
+                                       other.recall > result.recall));
+        }
+
+        if (result.pareto_optimal == dominated || result.recall < 0.0F || result.recall > 1.0F) {
+            std::cout << "Pareto frontier is inconsistent\n";
+
+            return 1;
+        }
+    }
+
+    const auto chosen = efuzz::choose_shape(results);
+
+    if (!chosen || !results [*chosen].pareto_optimal) {
+        std::cout << "Chosen shape is not on the frontier\n";
+
+        return 1;
+    }
+
+    if (efuzz::choose_shape(results, std::chrono::nanoseconds {1}).has_value()) {
+        std::cout << "A 1 ns budget was met\n";
+
+        return 1;
+    }
+
+    const std::filesystem::path path =
+        std::filesystem::temp_directory_path() / "efuzz_shape_sweep_encoder.bin";
+
+    efuzz::save_encoder(results [*chosen].encoder, path);
+
+    const auto loaded =
+        efuzz::load_encoder<efuzz::SweepEncoder<efuzz::Encoder, std::string>>(path);
+
+    std::filesystem::remove(path);
+
+    if (!loaded.encode(dictionary [7]).isApprox(results [*chosen].encoder.encode(dictionary [7]))) {
+        std::cout << "Saved encoder does not encode like the chosen one\n";
+
+        return 1;
+    }
+
+    const auto ngram_results = efuzz::sweep_encoder_shapes<efuzz::NGramEncoder>(
+        dictionary, {{.encoding_result_size = 8, .hidden_layer_sizes = {32}}}, options,
+        efuzz::SweepEncoder<efuzz::NGramEncoder, std::string>(256));
+
+    if (ngram_results.size() != 1 || !ngram_results.front().pareto_optimal ||
+        ngram_results.front().encoder.get_nn_output_size() != 8) {
+        std::cout << "N-gram encoder sweep failed\n";
+
+        return 1;
+    }
+}
@@ -0,0 +1,94 @@
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <efuzz/encode.hpp>
+#include <efuzz/neural_network/neural_network.hpp>
+#include <efuzz/static_encoder.hpp>
+
+// Written by efuzz::write_static_encoder for the network built in make_model_network()
+#include "static_encoder_model.hpp"
+
+namespace {
+    efuzz::NeuralNetwork make_model_network() {
+        efuzz::NeuralNetwork network({12, 6, 4}, false);
+
+        for (std::size_t layer {0}; layer < network.weights.size(); ++layer) {
+            auto& weights = network.weights [layer];
+            auto& biases = network.biases [layer];
+
+            for (Eigen::Index index {0}; index < weights.size(); ++index) {
+                weights(index) =
+                    static_cast<float>(static_cast<int>((index * 37 + layer * 11) % 17) - 8) / 8.0F;
+            }
+
+            for (Eigen::Index index {0}; index < biases.size(); ++index) {
+                biases(index) =
+                    static_cast<float>(static_cast<int>((index * 5 + layer) % 7) - 3) / 4.0F;
+            }
+        }
+
+        return network;
+    }
+} // namespace
+
+int main() {
+    static_assert(efuzz_test_model::Encoder::encoding_result_size == 4);
+    static_assert(efuzz_test_model::network.layer_sizes [1] == 6);
+
+    using EncoderT = efuzz::Encoder<std::string, std::integral_constant<int, 4>>;
+
+    EncoderT encoder;
+
+    encoder.set_word_vector_encoder_nn(make_model_network());
+
+    for (const std::string word: {"", "a", "apple", "staple", "constexpr"}) {
+        if (efuzz_test_model::encoder.encode(word) != encoder.encode(word)) {
+            std::cout << "Compiled encoder disagrees with Encoder on \"" << word << "\"\n";
+
+            return 1;
+        }
+    }
+
+    // Every exported float must parse back to the exact parameter
+    const efuzz::NeuralNetwork network({24, 7, 5});
+    std::stringstream header;
+
+    efuzz::write_static_neural_network(header, network, "exported::model");
+
+    std::vector<float> expected;
+
+    for (std::size_t layer {0}; layer < network.weights.size(); ++layer) {
+        const auto& weights = network.weights [layer];
+        const auto& biases = network.biases [layer];
+
+        expected.insert(expected.end(), weights.data(), weights.data() + weights.size());
+        expected.insert(expected.end(), biases.data(), biases.data() + biases.size());
+    }
+
+    std::vector<float> parsed;
+    std::string token;
+
+    while (header >> token) {
+        if (token.find("0x") != std::string::npos && token.find('F') != std::string::npos) {
+            parsed.push_back(std::strtof(token.c_str(), nullptr));
+        }
+    }
+
+    std::cout << "Parsed " << parsed.size() << " of " << expected.size() << " parameters\n";
+
+    if (parsed != expected) {
+        std::cout << "Exported parameters do not round-trip\n";
+
+        return 1;
+    }
+
+    if (efuzz::static_header_guard("exported::model") != "EXPORTED_MODEL_HPP") {
+        std::cout << "Unexpected include guard\n";
+
+        return 1;
+    }
+}
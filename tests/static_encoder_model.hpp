@@ -0,0 +1,54 @@
+// Generated by efuzz::write_static_encoder. Do not edit.
+#ifndef EFUZZ_TEST_MODEL_HPP
+#define EFUZZ_TEST_MODEL_HPP
+
+#include <string>
+
+#include <efuzz/static_encoder.hpp>
+
+namespace efuzz_test_model {
+    alignas(64) inline constexpr float layer_0_weights [72] {
+        -0x1p+0F, -0x1.4p-1F, -0x1p-2F, 0x1p-3F,
+        0x1p-1F, 0x1.cp-1F, -0x1.cp-1F, -0x1p-1F,
+        -0x1p-3F, 0x1p-2F, 0x1.4p-1F, 0x1p+0F,
+        -0x1.8p-1F, -0x1.8p-2F, 0x0p+0F, 0x1.8p-2F,
+        0x1.8p-1F, -0x1p+0F, -0x1.4p-1F, -0x1p-2F,
+        0x1p-3F, 0x1p-1F, 0x1.cp-1F, -0x1.cp-1F,
+        -0x1p-1F, -0x1p-3F, 0x1p-2F, 0x1.4p-1F,
+        0x1p+0F, -0x1.8p-1F, -0x1.8p-2F, 0x0p+0F,
+        0x1.8p-2F, 0x1.8p-1F, -0x1p+0F, -0x1.4p-1F,
+        -0x1p-2F, 0x1p-3F, 0x1p-1F, 0x1.cp-1F,
+        -0x1.cp-1F, -0x1p-1F, -0x1p-3F, 0x1p-2F,
+        0x1.4p-1F, 0x1p+0F, -0x1.8p-1F, -0x1.8p-2F,
+        0x0p+0F, 0x1.8p-2F, 0x1.8p-1F, -0x1p+0F,
+        -0x1.4p-1F, -0x1p-2F, 0x1p-3F, 0x1p-1F,
+        0x1.cp-1F, -0x1.cp-1F, -0x1p-1F, -0x1p-3F,
+        0x1p-2F, 0x1.4p-1F, 0x1p+0F, -0x1.8p-1F,
+        -0x1.8p-2F, 0x0p+0F, 0x1.8p-2F, 0x1.8p-1F,
+        -0x1p+0F, -0x1.4p-1F, -0x1p-2F, 0x1p-3F};
+
+    alignas(64) inline constexpr float layer_0_biases [6] {
+        -0x1.8p-1F, 0x1p-1F, 0x0p+0F, -0x1p-1F,
+        0x1.8p-1F, 0x1p-2F};
+
+    alignas(64) inline constexpr float layer_1_weights [24] {
+        0x1.8p-2F, 0x1.8p-1F, -0x1p+0F, -0x1.4p-1F,
+        -0x1p-2F, 0x1p-3F, 0x1p-1F, 0x1.cp-1F,
+        -0x1.cp-1F, -0x1p-1F, -0x1p-3F, 0x1p-2F,
+        0x1.4p-1F, 0x1p+0F, -0x1.8p-1F, -0x1.8p-2F,
+        0x0p+0F, 0x1.8p-2F, 0x1.8p-1F, -0x1p+0F,
+        -0x1.4p-1F, -0x1p-2F, 0x1p-3F, 0x1p-1F};
+
+    alignas(64) inline constexpr float layer_1_biases [4] {
+        -0x1p-1F, 0x1.8p-1F, 0x1p-2F, -0x1p-2F};
+
+    inline constexpr efuzz::StaticNeuralNetwork<12, 6, 4> network {
+        {layer_0_weights, layer_1_weights},
+        {layer_0_biases, layer_1_biases}};
+
+    using Encoder = efuzz::StaticEncoder<std::string, std::remove_cvref_t<decltype(network)>>;
+
+    inline constexpr Encoder encoder {network};
+} // namespace efuzz_test_model
+
+#endif // EFUZZ_TEST_MODEL_HPP
@@ -0,0 +1,146 @@
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <efuzz/encode.hpp>
+#include <efuzz/step_size.hpp>
+#include <efuzz/train_encoder.hpp>
+
+int main() {
+    using efuzz::StepSizeControl;
+    using efuzz::StepSizeRule;
+
+    // One improvement and four failures leave the scale where it was
+    StepSizeControl one_fifth({.rule = StepSizeRule::one_fifth_success, .initial_scale = 0.1F});
+
+    one_fifth.record(true);
+
+    for (int failure {0}; failure < 4; ++failure) {
+        one_fifth.record(false);
+    }
+
+    if (std::abs(one_fifth.scale() - 0.1F) > 1e-5F || one_fifth.trial_count() != 5) {
+        std::cout << "1/5th rule moved off its equilibrium: " << one_fifth.scale() << '\n';
+
+        return 1;
+    }
+
+    StepSizeControl cumulative({.rule = StepSizeRule::cumulative, .initial_scale = 0.1F});
+
+    for (int success {0}; success < 10; ++success) {
+        cumulative.record(true);
+    }
+
+    const float grown_scale = cumulative.scale();
+
+    for (int failure {0}; failure < 200; ++failure) {
+        cumulative.record(false);
+    }
+
+    if (!(grown_scale > 0.1F) || cumulative.scale() != cumulative.get_options().min_scale ||
+        cumulative.success_rate() > 0.01F) {
+        std::cout << "Cumulative rule did not follow the success rate: " << grown_scale << ", "
+                  << cumulative.scale() << '\n';
+
+        return 1;
+    }
+
+    StepSizeControl annealing({.rule = StepSizeRule::cosine_annealing,
+                               .min_scale = 0.01F,
+                               .max_scale = 1.0F,
+                               .annealing_period = 10});
+    float halfway_scale {};
+
+    for (int trial {1}; trial <= 10; ++trial) {
+        annealing.record(trial % 2 == 0);
+
+        if (trial == 5) {
+            halfway_scale = annealing.scale();
+        }
+    }
+
+    if (std::abs(halfway_scale - 0.505F) > 1e-4F || std::abs(annealing.scale() - 1.0F) > 1e-6F) {
+        std::cout << "Cosine annealing is off: " << halfway_scale << " halfway, "
+                  << annealing.scale() << " after a period\n";
+
+        return 1;
+    }
+
+    bool threw {};
+
+    try {
+        StepSizeControl invalid({.min_scale = 1.0F, .max_scale = 0.5F});
+    }
+    catch (const std::runtime_error&) {
+        threw = true;
+    }
+
+    if (!threw) {
+        std::cout << "Inverted step size bounds were accepted\n";
+
+        return 1;
+    }
+
+    using SizeT = std::integral_constant<int, 6>;
+    using TrainerT = efuzz::EncoderTrainer<std::string, SizeT>;
+
+    efuzz::Encoder<std::string, SizeT> encoder;
+
+    encoder.set_encoding_nn_layer_sizes(
+        {encoder.get_nn_input_size(), 16, encoder.get_nn_output_size()});
+
+    const std::vector<std::string> dataset {"airplane", "airport", "apple",  "maple",
+                                            "people",   "purple",  "table",  "cable",
+                                            "stable",   "marble",  "simple", "sample"};
+    TrainerT fixed_trainer(encoder, dataset);
+    TrainerT adaptive_trainer(encoder, dataset);
+
+    fixed_trainer.set_step_size_control({.initial_scale = 0.25F});
+
+    if (fixed_trainer.diff_scale(std::nullopt) != 0.25F) {
+        std::cout << "Train calls without a DiffScalarFunction ignore the step size control\n";
+
+        return 1;
+    }
+
+    adaptive_trainer.set_step_size_control({.rule = StepSizeRule::cumulative});
+
+    const float initial_cost = adaptive_trainer.average_cost();
+    constexpr std::size_t rounds {300};
+
+    for (std::size_t round {0}; round < rounds; ++round) {
+        fixed_trainer.apply_training_result(fixed_trainer.train_all());
+        adaptive_trainer.apply_training_result(adaptive_trainer.train_all());
+    }
+
+    const efuzz::StepSizeControl& control = adaptive_trainer.get_step_size_control();
+
+    std::cout << "Cost " << initial_cost << " -> " << fixed_trainer.average_cost()
+              << " at a fixed scale of 0.25, " << adaptive_trainer.average_cost()
+              << " adapted (final scale " << control.scale() << ", success rate "
+              << control.success_rate() << ")\n";
+
+    if (control.trial_count() != rounds) {
+        std::cout << "Step size control saw " << control.trial_count() << " trials\n";
+
+        return 1;
+    }
+
+    // An explicit DiffScalarFunction takes over and leaves the control alone
+    const auto constant_scale = [](float, float, const std::vector<TrainerT::CostLogDatapoint>&) {
+        return 0.5F;
+    };
+
+    adaptive_trainer.apply_training_result(adaptive_trainer.train_all(constant_scale));
+
+    if (control.trial_count() != rounds) {
+        std::cout << "A DiffScalarFunction call was recorded by the step size control\n";
+
+        return 1;
+    }
+}
@@ -0,0 +1,131 @@
+#include <cstddef>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <cereal/archives/binary.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+
+#include <efuzz/string_pool.hpp>
+
+int main() {
+    using PoolT = efuzz::StringPool<std::string>;
+
+    const std::vector<std::string> words {"airplane", "", "apple", "airplane", "maple"};
+    PoolT pool(words);
+
+    if (pool.size() != words.size() || pool.character_count() != 26) {
+        std::cout << "Pool holds " << pool.size() << " strings of " << pool.character_count()
+                  << " characters\n";
+
+        return 1;
+    }
+
+    for (std::size_t id {0}; id < words.size(); ++id) {
+        if (pool [id] != words [id]) {
+            std::cout << "String " << id << " reads back as \"" << pool [id] << "\"\n";
+
+            return 1;
+        }
+    }
+
+    bool threw {};
+
+    try {
+        static_cast<void>(pool.at(words.size()));
+    }
+    catch (const std::out_of_range&) {
+        threw = true;
+    }
+
+    if (!threw) {
+        std::cout << "Out of range id was accepted\n";
+
+        return 1;
+    }
+
+    PoolT deduplicated(words, true);
+
+    if (deduplicated.size() != 4 || deduplicated.add("apple") != 2 ||
+        deduplicated.find("maple") != std::optional<std::size_t> {3} ||
+        deduplicated.find("purple").has_value()) {
+        std::cout << "Deduplication assigned the wrong ids\n";
+
+        return 1;
+    }
+
+    // Truncated ids are gone from the index too, so adding them again gives a new id
+    deduplicated.truncate(2);
+
+    if (deduplicated.size() != 2 || deduplicated.find("apple").has_value() ||
+        deduplicated.add("maple") != 2 || deduplicated [2] != "maple") {
+        std::cout << "Truncation left stale strings\n";
+
+        return 1;
+    }
+
+    // A pool and a vector of strings share their serialized format
+    std::stringstream vector_stream;
+    std::stringstream pool_stream;
+
+    {
+        cereal::BinaryOutputArchive vector_archive {vector_stream};
+        cereal::BinaryOutputArchive pool_archive {pool_stream};
+
+        vector_archive(words);
+        pool_archive(pool);
+    }
+
+    if (vector_stream.str() != pool_stream.str()) {
+        std::cout << "Pool serialization differs from std::vector<std::string>\n";
+
+        return 1;
+    }
+
+    PoolT loaded;
+    std::vector<std::string> loaded_words;
+
+    {
+        cereal::BinaryInputArchive vector_archive {vector_stream};
+        cereal::BinaryInputArchive pool_archive {pool_stream};
+
+        vector_archive(loaded);
+        pool_archive(loaded_words);
+    }
+
+    if (loaded.views() != pool.views() || loaded_words != words) {
+        std::cout << "Serialization round trip changed the strings\n";
+
+        return 1;
+    }
+
+    if (pool.views(3).size() != 2 || pool.views(3).front() != "airplane" ||
+        !pool.views(words.size()).empty()) {
+        std::cout << "Views from an id are wrong\n";
+
+        return 1;
+    }
+
+    // Batch after batch, the character buffer must grow geometrically, not move on every add
+    PoolT batched;
+    std::size_t moves {};
+
+    batched.add("a");
+
+    for (std::size_t batch {0}; batch < 1000; ++batch) {
+        const char* characters = batched [0].data();
+
+        batched.add_all({"batch", std::to_string(batch)});
+        moves += static_cast<std::size_t>(batched [0].data() != characters);
+    }
+
+    if (moves > 20) {
+        std::cout << "Adding 1000 batches moved the characters " << moves << " times\n";
+
+        return 1;
+    }
+}
@@ -0,0 +1,69 @@
+#ifndef EFUZZ_TEST_WORDS_HPP
+#define EFUZZ_TEST_WORDS_HPP
+
+#include <cstddef>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Dictionaries shared by the tests. The random ones draw from random_engine in a fixed order, so
+// a seed always gives the same words.
+namespace efuzz_test {
+    inline char random_letter(std::mt19937& random_engine, char first_letter, char last_letter) {
+        std::uniform_int_distribution<int> letter(first_letter, last_letter);
+
+        return static_cast<char>(letter(random_engine));
+    }
+
+    // Letters from first_letter to last_letter, min_length to max_length of them.
+    inline std::string random_word(std::mt19937& random_engine, char first_letter,
+                                   char last_letter, std::size_t min_length,
+                                   std::size_t max_length) {
+        std::uniform_int_distribution<std::size_t> length(min_length, max_length);
+        std::string word(length(random_engine), ' ');
+
+        for (auto& character: word) {
+            character = random_letter(random_engine, first_letter, last_letter);
+        }
+
+        return word;
+    }
+
+    inline std::vector<std::string> random_words(std::mt19937& random_engine, std::size_t count,
+                                                 char first_letter, char last_letter,
+                                                 std::size_t min_length, std::size_t max_length) {
+        std::vector<std::string> words;
+
+        words.reserve(count);
+
+        while (words.size() < count) {
+            words.push_back(
+                random_word(random_engine, first_letter, last_letter, min_length, max_length));
+        }
+
+        return words;
+    }
+
+    // assets/most_common_1000_english_words.txt, one word per line. Real words have far denser
+    // edit-distance neighbourhoods than random letters.
+    inline std::vector<std::string> english_words() {
+        std::ifstream file(EFUZZ_TEST_ASSETS_DIR "/most_common_1000_english_words.txt");
+
+        if (!file) {
+            throw std::runtime_error("Cannot open the English word list");
+        }
+
+        std::vector<std::string> words;
+        std::string word;
+
+        while (std::getline(file, word)) {
+            words.push_back(word);
+        }
+
+        return words;
+    }
+} // namespace efuzz_test
+
+#endif // EFUZZ_TEST_WORDS_HPP
@@ -1,7 +1,6 @@
 #include <fstream>
 #include <ios>
 #include <iostream>
-#include <memory>
 #include <optional>
 #include <ostream>
 #include <string>
@@ -54,7 +53,7 @@ int main(int argc, char** argv) {
         dataset.push_back(line);
     }
 
-    encoder_trainer.set_dataset(std::make_shared<std::vector<std::string>>(dataset));
+    encoder_trainer.set_dataset(dataset);
 
     const std::size_t random_iterations = 5; // arbitrary
     std::cout << "Training encoder with dataset size: " << dataset.size() << '\n';
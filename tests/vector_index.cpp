@@ -0,0 +1,149 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include <efuzz/efuzz.hpp>
+#include <efuzz/hnsw_index.hpp>
+#include <efuzz/vector_index.hpp>
+
+namespace {
+    float recall(const efuzz::VectorIndex& index, const efuzz::FlatVectorIndex& exact_index,
+                 const Eigen::MatrixXf& queries, std::size_t k) {
+        std::size_t found {};
+
+        for (Eigen::Index query {0}; query < queries.cols(); ++query) {
+            const auto expected = exact_index.nearest(queries.col(query).data(), k);
+            const auto actual = index.nearest(queries.col(query).data(), k);
+
+            for (const std::size_t id: expected) {
+                found += static_cast<std::size_t>(std::find(actual.begin(), actual.end(), id) !=
+                                                  actual.end());
+            }
+        }
+
+        return static_cast<float>(found) / static_cast<float>(queries.cols() * k);
+    }
+} // namespace
+
+int main() {
+    constexpr std::size_t dimension {16};
+    constexpr Eigen::Index point_count {4000};
+    constexpr Eigen::Index added_count {500};
+    constexpr std::size_t k {10};
+
+    std::mt19937 random_engine(7);
+    std::normal_distribution<float> distribution;
+
+    const auto random_matrix = [&](Eigen::Index cols) {
+        return Eigen::MatrixXf(Eigen::MatrixXf::NullaryExpr(
+            dimension, cols, [&]() { return distribution(random_engine); }));
+    };
+
+    const Eigen::MatrixXf points = random_matrix(point_count);
+    const Eigen::MatrixXf added_points = random_matrix(added_count);
+    const Eigen::MatrixXf queries = random_matrix(200);
+
+    efuzz::FlatVectorIndex exact_index {efuzz::EmbeddingStore(dimension)};
+    efuzz::HnswVectorIndex hnsw_index(dimension, {.m = 12, .thread_count = 4});
+
+    exact_index.add_batch(points.data(), point_count);
+    hnsw_index.add_batch(points.data(), point_count);
+
+    const float batch_recall = recall(hnsw_index, exact_index, queries, k);
+
+    std::cout << "HNSW recall@" << k << " after parallel build: " << batch_recall
+              << " (max level " << hnsw_index.get_max_level() << ")\n";
+
+    if (hnsw_index.size() != point_count || batch_recall < 0.9F) {
+        std::cout << "Parallel HNSW build has too low recall\n";
+
+        return 1;
+    }
+
+    for (Eigen::Index point {0}; point < added_count; ++point) {
+        exact_index.add(added_points.col(point).data());
+        hnsw_index.add(added_points.col(point).data());
+    }
+
+    const float incremental_recall = recall(hnsw_index, exact_index, queries, k);
+
+    std::cout << "HNSW recall@" << k << " after incremental inserts: " << incremental_recall
+              << '\n';
+
+    if (incremental_recall < 0.9F) {
+        std::cout << "Incremental HNSW inserts have too low recall\n";
+
+        return 1;
+    }
+
+    const auto self_match = hnsw_index.nearest(added_points.col(added_count - 1).data(), 1);
+
+    if (self_match.size() != 1 || self_match.front() != point_count + added_count - 1) {
+        std::cout << "Inserted point is not its own nearest neighbour\n";
+
+        return 1;
+    }
+
+    const auto time_queries = [&queries](const efuzz::VectorIndex& index) {
+        const auto start = std::chrono::steady_clock::now();
+
+        for (Eigen::Index query {0}; query < queries.cols(); ++query) {
+            static_cast<void>(index.nearest(queries.col(query).data(), k));
+        }
+
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start)
+                   .count() /
+               static_cast<double>(queries.cols());
+    };
+
+    std::cout << "Query time: flat " << time_queries(exact_index) << " us, HNSW "
+              << time_queries(hnsw_index) << " us\n";
+
+    using EncoderT = efuzz::Encoder<std::string, std::integral_constant<int, 10>>;
+
+    EncoderT encoder;
+
+    encoder.set_encoding_nn_layer_sizes(
+        {encoder.get_nn_input_size(), 16, 12, encoder.get_nn_output_size()});
+
+    const std::vector<std::string> dictionary = {
+        "airplane", "airport", "apple",  "maple",  "people", "purple",  "table",
+        "cable",    "fable",   "stable", "staple", "simple", "example", "sample"};
+
+    for (const auto vector_index_type: {efuzz::VectorIndexType::hnsw,
+                                        efuzz::VectorIndexType::annoy}) {
+        efuzz::SearchContainer<std::string, std::integral_constant<int, 10>> container(encoder);
+
+        container.set_vector_index(vector_index_type);
+        container.insert(std::vector<std::string>(dictionary.begin(), dictionary.end() - 1));
+
+        const auto copy = container;
+
+        container.insert(dictionary.back());
+
+        if (copy.size() + 1 != container.size() ||
+            copy.search(dictionary.back(), 1).front().id == dictionary.size() - 1) {
+            std::cout << "Insert leaked into a copy of the container\n";
+
+            return 1;
+        }
+
+        for (std::size_t id {0}; id < dictionary.size(); ++id) {
+            const auto results = container.search(dictionary [id], 3);
+
+            if (results.empty() || results.front().id != id) {
+                std::cout << "Exact lookup of " << dictionary [id] << " failed with backend "
+                          << static_cast<int>(vector_index_type) << '\n';
+
+                return 1;
+            }
+        }
+    }
+}